@@ -1,10 +1,29 @@
 #include <optional>
+#include <string_view>
 #include <napp/Application.hpp>
+#include <nscene/FrustumCuller.hpp>
+#include <nscene/InstancedDraws.hpp>
+#include <nscene/OcclusionRasterizer.hpp>
 
 using namespace Nebula;
 
 int main(int argc, char *argv[])
 {
+    if (argc > 1 && std::string_view(argv[1]) == "--benchmark-culling") {
+        ns::benchmark_frustum_culling();
+        return 0;
+    }
+
+    if (argc > 1 && std::string_view(argv[1]) == "--benchmark-occlusion") {
+        ns::benchmark_occlusion_culling();
+        return 0;
+    }
+
+    if (argc > 1 && std::string_view(argv[1]) == "--benchmark-instancing") {
+        ns::benchmark_instancing();
+        return 0;
+    }
+
     std::optional<std::string> hair = std::nullopt;
     if (argc > 1) {
         hair = std::make_optional<std::string>(std::string(argv[1]));
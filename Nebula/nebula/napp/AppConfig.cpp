@@ -28,7 +28,11 @@ namespace Nebula
             .gui_enabled = data["gui_enabled"].get<bool>(),
             .wnd_width = data["wnd_width"].get<uint32_t>(),
             .wnd_height = data["wnd_height"].get<uint32_t>(),
-            .wnd_fullscreen = data["wnd_fullscreen"].get<bool>()
+            .wnd_fullscreen = data["wnd_fullscreen"].get<bool>(),
+            .gltf_scene = data.value("gltf_scene", std::string()),
+            .scene_threads = data.value("scene_threads", 0u),
+            .scene_cache = data.value("scene_cache", std::string()),
+            .cpu_occlusion = data.value("cpu_occlusion", false),
         };
     }
 }
@@ -15,6 +15,10 @@ namespace Nebula
         const uint32_t      wnd_width       = 1600;
         const uint32_t      wnd_height      = 900;
         const bool          wnd_fullscreen  = false;
+        const std::string   gltf_scene      = "";       // Loaded next to the default scene if set
+        const uint32_t      scene_threads   = 0;        // Threads decoding scene files, 0 for all hardware threads
+        const std::string   scene_cache     = "";       // Baked cache of gltf_scene, rebuilt when older than the source
+        const bool          cpu_occlusion   = false;    // Software occlusion culling of the frustum visible objects
 
         static AppConfig load(const std::string& path2json = "napp_config.json");
     };
@@ -1,6 +1,8 @@
 #include "Application.hpp"
 #include <iostream>
 #include <nscene/DefaultScene.hpp>
+#include <nscene/GLTFScene.hpp>
+#include <nscene/SceneCache.hpp>
 
 namespace Nebula
 {
@@ -32,6 +34,43 @@ namespace Nebula
             m_scenes.push_back(m_active_scene);
         }
 
+        if (!m_config.gltf_scene.empty())
+        {
+            const uint32_t threads = (m_config.scene_threads > 0) ? m_config.scene_threads : std::max(std::thread::hardware_concurrency(), 1u);
+            const glm::ivec2 camera_size(m_swapchain->extent().width, m_swapchain->extent().height);
+
+            std::shared_ptr<ns::Scene> scene;
+            if (!m_config.scene_cache.empty())
+            {
+                if (!ns::CachedScene::is_up_to_date(m_config.scene_cache, m_config.gltf_scene))
+                {
+                    ns::GLTFScene::bake(m_config.gltf_scene, m_config.scene_cache, threads);
+                }
+                scene = std::make_shared<ns::CachedScene>(m_config.scene_cache, camera_size,
+                                                          m_context->command_pool(), m_context->device());
+            }
+            else
+            {
+                scene = std::make_shared<ns::GLTFScene>(m_config.gltf_scene, camera_size,
+                                                        m_context->command_pool(), m_context->device(), threads);
+            }
+            scene->init();
+            m_scenes.push_back(scene);
+
+            if (!m_active_scene)
+            {
+                m_active_scene = scene;
+            }
+        }
+
+        if (m_config.cpu_occlusion)
+        {
+            for (const auto& scene : m_scenes)
+            {
+                scene->set_software_occlusion(true);
+            }
+        }
+
         if (m_params.render_graph)
         {
             m_rg_context = std::make_shared<nrg::Context>(m_scenes, m_context->device(), m_context->command_pool(), m_swapchain, s_current_frame);
@@ -57,6 +96,7 @@ namespace Nebula
         if (m_params.render_graph)
         {
             m_rg_context->check_next_render_path();
+            m_rg_context->update_dynamic_resolution();
         }
 
         m_has_rendered = false;
@@ -80,6 +120,7 @@ namespace Nebula
         vk::CommandBufferBeginInfo begin_info {};
         vk::Result result = command_buffer.begin(&begin_info);
 
+        m_active_scene->update_tlas(s_current_frame, command_buffer);
         render(command_buffer);
 
         if (m_config.gui_enabled)
@@ -0,0 +1,91 @@
+#include "MappedFile.hpp"
+#include <nlog/nlog.hpp>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Nebula
+{
+    #ifdef _WIN32
+    MappedFile::MappedFile(const std::string& path)
+    {
+        m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                             FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (m_file == INVALID_HANDLE_VALUE)
+        {
+            m_file = nullptr;
+            throw nlog::make_exception("Failed to open file for mapping: {}", path);
+        }
+
+        LARGE_INTEGER file_size;
+        GetFileSizeEx(m_file, &file_size);
+        m_size = static_cast<size_t>(file_size.QuadPart);
+        if (m_size == 0)
+        {
+            return;
+        }
+
+        m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (m_mapping != nullptr)
+        {
+            m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+        }
+        if (m_data == nullptr)
+        {
+            if (m_mapping) CloseHandle(m_mapping);
+            CloseHandle(m_file);
+            throw nlog::make_exception("Failed to map file: {}", path);
+        }
+    }
+
+    MappedFile::~MappedFile()
+    {
+        if (m_data) UnmapViewOfFile(m_data);
+        if (m_mapping) CloseHandle(m_mapping);
+        if (m_file) CloseHandle(m_file);
+    }
+    #else
+    MappedFile::MappedFile(const std::string& path)
+    {
+        m_fd = open(path.c_str(), O_RDONLY);
+        if (m_fd < 0)
+        {
+            throw nlog::make_exception("Failed to open file for mapping: {}", path);
+        }
+
+        struct stat file_stat {};
+        fstat(m_fd, &file_stat);
+        m_size = static_cast<size_t>(file_stat.st_size);
+        if (m_size == 0)
+        {
+            return;
+        }
+
+        void* mapping = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+        if (mapping == MAP_FAILED)
+        {
+            close(m_fd);
+            throw nlog::make_exception("Failed to map file: {}", path);
+        }
+
+        // Everything is read front to back exactly once
+        madvise(mapping, m_size, MADV_SEQUENTIAL);
+        madvise(mapping, m_size, MADV_WILLNEED);
+        m_data = static_cast<const uint8_t*>(mapping);
+    }
+
+    MappedFile::~MappedFile()
+    {
+        if (m_data) munmap(const_cast<uint8_t*>(m_data), m_size);
+        if (m_fd >= 0) close(m_fd);
+    }
+    #endif
+}
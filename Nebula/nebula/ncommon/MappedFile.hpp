@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+namespace Nebula
+{
+    /**
+     * Read-only memory mapping of a whole file, unmapped on destruction.
+     */
+    class MappedFile
+    {
+    public:
+        explicit MappedFile(const std::string& path);
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        ~MappedFile();
+
+        const uint8_t* data() const { return m_data; }
+
+        size_t size() const { return m_size; }
+
+        std::span<const uint8_t> bytes() const { return { m_data, m_size }; }
+
+    private:
+        const uint8_t*  m_data {nullptr};
+        size_t          m_size {0};
+
+        #ifdef _WIN32
+        void*           m_file {nullptr};
+        void*           m_mapping {nullptr};
+        #else
+        int             m_fd {-1};
+        #endif
+    };
+}
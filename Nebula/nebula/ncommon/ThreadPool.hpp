@@ -0,0 +1,131 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Nebula
+{
+    /**
+     * Fixed set of worker threads for data-parallel loops.
+     * The calling thread works on the loop as well, a pool of size 1 has no workers and runs everything inline.
+     * Only one loop can run at a time, parallel_for is not meant to be called from multiple threads.
+     */
+    class ThreadPool
+    {
+    public:
+        explicit ThreadPool(uint32_t thread_count = std::max(std::thread::hardware_concurrency(), 1u))
+        {
+            for (uint32_t i = 1; i < thread_count; i++)
+            {
+                m_workers.emplace_back([this]{ worker_loop(); });
+            }
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        ~ThreadPool()
+        {
+            {
+                std::lock_guard lock(m_mutex);
+                m_stop = true;
+            }
+            m_job_cv.notify_all();
+            for (auto& worker : m_workers)
+            {
+                worker.join();
+            }
+        }
+
+        // Calls fn(i) for every i in [0, count) and returns once all calls finished, the first exception is rethrown
+        void parallel_for(size_t count, const std::function<void(size_t)>& fn)
+        {
+            if (m_workers.empty() || count < 2)
+            {
+                for (size_t i = 0; i < count; i++) fn(i);
+                return;
+            }
+
+            {
+                std::lock_guard lock(m_mutex);
+                m_fn = &fn;
+                m_count = count;
+                m_next = 0;
+                m_error = nullptr;
+                m_active = m_workers.size();
+                m_generation++;
+            }
+            m_job_cv.notify_all();
+
+            run_job();
+
+            std::unique_lock lock(m_mutex);
+            m_done_cv.wait(lock, [&]{ return m_active == 0; });
+            m_fn = nullptr;
+
+            if (m_error)
+            {
+                std::rethrow_exception(m_error);
+            }
+        }
+
+        uint32_t size() const { return static_cast<uint32_t>(m_workers.size()) + 1; }
+
+    private:
+        void worker_loop()
+        {
+            uint64_t seen_generation = 0;
+            while (true)
+            {
+                {
+                    std::unique_lock lock(m_mutex);
+                    m_job_cv.wait(lock, [&]{ return m_stop || m_generation != seen_generation; });
+                    if (m_stop) return;
+                    seen_generation = m_generation;
+                }
+
+                run_job();
+
+                std::lock_guard lock(m_mutex);
+                if (--m_active == 0)
+                {
+                    m_done_cv.notify_one();
+                }
+            }
+        }
+
+        // Indices are handed out one at a time, items are expected to be coarse (a mesh, an image)
+        void run_job()
+        {
+            for (size_t i = m_next++; i < m_count; i = m_next++)
+            {
+                try {
+                    (*m_fn)(i);
+                } catch (...) {
+                    std::lock_guard lock(m_mutex);
+                    if (!m_error) m_error = std::current_exception();
+                }
+            }
+        }
+
+        std::vector<std::thread>            m_workers;
+        std::mutex                          m_mutex;
+        std::condition_variable             m_job_cv;
+        std::condition_variable             m_done_cv;
+        bool                                m_stop {false};
+
+        const std::function<void(size_t)>*  m_fn {nullptr};
+        size_t                              m_count {0};
+        std::atomic<size_t>                 m_next {0};
+        size_t                              m_active {0};
+        uint64_t                            m_generation {0};
+        std::exception_ptr                  m_error;
+    };
+}
@@ -12,8 +12,12 @@ namespace Nebula::nhair
         load_file();
         process_vertices();
         process_strands();
-        create_buffers();
-        create_initial_position_buffers();
+
+        // The vertex, strand & position buffers are copied in one submission
+        nvk::UploadBatch upload_batch(m_device, m_command_pool);
+        create_buffers(upload_batch);
+        create_initial_position_buffers(upload_batch);
+        upload_batch.submit();
 
         m_gx = static_cast<uint32_t>(std::floor(strand_count() / 32));
     }
@@ -87,20 +91,20 @@ namespace Nebula::nhair
         }
     }
 
-    void HairModel::create_buffers()
+    void HairModel::create_buffers(nvk::UploadBatch& upload_batch)
     {
         auto name = fmt::format("[Hair] {}", m_file_path);
         auto vb_create_info = nvk::BufferCreateInfo()
             .set_buffer_type(nvk::BufferType::eStorage)
             .set_name(name)
             .set_size(sizeof(Vertex) * m_vertices.size());
-        m_vertex_buffer = nvk::Buffer::create_with_data(vb_create_info, m_vertices.data(), m_device, m_command_pool);
+        m_vertex_buffer = nvk::Buffer::create_with_data(vb_create_info, m_vertices.data(), m_device, upload_batch);
 
         auto sdb_create_info = nvk::BufferCreateInfo()
             .set_buffer_type(nvk::BufferType::eStorage)
             .set_name(name)
             .set_size(sizeof(StrandDescription) * m_strand_descriptions.size());
-        m_strand_descriptions_buffer = nvk::Buffer::create_with_data(sdb_create_info, m_strand_descriptions.data(), m_device, m_command_pool);
+        m_strand_descriptions_buffer = nvk::Buffer::create_with_data(sdb_create_info, m_strand_descriptions.data(), m_device, upload_batch);
     }
 
     void HairModel::draw(const vk::CommandBuffer& command_buffer) const
@@ -113,7 +117,7 @@ namespace Nebula::nhair
         m_current_position_buffer = (m_current_position_buffer + 1) % 2;
     }
 
-    void HairModel::create_initial_position_buffers()
+    void HairModel::create_initial_position_buffers(nvk::UploadBatch& upload_batch)
     {
         auto create_info = nvk::BufferCreateInfo()
             .set_buffer_type(nvk::BufferType::eStorage)
@@ -123,7 +127,7 @@ namespace Nebula::nhair
         {
             auto name = fmt::format("[Hair | {}] Position Buffer #{}", m_file_path, i++);
             create_info.set_name(name);
-            buffer = nvk::Buffer::create_with_data(create_info, m_vertices.data(), m_device, m_command_pool);
+            buffer = nvk::Buffer::create_with_data(create_info, m_vertices.data(), m_device, upload_batch);
         }
     }
 }
\ No newline at end of file
@@ -12,6 +12,7 @@
 #include <nscene/geometry/Mesh.hpp>
 #include <nvk/Buffer.hpp>
 #include <nvk/Context.hpp>
+#include <nvk/UploadBatch.hpp>
 
 namespace Nebula::nhair
 {
@@ -90,9 +91,9 @@ namespace Nebula::nhair
 
         void process_strands();
 
-        void create_buffers();
+        void create_buffers(nvk::UploadBatch& upload_batch);
 
-        void create_initial_position_buffers();
+        void create_initial_position_buffers(nvk::UploadBatch& upload_batch);
 
         std::string                         m_file_path;
         cyHairFile                          m_hair_file;
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <limits>
+#include <glm/glm.hpp>
+
+namespace Nebula::nmath
+{
+    /**
+     * Axis-aligned bounding box, default constructed empty (min > max).
+     */
+    struct AABB
+    {
+        glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+        glm::vec3 max = glm::vec3(std::numeric_limits<float>::lowest());
+
+        bool is_valid() const
+        {
+            return min.x <= max.x && min.y <= max.y && min.z <= max.z;
+        }
+
+        void expand(const glm::vec3& point)
+        {
+            min = glm::min(min, point);
+            max = glm::max(max, point);
+        }
+
+        void expand(const AABB& other)
+        {
+            if (!other.is_valid()) return;
+            min = glm::min(min, other.min);
+            max = glm::max(max, other.max);
+        }
+
+        glm::vec3 center() const { return 0.5f * (min + max); }
+
+        glm::vec3 half_extent() const { return 0.5f * (max - min); }
+
+        // Bounds of the transformed box, without transforming all 8 corners (Arvo)
+        AABB transform(const glm::mat4& m) const
+        {
+            if (!is_valid()) return *this;
+
+            const glm::vec3 c = glm::vec3(m * glm::vec4(center(), 1.0f));
+            const glm::vec3 e = half_extent();
+            const glm::vec3 r = {
+                glm::abs(m[0][0]) * e.x + glm::abs(m[1][0]) * e.y + glm::abs(m[2][0]) * e.z,
+                glm::abs(m[0][1]) * e.x + glm::abs(m[1][1]) * e.y + glm::abs(m[2][1]) * e.z,
+                glm::abs(m[0][2]) * e.x + glm::abs(m[1][2]) * e.y + glm::abs(m[2][2]) * e.z,
+            };
+            return { c - r, c + r };
+        }
+    };
+}
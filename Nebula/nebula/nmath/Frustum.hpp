@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <glm/glm.hpp>
+#include <nmath/AABB.hpp>
+
+namespace Nebula::nmath
+{
+    /**
+     * View frustum as six inward facing planes [ Normal | Distance ], a point p is inside if dot(n, p) + d >= 0.
+     */
+    struct Frustum
+    {
+        std::array<glm::vec4, 6> planes {};
+
+        // Gribb-Hartmann extraction from a view-projection matrix, the near plane assumes a -w..w depth range
+        // which is conservative for projections mapping depth to 0..w
+        static Frustum from_matrix(const glm::mat4& view_projection)
+        {
+            const glm::mat4 m = glm::transpose(view_projection);
+
+            Frustum frustum;
+            frustum.planes = {
+                m[3] + m[0],    // Left
+                m[3] - m[0],    // Right
+                m[3] + m[1],    // Bottom
+                m[3] - m[1],    // Top
+                m[3] + m[2],    // Near
+                m[3] - m[2],    // Far
+            };
+
+            for (auto& plane : frustum.planes)
+            {
+                plane /= glm::length(glm::vec3(plane));
+            }
+            return frustum;
+        }
+
+        bool intersects(const AABB& aabb) const
+        {
+            if (!aabb.is_valid()) return false;
+
+            const glm::vec3 c = aabb.center();
+            const glm::vec3 e = aabb.half_extent();
+            for (const auto& plane : planes)
+            {
+                const glm::vec3 n = glm::vec3(plane);
+                if (glm::dot(n, c) + plane.w + glm::dot(glm::abs(n), e) < 0.0f) return false;
+            }
+            return true;
+        }
+    };
+}
@@ -24,7 +24,12 @@ namespace Nebula::nmath
 
         vk::TransformMatrixKHR model3x4() const
         {
-            glm::mat4 m = model();
+            return to_3x4(model());
+        }
+
+        // Top three rows of an affine matrix, as used by acceleration structure instances
+        static vk::TransformMatrixKHR to_3x4(const glm::mat4& m)
+        {
             return vk::TransformMatrixKHR({
                 std::array { m[0].x, m[1].x, m[2].x, m[3].x },
                 std::array { m[0].y, m[1].y, m[2].y, m[3].y },
@@ -0,0 +1,204 @@
+#include "ComputeNode.hpp"
+#include <algorithm>
+#include <nlog/nlog.hpp>
+#include <nrg/resource/Resources.hpp>
+
+namespace Nebula::nrg
+{
+    ComputeNode::ComputeNode(std::string name, const NodeType node_type, const std::shared_ptr<Context>& context)
+    : Node(std::move(name), node_type)
+    , m_context(context)
+    , m_device(context->m_device)
+    , m_current_frame(context->m_current_frame)
+    {
+    }
+
+    uint32_t ComputeNode::create_compute_pipeline(const ComputePipelineInfo& pipeline_info)
+    {
+        using SSFB = vk::ShaderStageFlagBits;
+
+        const auto pipeline_idx = static_cast<uint32_t>(m_passes.size());
+        const auto pass_name = (pipeline_idx == 0) ? name() : fmt::format("{} #{}", name(), pipeline_idx);
+        const auto variant_count = static_cast<uint32_t>(pipeline_info.variants.size()) + 1;
+
+        auto descriptor_create_info = nvk::DescriptorCreateInfo()
+            .set_count(m_context->m_frames * variant_count)
+            .set_name(pass_name);
+        for (const auto& binding : pipeline_info.bindings)
+        {
+            descriptor_create_info.add(binding.type, binding.binding, SSFB::eCompute, std::max(static_cast<uint32_t>(binding.images.size()), 1u));
+        }
+
+        ComputePass pass { .info = pipeline_info };
+        pass.descriptor = std::make_shared<nvk::Descriptor>(descriptor_create_info, m_device);
+
+        auto pipeline_create_info = nvk::PipelineCreateInfo()
+            .set_pipeline_type(nvk::PipelineType::eCompute)
+            .add_descriptor_set_layout(pass.descriptor->layout())
+            .add_shader(pipeline_info.shader, SSFB::eCompute)
+            .set_name(pass_name);
+        if (pipeline_info.push_constant_size > 0)
+        {
+            pipeline_create_info.add_push_constant({ SSFB::eCompute, 0, pipeline_info.push_constant_size });
+        }
+        for (const auto& [ constant_id, value ] : pipeline_info.specialization_constants)
+        {
+            pipeline_create_info.add_specialization_constant(SSFB::eCompute, constant_id, value);
+        }
+        pass.pipeline = std::make_shared<nvk::Pipeline>(pipeline_create_info, m_device);
+
+        for (uint32_t variant = 0; variant < variant_count; variant++)
+        {
+            for (uint32_t i = 0; i < m_context->m_frames; i++)
+            {
+                write_descriptor_set(pass, i, variant);
+            }
+        }
+
+        m_passes.push_back(std::move(pass));
+        return pipeline_idx;
+    }
+
+    vk::Extent2D ComputeNode::get_image_extent(const std::string& key)
+    {
+        return get_resource<ImageResource>(key).get_image()->properties().extent;
+    }
+
+    void ComputeNode::dispatch(const vk::CommandBuffer& command_buffer, const vk::Extent2D& extent, const void* push_constant,
+                               const uint32_t pipeline, const uint32_t variant)
+    {
+        const auto& pass = m_passes.at(pipeline);
+        const auto& group_size = pass.info.group_size;
+
+        pass.pipeline->bind(command_buffer);
+        pass.pipeline->bind_descriptor_set(command_buffer, pass.descriptor->set(variant * m_context->m_frames + m_current_frame));
+        if (push_constant && pass.info.push_constant_size > 0)
+        {
+            command_buffer.pushConstants(pass.pipeline->layout(), vk::ShaderStageFlagBits::eCompute, 0, pass.info.push_constant_size, push_constant);
+        }
+        command_buffer.dispatch((extent.width + group_size.width - 1) / group_size.width, (extent.height + group_size.height - 1) / group_size.height, 1);
+    }
+
+    void ComputeNode::compute_barrier(const vk::CommandBuffer& command_buffer)
+    {
+        auto barrier = vk::MemoryBarrier2()
+            .setSrcStageMask(vk::PipelineStageFlagBits2::eComputeShader)
+            .setSrcAccessMask(vk::AccessFlagBits2::eShaderStorageWrite)
+            .setDstStageMask(vk::PipelineStageFlagBits2::eComputeShader)
+            .setDstAccessMask(vk::AccessFlagBits2::eShaderSampledRead | vk::AccessFlagBits2::eShaderStorageRead | vk::AccessFlagBits2::eShaderStorageWrite);
+        command_buffer.pipelineBarrier2(vk::DependencyInfo().setMemoryBarriers(barrier));
+    }
+
+    std::shared_ptr<ImageRequirement> ComputeNode::find_image_requirement(const std::string& key) const
+    {
+        const auto& requirements = get_resource_requirements();
+        const auto fnd = std::ranges::find_if(requirements, [&](const auto& r){ return r->name == key; });
+        return (fnd == std::end(requirements)) ? nullptr : std::dynamic_pointer_cast<ImageRequirement>(*fnd);
+    }
+
+    bool ComputeNode::is_written_in_place(const std::string& key) const
+    {
+        const auto input = m_resources.find(key);
+        if (input == std::end(m_resources)) return false;
+
+        return std::ranges::any_of(m_resources, [&](const auto& kv){
+            const auto req = find_image_requirement(kv.first);
+            return kv.first != key && kv.second == input->second && req && req->usage == ResourceUsage::eOutput;
+        });
+    }
+
+    void ComputeNode::write_descriptor_set(const ComputePass& pass, const uint32_t frame, const uint32_t variant)
+    {
+        const auto& pipeline_info = pass.info;
+
+        // The write info keeps pointers, the infos have to outlive write() and arrays have to stay contiguous
+        size_t image_count = 0;
+        for (const auto& binding : pipeline_info.bindings)
+        {
+            image_count += std::max(binding.images.size(), size_t(1));
+        }
+        std::vector<vk::DescriptorImageInfo> image_infos;
+        std::vector<vk::DescriptorBufferInfo> buffer_infos;
+        image_infos.reserve(image_count);
+        buffer_infos.reserve(pipeline_info.bindings.size());
+
+        auto write_info = nvk::DescriptorWriteInfo().set_set_index(variant * m_context->m_frames + frame);
+        for (const auto& binding : pipeline_info.bindings)
+        {
+            // Buffers owned by the node
+            if (!binding.buffers.empty())
+            {
+                const auto& buffer = binding.buffers[frame % binding.buffers.size()];
+                buffer_infos.emplace_back(buffer->buffer(), 0, VK_WHOLE_SIZE);
+                if (binding.type == nvk::DescriptorType::eUniformBuffer)
+                {
+                    write_info.add_uniform_buffer(binding.binding, buffer_infos.back());
+                }
+                else
+                {
+                    write_info.add_storage_buffer(binding.binding, buffer_infos.back());
+                }
+                continue;
+            }
+
+            // Images owned by the node
+            if (!binding.images.empty())
+            {
+                const size_t first = image_infos.size();
+                for (const auto& image : binding.images)
+                {
+                    image_infos.emplace_back(image->default_sampler(), image->image_view(), vk::ImageLayout::eShaderReadOnlyOptimal);
+                }
+                write_info.add_combined_image_sampler(binding.binding, image_infos[first], static_cast<uint32_t>(binding.images.size()));
+                continue;
+            }
+
+            std::string resource = binding.resource;
+            if (variant > 0)
+            {
+                const auto& overrides = pipeline_info.variants[variant - 1];
+                if (const auto fnd = std::ranges::find_if(overrides, [&](const auto& kv){ return kv.first == binding.binding; });
+                    fnd != std::end(overrides))
+                {
+                    resource = fnd->second;
+                }
+            }
+
+            if (!m_resources.contains(resource))
+            {
+                throw nlog::make_exception("{}: no resource bound to \"{}\" (binding {})", name(), resource, binding.binding);
+            }
+
+            if (binding.type == nvk::DescriptorType::eStorageBuffer)
+            {
+                const auto& buffer = get_resource<BufferResource>(resource).get_buffer();
+                buffer_infos.emplace_back(buffer->buffer(), 0, VK_WHOLE_SIZE);
+                write_info.add_storage_buffer(binding.binding, buffer_infos.back());
+                continue;
+            }
+
+            // Set i uses the history image of frame i, or the one of the frame before it for previous frame inputs
+            const auto req = find_image_requirement(resource);
+            const auto& r_image = get_resource<ImageResource>(resource);
+            const bool previous = binding.previous || (req && req->previous_frame);
+            const uint32_t image_frame = previous ? frame + static_cast<uint32_t>(r_image.images().size()) - 1 : frame;
+            const auto& image = r_image.get_image(image_frame);
+
+            if (binding.type == nvk::DescriptorType::eCombinedImageSampler)
+            {
+                // Written in-place the image is kept in the eGeneral layout of the output
+                const auto layout = is_written_in_place(resource) ? vk::ImageLayout::eGeneral
+                                  : req ? req->expected_layout : vk::ImageLayout::eShaderReadOnlyOptimal;
+                image_infos.emplace_back(image->default_sampler(), image->image_view(), layout);
+                write_info.add_combined_image_sampler(binding.binding, image_infos.back());
+            }
+            else
+            {
+                image_infos.emplace_back(nullptr, image->image_view(), vk::ImageLayout::eGeneral);
+                write_info.add_storage_image(binding.binding, image_infos.back());
+            }
+        }
+
+        pass.descriptor->write(write_info);
+    }
+}
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <nrg/common/Context.hpp>
+#include <nrg/common/Node.hpp>
+#include <nrg/common/NodeTraits.hpp>
+#include <nvk/Buffer.hpp>
+#include <nvk/Descriptor.hpp>
+#include <nvk/Device.hpp>
+#include <nvk/Image.hpp>
+#include <nvk/render/Pipeline.hpp>
+
+namespace Nebula::nrg
+{
+    /**
+     * Bindings, shader & constants of a pipeline of a ComputeNode.
+     * Bindings refer to resource keys of the node, their descriptors are written from the bound resources. Buffers &
+     * images owned by the node itself are bound directly, variants bind other resources to the same bindings.
+     */
+    struct ComputePipelineInfo
+    {
+        struct Binding
+        {
+            uint32_t                                  binding {0};
+            nvk::DescriptorType                       type {nvk::DescriptorType::eStorageImage};
+            std::string                               resource;
+            bool                                      previous {false};  // Image written in the previous frame
+            std::vector<std::shared_ptr<nvk::Buffer>> buffers;           // Owned by the node, one per frame in flight or one for all
+            std::vector<std::shared_ptr<nvk::Image>>  images;            // Owned by the node, bound as an array
+        };
+
+        using Variant = std::vector<std::pair<uint32_t, std::string>>;
+
+        std::string                               shader;
+        std::vector<Binding>                      bindings;
+        std::vector<Variant>                      variants;
+        std::vector<std::pair<uint32_t, uint32_t>> specialization_constants;
+        uint32_t                                  push_constant_size {0};
+        vk::Extent2D                              group_size {8, 8};
+
+        ComputePipelineInfo& set_shader(const std::string& value)
+        {
+            shader = value;
+            return *this;
+        }
+
+        // Sampled through the default sampler of the image, in the layout of the node's requirement
+        ComputePipelineInfo& add_sampled_image(uint32_t binding, const std::string& resource)
+        {
+            bindings.push_back({ .binding = binding, .type = nvk::DescriptorType::eCombinedImageSampler, .resource = resource });
+            return *this;
+        }
+
+        // Array of images owned by the node, sampled in eShaderReadOnlyOptimal
+        ComputePipelineInfo& add_sampled_images(uint32_t binding, const std::vector<std::shared_ptr<nvk::Image>>& images)
+        {
+            bindings.push_back({ .binding = binding, .type = nvk::DescriptorType::eCombinedImageSampler, .images = images });
+            return *this;
+        }
+
+        ComputePipelineInfo& add_storage_image(uint32_t binding, const std::string& resource)
+        {
+            bindings.push_back({ .binding = binding, .type = nvk::DescriptorType::eStorageImage, .resource = resource });
+            return *this;
+        }
+
+        // Image of a history resource written in the previous frame
+        ComputePipelineInfo& add_history_image(uint32_t binding, const std::string& resource)
+        {
+            bindings.push_back({ .binding = binding, .type = nvk::DescriptorType::eStorageImage, .resource = resource, .previous = true });
+            return *this;
+        }
+
+        ComputePipelineInfo& add_storage_buffer(uint32_t binding, const std::string& resource)
+        {
+            bindings.push_back({ .binding = binding, .type = nvk::DescriptorType::eStorageBuffer, .resource = resource });
+            return *this;
+        }
+
+        ComputePipelineInfo& add_storage_buffer(uint32_t binding, const std::vector<std::shared_ptr<nvk::Buffer>>& buffers)
+        {
+            bindings.push_back({ .binding = binding, .type = nvk::DescriptorType::eStorageBuffer, .buffers = buffers });
+            return *this;
+        }
+
+        ComputePipelineInfo& add_uniform_buffer(uint32_t binding, const std::vector<std::shared_ptr<nvk::Buffer>>& buffers)
+        {
+            bindings.push_back({ .binding = binding, .type = nvk::DescriptorType::eUniformBuffer, .buffers = buffers });
+            return *this;
+        }
+
+        // Another set of resources for the bindings, [ binding, resource key ] pairs replace the declared resources.
+        // Selected by its index in dispatch(), starting at 1
+        ComputePipelineInfo& add_variant(const Variant& resources)
+        {
+            variants.push_back(resources);
+            return *this;
+        }
+
+        ComputePipelineInfo& add_specialization_constant(uint32_t constant_id, uint32_t value)
+        {
+            specialization_constants.emplace_back(constant_id, value);
+            return *this;
+        }
+
+        ComputePipelineInfo& set_push_constant_size(uint32_t value)
+        {
+            push_constant_size = value;
+            return *this;
+        }
+
+        // Must match the local size of the shader
+        ComputePipelineInfo& set_group_size(uint32_t x, uint32_t y)
+        {
+            group_size = vk::Extent2D(x, y);
+            return *this;
+        }
+    };
+
+    /**
+     * Base of nodes running compute pipelines over images.
+     * A descriptor set is written per frame in flight & variant from the bound resources (history images included)
+     * and the dispatch size follows the extent of a resource. Layout transitions are done by the render path as for
+     * any node, barriers against a compute node only wait on and release the compute stage.
+     */
+    class ComputeNode : public Node
+    {
+        struct ComputePass
+        {
+            ComputePipelineInfo              info;
+            std::shared_ptr<nvk::Pipeline>   pipeline;
+            std::shared_ptr<nvk::Descriptor> descriptor;
+        };
+
+    public:
+        ComputeNode(std::string name, NodeType node_type, const std::shared_ptr<Context>& context);
+
+        ~ComputeNode() override = default;
+
+        vk::PipelineStageFlags2 shader_stages() const override { return vk::PipelineStageFlagBits2::eComputeShader; }
+
+    protected:
+        // Creates a pipeline & writes its descriptor sets, returns its index for dispatch().
+        // Call from initialize() once the resources are bound
+        uint32_t create_compute_pipeline(const ComputePipelineInfo& pipeline_info);
+
+        // Extent of an image resource of the node
+        vk::Extent2D get_image_extent(const std::string& key);
+
+        // Binds the pipeline & the set of the current frame and variant, covers the extent with workgroups
+        void dispatch(const vk::CommandBuffer& command_buffer, const vk::Extent2D& extent, const void* push_constant = nullptr,
+                      uint32_t pipeline = 0, uint32_t variant = 0);
+
+        template <typename T>
+        void dispatch(const vk::CommandBuffer& command_buffer, const vk::Extent2D& extent, const T& push_constant,
+                      uint32_t pipeline = 0, uint32_t variant = 0)
+        {
+            dispatch(command_buffer, extent, static_cast<const void*>(&push_constant), pipeline, variant);
+        }
+
+        // Makes the writes of the previous dispatch visible to the next one
+        static void compute_barrier(const vk::CommandBuffer& command_buffer);
+
+        std::shared_ptr<Context>                    m_context;
+        std::shared_ptr<nvk::Device>                m_device;
+        uint32_t&                                   m_current_frame;
+
+    private:
+        std::shared_ptr<ImageRequirement> find_image_requirement(const std::string& key) const;
+
+        // Input bound to the same resource as an output of the node, see in_place()
+        bool is_written_in_place(const std::string& key) const;
+
+        void write_descriptor_set(const ComputePass& pass, uint32_t frame, uint32_t variant);
+
+        std::vector<ComputePass>                    m_passes;
+    };
+}
@@ -1,9 +1,13 @@
 #pragma once
 
+#include <algorithm>
+#include <cmath>
 #include <memory>
 #include <vector>
+#include <glm/vec2.hpp>
 #include <ncommon/Size2D.hpp>
 #include <nscene/Scene.hpp>
+#include <nrg/common/DynamicResolution.hpp>
 #include <nrg/common/RenderPath.hpp>
 #include <nvk/Command.hpp>
 #include <nvk/Device.hpp>
@@ -30,6 +34,7 @@ namespace Nebula::nrg
         {
             auto extent = swapchain->extent();
             m_render_resolution = { extent.width, extent.height };
+            m_max_render_resolution = { extent.width, extent.height };
             m_target_resolution = { extent.width, extent.height };
             m_frames = swapchain->image_count();
         }
@@ -50,11 +55,93 @@ namespace Nebula::nrg
             m_next_render_path = nullptr;
             m_rpath_change_queued = false;
 
+            // Temporal nodes of the new render path enable it again when initialized
+            m_jitter_enabled = false;
+            m_jitter = glm::vec2(0.0f);
+            m_upscaling_enabled = false;
+            m_dynamic_resolution.reset();
+
             #ifdef NBL_DEBUG
             fmt::println("RenderPath has changed");
             #endif
         }
 
+        /**
+         * Sets the resolution render graph images are allocated for, takes effect on the next compile.
+         */
+        void set_max_render_resolution(const Size2D& resolution)
+        {
+            m_max_render_resolution = resolution;
+            m_render_resolution = resolution;
+        }
+
+        /**
+         * Picks this frame's render resolution from the GPU time of the active render path.
+         * Only scales below the maximum if an upscaler brings the image back to the target resolution.
+         */
+        void update_dynamic_resolution()
+        {
+            float scale = 1.0f;
+            if (m_dynamic_resolution.enabled && m_upscaling_enabled && m_render_path)
+            {
+                if (const auto gpu_time_ms = m_render_path->gpu_time_ms(); gpu_time_ms.has_value())
+                {
+                    m_dynamic_resolution.update(gpu_time_ms.value());
+                }
+                scale = m_dynamic_resolution.scale();
+            }
+
+            m_render_resolution = {
+                std::max(1u, static_cast<uint32_t>(static_cast<float>(m_max_render_resolution.width) * scale)),
+                std::max(1u, static_cast<uint32_t>(static_cast<float>(m_max_render_resolution.height) * scale)),
+            };
+        }
+
+        /**
+         * Part of an image sized relative to the maximum render resolution that is rendered to this frame.
+         */
+        vk::Extent2D get_active_extent(const vk::Extent2D& allocated_extent) const
+        {
+            const auto scaled = [](uint32_t allocated, uint32_t active, uint32_t max) {
+                return std::clamp(static_cast<uint32_t>(std::ceil(static_cast<double>(allocated) * active / max)), 1u, allocated);
+            };
+            return {
+                scaled(allocated_extent.width, m_render_resolution.width, m_max_render_resolution.width),
+                scaled(allocated_extent.height, m_render_resolution.height, m_max_render_resolution.height),
+            };
+        }
+
+        /**
+         * Advances the sub-pixel camera jitter to the next sample of the Halton(2, 3) sequence.
+         * Lower render scales use a longer sequence so each target pixel receives samples.
+         */
+        void advance_jitter()
+        {
+            if (!m_jitter_enabled)
+            {
+                m_jitter = glm::vec2(0.0f);
+                return;
+            }
+
+            const float scale = static_cast<float>(m_target_resolution.width) / static_cast<float>(m_render_resolution.width);
+            const auto phase_count = static_cast<uint32_t>(std::ceil(8.0f * scale * scale));
+
+            m_jitter_index = (m_jitter_index % phase_count) + 1;
+            m_jitter = { halton(m_jitter_index, 2) - 0.5f, halton(m_jitter_index, 3) - 0.5f };
+        }
+
+        static float halton(uint32_t index, const uint32_t base)
+        {
+            float f = 1.0f, result = 0.0f;
+            while (index > 0)
+            {
+                f /= static_cast<float>(base);
+                result += f * static_cast<float>(index % base);
+                index /= base;
+            }
+            return result;
+        }
+
         // Available Scenes -------------------------------------------------
         const std::vector<std::shared_ptr<ns::Scene>>& m_scene_list;
         int32_t                                        m_selected_scene {0};
@@ -65,12 +152,22 @@ namespace Nebula::nrg
         bool                                            m_rpath_change_queued {false};
 
         // Rendering Context ------------------------------------------------
+        // Images are allocated for the maximum render resolution, the render resolution
+        // is the part of them rendered to this frame (viewport & scissor).
         Size2D                                          m_render_resolution;
+        Size2D                                          m_max_render_resolution;
         Size2D                                          m_target_resolution;
+        DynamicResolution                               m_dynamic_resolution;
+        bool                                            m_upscaling_enabled {false};
         std::shared_ptr<nvk::Device>                    m_device;
         std::shared_ptr<nvk::CommandPool>               m_command_pool;
         std::shared_ptr<nvk::Swapchain>                 m_swapchain;
         uint32_t                                        m_frames;
         uint32_t&                                       m_current_frame;
+
+        // Sub-pixel camera jitter, in render resolution pixels -------------
+        bool                                            m_jitter_enabled {false};
+        uint32_t                                        m_jitter_index {0};
+        glm::vec2                                       m_jitter {0.0f};
     };
 }
\ No newline at end of file
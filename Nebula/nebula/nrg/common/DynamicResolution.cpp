@@ -0,0 +1,66 @@
+#include "DynamicResolution.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Nebula::nrg
+{
+    bool DynamicResolution::update(const double gpu_time_ms)
+    {
+        if (!m_has_samples)
+        {
+            m_filtered_ms = gpu_time_ms;
+            m_has_samples = true;
+        }
+        m_filtered_ms += s_smoothing * (gpu_time_ms - m_filtered_ms);
+
+        const float lo = std::min(min_scale, max_scale);
+        const float hi = std::max(min_scale, max_scale);
+        if (m_scale < lo || m_scale > hi)
+        {
+            m_scale = std::clamp(m_scale, lo, hi);
+            m_frames_since_change = 0;
+            return true;
+        }
+
+        if (++m_frames_since_change < settle_frames || m_filtered_ms <= 0.0)
+        {
+            return false;
+        }
+
+        // GPU time is assumed to scale with the pixel count, i.e. the square of the render scale
+        const double budget = target_frame_time_ms;
+        float next = m_scale;
+        if (m_filtered_ms > budget)
+        {
+            next = m_scale * static_cast<float>(std::sqrt(budget / m_filtered_ms));
+        }
+        else if (m_filtered_ms < budget * (1.0 - headroom))
+        {
+            const double goal = budget * (1.0 - 0.5 * headroom);
+            next = std::min(m_scale * static_cast<float>(std::sqrt(goal / m_filtered_ms)), m_scale + s_max_step);
+        }
+        next = std::clamp(next, lo, hi);
+
+        if (std::abs(next - m_scale) < s_min_step && next != lo && next != hi)
+        {
+            return false;
+        }
+        if (next == m_scale)
+        {
+            return false;
+        }
+
+        m_scale = next;
+        m_frames_since_change = 0;
+        return true;
+    }
+
+    void DynamicResolution::reset()
+    {
+        m_scale = std::max(min_scale, max_scale);
+        m_filtered_ms = 0.0;
+        m_frames_since_change = 0;
+        m_has_samples = false;
+    }
+}
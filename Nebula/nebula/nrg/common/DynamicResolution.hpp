@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Nebula::nrg
+{
+    /**
+     * Picks a render scale from measured GPU frame times to hold a frame budget.
+     * Scales down as soon as the filtered frame time exceeds the budget, but only scales up
+     * once it drops below the budget minus the headroom, so the resolution doesn't oscillate.
+     */
+    class DynamicResolution
+    {
+    public:
+        bool     enabled              {false};
+        float    target_frame_time_ms {16.0f};
+        float    min_scale            {0.5f};
+        float    max_scale            {1.0f};
+        float    headroom             {0.15f};  // Fraction of the budget left unused before scaling up
+        uint32_t settle_frames        {30};     // Frames to wait after a change for the timings to catch up
+
+        /**
+         * Feeds the GPU time of a frame, returns true if the render scale has changed.
+         */
+        bool update(double gpu_time_ms);
+
+        void reset();
+
+        float scale() const noexcept { return m_scale; }
+
+        double filtered_frame_time_ms() const noexcept { return m_filtered_ms; }
+
+    private:
+        float    m_scale               {1.0f};
+        double   m_filtered_ms         {0.0};
+        uint32_t m_frames_since_change {0};
+        bool     m_has_samples         {false};
+
+        static constexpr double s_smoothing = 0.1;   // Weight of a new sample in the moving average
+        static constexpr float  s_min_step  = 0.02f; // Smaller changes are ignored
+        static constexpr float  s_max_step  = 0.1f;  // Largest increase per change
+    };
+}
@@ -0,0 +1,56 @@
+#include "GpuTimer.hpp"
+#include <array>
+#include <fmt/format.h>
+#include <nlog/nlog.hpp>
+
+namespace Nebula::nrg
+{
+    GpuTimer::GpuTimer(const std::shared_ptr<nvk::Device>& device, const uint32_t slot_count, const std::string& name)
+    : m_device(device), m_written(slot_count, false)
+    {
+        auto query_pool_create_info = vk::QueryPoolCreateInfo()
+            .setQueryType(vk::QueryType::eTimestamp)
+            .setQueryCount(2 * slot_count);
+
+        if (const vk::Result result = m_device->handle().createQueryPool(&query_pool_create_info, nullptr, &m_query_pool);
+            result != vk::Result::eSuccess)
+        {
+            throw nlog::make_exception("Failed to create vk::QueryPool for {}: {}", name, to_string(result));
+        }
+
+        m_device->name_object(m_query_pool, fmt::format("{} Timestamps", name), vk::ObjectType::eQueryPool);
+        m_timestamp_period = m_device->physical_device().getProperties().limits.timestampPeriod;
+    }
+
+    GpuTimer::~GpuTimer()
+    {
+        if (m_query_pool)
+        {
+            m_device->handle().destroyQueryPool(m_query_pool);
+        }
+    }
+
+    std::optional<double> GpuTimer::read(const uint32_t slot) const
+    {
+        if (!m_written[slot]) return std::nullopt;
+
+        std::array<uint64_t, 2> timestamps {};
+        const auto result = m_device->handle().getQueryPoolResults(m_query_pool, 2 * slot, 2, sizeof(timestamps), timestamps.data(),
+                                                                   sizeof(uint64_t), vk::QueryResultFlagBits::e64);
+        if (result != vk::Result::eSuccess) return std::nullopt;
+
+        return static_cast<double>(timestamps[1] - timestamps[0]) * m_timestamp_period / 1'000'000.0;
+    }
+
+    void GpuTimer::begin(const vk::CommandBuffer& command_buffer, const uint32_t slot, const vk::PipelineStageFlags2 stage)
+    {
+        command_buffer.resetQueryPool(m_query_pool, 2 * slot, 2);
+        command_buffer.writeTimestamp2(stage, m_query_pool, 2 * slot);
+    }
+
+    void GpuTimer::end(const vk::CommandBuffer& command_buffer, const uint32_t slot, const vk::PipelineStageFlags2 stage)
+    {
+        command_buffer.writeTimestamp2(stage, m_query_pool, 2 * slot + 1);
+        m_written[slot] = true;
+    }
+}
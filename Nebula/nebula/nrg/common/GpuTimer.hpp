@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <nvk/Device.hpp>
+
+namespace Nebula::nrg
+{
+    /**
+     * Timestamp query pairs around GPU work, one pair per slot.
+     * A slot is read back right before it is reused, results that are still in flight are skipped,
+     * so use at least as many slots as frames in flight.
+     */
+    class GpuTimer
+    {
+    public:
+        GpuTimer(const std::shared_ptr<nvk::Device>& device, uint32_t slot_count, const std::string& name);
+
+        GpuTimer(const GpuTimer&) = delete;
+        GpuTimer& operator=(const GpuTimer&) = delete;
+
+        ~GpuTimer();
+
+        // Milliseconds between the timestamps last written to the slot, if they are available
+        std::optional<double> read(uint32_t slot) const;
+
+        void begin(const vk::CommandBuffer& command_buffer, uint32_t slot, vk::PipelineStageFlags2 stage);
+
+        void end(const vk::CommandBuffer& command_buffer, uint32_t slot, vk::PipelineStageFlags2 stage);
+
+        uint32_t slot_count() const noexcept { return static_cast<uint32_t>(m_written.size()); }
+
+    private:
+        std::shared_ptr<nvk::Device> m_device;
+        vk::QueryPool                m_query_pool;
+        std::vector<bool>            m_written;
+        float                        m_timestamp_period {1.0f};
+    };
+}
@@ -32,6 +32,42 @@ namespace Nebula::nrg
         m_common = common;
     }
 
+    vk::PipelineStageFlags2 Node::get_stage_mask(const ImageRequirement& requirement) const
+    {
+        constexpr auto any_shader = vk::PipelineStageFlagBits2::eFragmentShader | vk::PipelineStageFlagBits2::eComputeShader;
+        const auto stage_mask = requirement.stage_mask();
+        return (stage_mask == any_shader) ? shader_stages() : stage_mask;
+    }
+
+    void Node::set_swapchain_output(const std::string& key)
+    {
+        m_swapchain_output = key;
+    }
+
+    bool Node::is_swapchain_output(const std::string& key) const
+    {
+        return !m_swapchain_output.empty() && m_swapchain_output == key;
+    }
+
+    void Node::set_attachment_info(const std::string& key, const AttachmentInfo& info)
+    {
+        m_attachment_infos.insert_or_assign(key, info);
+    }
+
+    const std::map<std::string, Node::AttachmentInfo>& Node::attachment_infos() const
+    {
+        return m_attachment_infos;
+    }
+
+    Node::AttachmentInfo Node::get_attachment_info(const std::string& key) const
+    {
+        if (auto it = m_attachment_infos.find(key); it != std::end(m_attachment_infos))
+        {
+            return it->second;
+        }
+        return {};
+    }
+
     const std::string& Node::name() const
     {
         return m_name;
@@ -4,12 +4,14 @@
 #include <concepts>
 #include <memory>
 #include <map>
+#include <optional>
 #include <string>
 #include <type_traits>
 #include <utility>
 #include <vulkan/vulkan.hpp>
 #include <nlog/nlog.hpp>
 #include <nrg/common/NodeTraits.hpp>
+#include <nrg/common/PostStage.hpp>
 #include <nrg/common/ResourceClaim.hpp>
 #include <nrg/resource/Resource.hpp>
 #include <nrg/resource/Requirement.hpp>
@@ -60,6 +62,21 @@ namespace Nebula::nrg
             uint32_t     frames_in_flight {0};
         };
 
+        // Load/store ops and layouts of an output attachment, derived by the compiler from the graph
+        struct AttachmentInfo
+        {
+            vk::AttachmentLoadOp  load_op        {vk::AttachmentLoadOp::eClear};
+            vk::AttachmentStoreOp store_op       {vk::AttachmentStoreOp::eStore};
+            vk::ImageLayout       initial_layout {vk::ImageLayout::eUndefined};
+            vk::ImageLayout       final_layout   {vk::ImageLayout::eColorAttachmentOptimal};
+
+            // For nodes relying on a cleared background when the previous contents are not needed
+            vk::AttachmentLoadOp load_op_or_clear() const
+            {
+                return (load_op == vk::AttachmentLoadOp::eLoad) ? load_op : vk::AttachmentLoadOp::eClear;
+            }
+        };
+
         Node(const Node&) = delete;
         Node& operator=(const Node&) = delete;
 
@@ -79,8 +96,26 @@ namespace Nebula::nrg
         virtual const std::vector<std::shared_ptr<Requirement>>& get_resource_requirements() const = 0;
 
         virtual bool set_resource(const std::string& key, const std::shared_ptr<Resource>& resource);
+
+        // Whether the node can keep running with a fallback binding if the producer of an input is disabled
+        virtual bool has_input_fallback(const std::string& key) const { return false; }
+
+        // Called before recording a frame when the producer of an input was disabled or re-enabled
+        virtual void set_input_enabled(const std::string& key, bool enabled) {}
+
+        // Per-pixel operation the node reduces to in its configuration, consecutive ones are fused by the compiler
+        virtual std::optional<PostStage> get_post_stage() const { return std::nullopt; }
+
+        // Shader stages the node reads & writes its sampled and storage images in
+        virtual vk::PipelineStageFlags2 shader_stages() const
+        {
+            return vk::PipelineStageFlagBits2::eFragmentShader | vk::PipelineStageFlagBits2::eComputeShader;
+        }
         #pragma endregion
 
+        // Stage mask of the requirement narrowed to the shader stages of the node, used for barriers
+        vk::PipelineStageFlags2 get_stage_mask(const ImageRequirement& requirement) const;
+
         template<typename T>
         T& get_resource(const std::string& key);
 
@@ -96,10 +131,25 @@ namespace Nebula::nrg
 
         void set_common(const Common& common);
 
+        void set_swapchain_output(const std::string& key);
+
+        bool is_swapchain_output(const std::string& key) const;
+
+        void set_attachment_info(const std::string& key, const AttachmentInfo& info);
+
+        const std::map<std::string, AttachmentInfo>& attachment_infos() const;
+
     protected:
+        AttachmentInfo get_attachment_info(const std::string& key) const;
+
         Common m_common {};
         std::map<std::string, std::shared_ptr<Resource>> m_resources;
 
+        // Output rendered directly into the acquired swapchain image instead of a graph resource
+        std::string m_swapchain_output {};
+
+        std::map<std::string, AttachmentInfo> m_attachment_infos;
+
     private:
         const std::string          m_name {"Unknown Node"};
         const NodeType             m_type {NodeType::eUnknown};
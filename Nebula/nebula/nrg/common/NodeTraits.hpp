@@ -23,15 +23,20 @@ namespace Nebula::nrg
         eGBuffer,
         eHairRender,
         eHairSimulation,
+        eHiZCulling,
         eMeshShaderGBuffer,
         eRayTracing,
         eShadowMapGeneration,
         eToneMapping,
+        eVisibilityBuffer,
 
         // Unique Types
         ePresent,
         eSceneDataProvider,
 
+        // Created by the compiler
+        ePostProcess,
+
         eUnknown
     };
 
@@ -48,12 +53,15 @@ namespace Nebula::nrg
         if (str == "GBuffer")               return eGBuffer;
         if (str == "HairRender")            return eHairRender;
         if (str == "HairSimulation")        return eHairSimulation;
+        if (str == "HiZCulling")            return eHiZCulling;
         if (str == "MeshShaderGBuffer")     return eMeshShaderGBuffer;
         if (str == "RayTracing")            return eRayTracing;
         if (str == "ShadowMapGeneration")   return eShadowMapGeneration;
         if (str == "ToneMapping")           return eToneMapping;
+        if (str == "VisibilityBuffer")      return eVisibilityBuffer;
         if (str == "Present")               return ePresent;
         if (str == "SceneDataProvider")     return eSceneDataProvider;
+        if (str == "PostProcess")           return ePostProcess;
         if (str == "Unknown")               return eUnknown;
 
         throw std::runtime_error(fmt::format(R"(Unknown NodeType "{}")", str));
@@ -73,13 +81,16 @@ namespace Nebula::nrg
             case eGBuffer:              return "G-Buffer Pass";
             case eHairRender:           return "Hair Render";
             case eHairSimulation:       return "Hair Simulation";
+            case eHiZCulling:           return "Hi-Z Culling";
             case eMeshShaderGBuffer:    return "Mesh G-Buffer Pass";
             case eRayTracing:           return "Raytracing";
             case eShadowMapGeneration:  return "Shadow Map Generation";
             case eToneMapping:          return "Tone Mapping";
+            case eVisibilityBuffer:     return "Visibility Buffer Pass";
 
             case ePresent:              return "Present";
             case eSceneDataProvider:    return "Scene Data Provider";
+            case ePostProcess:          return "Post-Process";
 
             default:                    return "Unknown";
         }
@@ -90,8 +101,8 @@ namespace Nebula::nrg
         using enum NodeType;
         return {
             eAmbientOcclusion, eAntiAliasing, eBloom, eDeferredLighting, eDenoise, eGaussianBlur,
-            eGBuffer, eHairRender, eHairSimulation, eMeshShaderGBuffer, eRayTracing, eShadowMapGeneration,
-            eToneMapping, ePresent, eSceneDataProvider
+            eGBuffer, eHairRender, eHairSimulation, eHiZCulling, eMeshShaderGBuffer, eRayTracing, eShadowMapGeneration,
+            eToneMapping, eVisibilityBuffer, ePresent, eSceneDataProvider
         };
     }
 
@@ -0,0 +1,208 @@
+#include "OcclusionCulling.hpp"
+#include <algorithm>
+#include <fmt/format.h>
+#include <nlog/nlog.hpp>
+
+namespace Nebula::nrg
+{
+    namespace
+    {
+        vk::DeviceSize align(const vk::DeviceSize value)
+        {
+            return (value + DrawListLayout::s_alignment - 1) / DrawListLayout::s_alignment * DrawListLayout::s_alignment;
+        }
+
+        // Compute writes visible to later compute passes of the node
+        void compute_barrier(const vk::CommandBuffer& command_buffer)
+        {
+            auto barrier = vk::MemoryBarrier2()
+                .setSrcStageMask(vk::PipelineStageFlagBits2::eComputeShader)
+                .setSrcAccessMask(vk::AccessFlagBits2::eShaderStorageWrite)
+                .setDstStageMask(vk::PipelineStageFlagBits2::eComputeShader)
+                .setDstAccessMask(vk::AccessFlagBits2::eShaderStorageRead | vk::AccessFlagBits2::eShaderStorageWrite);
+            command_buffer.pipelineBarrier2(vk::DependencyInfo().setMemoryBarriers(barrier));
+        }
+    }
+
+    DrawListLayout::DrawListLayout(const ns::Scene& scene)
+    : batch_count(static_cast<uint32_t>(scene.instance_batches().size()))
+    , object_count(static_cast<uint32_t>(scene.objects().size()))
+    {
+        // Empty regions still get a valid descriptor range
+        const vk::DeviceSize objects_n = std::max(object_count, 1u);
+        commands   = 0;
+        objects    = align(commands + s_phases * std::max(batch_count, 1u) * sizeof(vk::DrawIndexedIndirectCommand));
+        bounds     = align(objects + objects_n * sizeof(ns::ObjectPushConstant));
+        candidates = align(bounds + objects_n * sizeof(CullBounds));
+        visibility = align(candidates + (1 + objects_n) * sizeof(uint32_t));
+        instances  = align(visibility + objects_n * sizeof(uint32_t));
+        size       = instances + s_phases * objects_n * sizeof(uint32_t);
+    }
+
+    vk::DescriptorBufferInfo DrawListLayout::region(const nvk::Buffer& buffer, const vk::DeviceSize offset, const vk::DeviceSize range) const
+    {
+        return { buffer.buffer(), offset, range };
+    }
+
+    OcclusionCuller::OcclusionCuller(const std::string& name,
+                                     const std::vector<std::shared_ptr<nvk::Image>>& depth_images,
+                                     const std::shared_ptr<nvk::Buffer>& draw_list,
+                                     const DrawListLayout& layout,
+                                     const std::shared_ptr<Context>& context)
+    : m_name(name)
+    , m_context(context)
+    , m_device(context->m_device)
+    , m_draw_list(draw_list)
+    , m_layout(layout)
+    {
+        if (depth_images.empty())
+        {
+            throw nlog::make_exception("{}: no depth image to build the Hi-Z pyramid from", m_name);
+        }
+
+        // Every level of the pyramid for the allocated extent, smaller active extents use a prefix of it
+        vk::DeviceSize texel_count = 0;
+        vk::Extent2D extent = level_extent(depth_images.front()->properties().extent);
+        while (true)
+        {
+            texel_count += static_cast<vk::DeviceSize>(extent.width) * extent.height;
+            if (extent.width == 1 && extent.height == 1) break;
+            extent = level_extent(extent);
+        }
+
+        auto pyramid_create_info = nvk::BufferCreateInfo()
+            .set_buffer_type(nvk::BufferType::eCustom)
+            .add_usage_flags(vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress)
+            .add_memory_property_flags(vk::MemoryPropertyFlagBits::eDeviceLocal)
+            .set_name(fmt::format("{} Hi-Z Pyramid", m_name))
+            .set_size(texel_count * sizeof(float));
+        m_pyramid = std::make_shared<nvk::Buffer>(pyramid_create_info, m_device);
+
+        using SSFB = vk::ShaderStageFlagBits;
+        using enum nvk::DescriptorType;
+
+        // 1. Max-depth reduction, one dispatch per level
+        auto reduce_descriptor_create_info = nvk::DescriptorCreateInfo()
+            .add(eCombinedImageSampler, 0, SSFB::eCompute)
+            .add(eStorageBuffer, 1, SSFB::eCompute)
+            .set_count(static_cast<uint32_t>(depth_images.size()))
+            .set_name(fmt::format("{} Hi-Z Reduce", m_name));
+        m_reduce_descriptor = std::make_shared<nvk::Descriptor>(reduce_descriptor_create_info, m_device);
+
+        auto reduce_pipeline_create_info = nvk::PipelineCreateInfo()
+            .set_pipeline_type(nvk::PipelineType::eCompute)
+            .add_push_constant({ SSFB::eCompute, 0, sizeof(ReducePushConstant) })
+            .add_descriptor_set_layout(m_reduce_descriptor->layout())
+            .add_shader("nrg_hiz_reduce.comp.spv", SSFB::eCompute)
+            .set_name(fmt::format("{} Hi-Z Reduce", m_name));
+        m_reduce_pipeline = std::make_shared<nvk::Pipeline>(reduce_pipeline_create_info, m_device);
+
+        const vk::DescriptorBufferInfo pyramid_info = { m_pyramid->buffer(), 0, VK_WHOLE_SIZE };
+        for (uint32_t i = 0; i < depth_images.size(); i++)
+        {
+            const auto& depth = depth_images[i];
+            const vk::DescriptorImageInfo depth_info = { depth->default_sampler(), depth->image_view(), vk::ImageLayout::eShaderReadOnlyOptimal };
+            auto write_info = nvk::DescriptorWriteInfo()
+                .set_set_index(i)
+                .add_combined_image_sampler(0, depth_info)
+                .add_storage_buffer(1, pyramid_info);
+            m_reduce_descriptor->write(write_info);
+        }
+
+        // 2. Occlusion test & compaction of the candidates
+        auto cull_descriptor_create_info = nvk::DescriptorCreateInfo()
+            .add(eStorageBuffer, 0, SSFB::eCompute)
+            .add(eStorageBuffer, 1, SSFB::eCompute)
+            .add(eStorageBuffer, 2, SSFB::eCompute)
+            .add(eStorageBuffer, 3, SSFB::eCompute)
+            .add(eStorageBuffer, 4, SSFB::eCompute)
+            .add(eStorageBuffer, 5, SSFB::eCompute)
+            .set_count(1)
+            .set_name(fmt::format("{} Hi-Z Cull", m_name));
+        m_cull_descriptor = std::make_shared<nvk::Descriptor>(cull_descriptor_create_info, m_device);
+
+        auto cull_pipeline_create_info = nvk::PipelineCreateInfo()
+            .set_pipeline_type(nvk::PipelineType::eCompute)
+            .add_push_constant({ SSFB::eCompute, 0, sizeof(CullPushConstant) })
+            .add_descriptor_set_layout(m_cull_descriptor->layout())
+            .add_shader("nrg_hiz_cull.comp.spv", SSFB::eCompute)
+            .set_name(fmt::format("{} Hi-Z Cull", m_name));
+        m_cull_pipeline = std::make_shared<nvk::Pipeline>(cull_pipeline_create_info, m_device);
+
+        const auto& buffer = *m_draw_list;
+        const auto commands_info   = m_layout.region(buffer, m_layout.commands, m_layout.objects - m_layout.commands);
+        const auto bounds_info     = m_layout.region(buffer, m_layout.bounds, m_layout.candidates - m_layout.bounds);
+        const auto candidates_info = m_layout.region(buffer, m_layout.candidates, m_layout.visibility - m_layout.candidates);
+        const auto visibility_info = m_layout.region(buffer, m_layout.visibility, m_layout.instances - m_layout.visibility);
+        const auto instances_info  = m_layout.region(buffer, m_layout.instances, m_layout.size - m_layout.instances);
+        auto write_info = nvk::DescriptorWriteInfo()
+            .set_set_index(0)
+            .add_storage_buffer(0, pyramid_info)
+            .add_storage_buffer(1, commands_info)
+            .add_storage_buffer(2, bounds_info)
+            .add_storage_buffer(3, candidates_info)
+            .add_storage_buffer(4, visibility_info)
+            .add_storage_buffer(5, instances_info);
+        m_cull_descriptor->write(write_info);
+    }
+
+    void OcclusionCuller::build_pyramid(const vk::CommandBuffer& command_buffer, const uint32_t set_idx, const vk::Extent2D& depth_extent)
+    {
+        m_reduce_pipeline->bind(command_buffer);
+        m_reduce_pipeline->bind_descriptor_set(command_buffer, m_reduce_descriptor->set(set_idx));
+
+        m_depth_extent = depth_extent;
+        m_level_0 = level_extent(depth_extent);
+        m_level_count = 0;
+
+        vk::Extent2D src = depth_extent;
+        vk::Extent2D dst = m_level_0;
+        int32_t src_offset = 0, dst_offset = 0;
+        while (true)
+        {
+            const ReducePushConstant push_constant {
+                .src = { static_cast<int32_t>(src.width), static_cast<int32_t>(src.height), src_offset, m_level_count == 0 ? 1 : 0 },
+                .dst = { static_cast<int32_t>(dst.width), static_cast<int32_t>(dst.height), dst_offset, 0 },
+            };
+            command_buffer.pushConstants(m_reduce_pipeline->layout(), vk::ShaderStageFlagBits::eCompute, 0, sizeof(ReducePushConstant), &push_constant);
+            command_buffer.dispatch((dst.width + 7) / 8, (dst.height + 7) / 8, 1);
+            compute_barrier(command_buffer);
+            m_level_count++;
+
+            if (dst.width == 1 && dst.height == 1) break;
+
+            src = dst;
+            src_offset = dst_offset;
+            dst_offset += static_cast<int32_t>(dst.width * dst.height);
+            dst = level_extent(dst);
+        }
+    }
+
+    void OcclusionCuller::cull(const vk::CommandBuffer& command_buffer, const uint32_t set_idx, const glm::mat4& view_proj,
+                               const uint32_t phase, const bool pyramid_valid) const
+    {
+        const CullPushConstant push_constant {
+            .view_proj = view_proj,
+            .params    = { static_cast<int32_t>(phase), static_cast<int32_t>(m_layout.batch_count), static_cast<int32_t>(m_level_count), pyramid_valid ? 1 : 0 },
+            .extent    = { static_cast<int32_t>(m_level_0.width), static_cast<int32_t>(m_level_0.height),
+                           static_cast<int32_t>(m_depth_extent.width), static_cast<int32_t>(m_depth_extent.height) },
+        };
+
+        m_cull_pipeline->bind(command_buffer);
+        m_cull_pipeline->bind_descriptor_set(command_buffer, m_cull_descriptor->set(0));
+        command_buffer.pushConstants(m_cull_pipeline->layout(), vk::ShaderStageFlagBits::eCompute, 0, sizeof(CullPushConstant), &push_constant);
+        command_buffer.dispatch((m_layout.object_count + s_group_size - 1) / s_group_size, 1, 1);
+    }
+
+    void OcclusionCuller::barrier_to_draw(const vk::CommandBuffer& command_buffer)
+    {
+        using enum vk::PipelineStageFlagBits2;
+        using enum vk::AccessFlagBits2;
+        auto barrier = vk::MemoryBarrier2()
+            .setSrcStageMask(eComputeShader | eAllTransfer)
+            .setSrcAccessMask(eShaderStorageWrite | eTransferWrite)
+            .setDstStageMask(eDrawIndirect | eVertexShader | eComputeShader)
+            .setDstAccessMask(eIndirectCommandRead | eShaderStorageRead | eShaderStorageWrite);
+        command_buffer.pipelineBarrier2(vk::DependencyInfo().setMemoryBarriers(barrier));
+    }
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.hpp>
+#include <nrg/common/Context.hpp>
+#include <nscene/Object.hpp>
+#include <nscene/Scene.hpp>
+#include <nvk/Buffer.hpp>
+#include <nvk/Descriptor.hpp>
+#include <nvk/Device.hpp>
+#include <nvk/Image.hpp>
+#include <nvk/render/Pipeline.hpp>
+
+namespace Nebula::nrg
+{
+    // Per-object input of the culling shader, matches CullBounds of nrg_hiz_cull.comp
+    struct alignas(16) CullBounds
+    {
+        glm::vec4 center;  // [ World Center | Batch Index ]
+        glm::vec4 extent;  // [ World Half Extent | Always Visible ]
+    };
+
+    /**
+     * Regions of the draw list buffer shared by the occlusion culling phases & the G-Buffer, each aligned for a
+     * storage buffer descriptor of its own. The host part (commands, objects, bounds & candidates) is written from the
+     * host, the objects & bounds only when they moved. Instances are the object indices of the drawn instances, the
+     * G-Buffer reads the object data through them.
+     *
+     * [ Draw Commands: Phase 1 | Phase 2 ] [ Objects ] [ Bounds ] [ Candidate Count | Candidates ] [ Visibility ] [ Instances: Phase 1 | Phase 2 ]
+     */
+    struct DrawListLayout
+    {
+        uint32_t       batch_count  {0};
+        uint32_t       object_count {0};
+
+        vk::DeviceSize commands     {0};
+        vk::DeviceSize objects      {0};
+        vk::DeviceSize bounds       {0};
+        vk::DeviceSize candidates   {0};
+        vk::DeviceSize visibility   {0};
+        vk::DeviceSize instances    {0};
+        vk::DeviceSize size         {0};
+
+        DrawListLayout() = default;
+
+        explicit DrawListLayout(const ns::Scene& scene);
+
+        // Bytes written from the host each frame, starting at offset 0
+        vk::DeviceSize host_size() const { return visibility; }
+
+        vk::DeviceSize commands_offset(uint32_t phase) const { return commands + phase * batch_count * sizeof(vk::DrawIndexedIndirectCommand); }
+
+        vk::DescriptorBufferInfo region(const nvk::Buffer& buffer, vk::DeviceSize offset, vk::DeviceSize range) const;
+
+        static constexpr uint32_t       s_phases = 2;
+
+        // Largest minStorageBufferOffsetAlignment allowed by the spec
+        static constexpr vk::DeviceSize s_alignment = 256;
+    };
+
+    /**
+     * Hierarchical depth pyramid & occlusion test shared by the two culling phases.
+     * The pyramid is a max-depth mip chain of the active part of a depth image, stored level after level in a buffer.
+     * Culling tests the candidates of the draw list against it and appends the visible ones to the instances of
+     * their batch in the draw commands of the phase, the first phase also records which objects it has drawn.
+     */
+    class OcclusionCuller
+    {
+        struct ReducePushConstant
+        {
+            glm::ivec4 src;  // [ Width, Height, Offset, Read Depth ]
+            glm::ivec4 dst;  // [ Width, Height, Offset, - ]
+        };
+
+        struct CullPushConstant
+        {
+            glm::mat4  view_proj;
+            glm::ivec4 params;  // [ Phase, Batch Count, Level Count, Pyramid Valid ]
+            glm::ivec4 extent;  // [ Level 0 Width, Level 0 Height, Depth Width, Depth Height ]
+        };
+
+    public:
+        // depth_images holds the depth image sampled by each descriptor set (one per frame in flight)
+        OcclusionCuller(const std::string& name,
+                        const std::vector<std::shared_ptr<nvk::Image>>& depth_images,
+                        const std::shared_ptr<nvk::Buffer>& draw_list,
+                        const DrawListLayout& layout,
+                        const std::shared_ptr<Context>& context);
+
+        // Reduces the active extent of the depth image of the set, the depth has to be in eShaderReadOnlyOptimal
+        void build_pyramid(const vk::CommandBuffer& command_buffer, uint32_t set_idx, const vk::Extent2D& depth_extent);
+
+        // Culls the candidates for a phase against the last built pyramid, an invalid pyramid lets every candidate pass
+        void cull(const vk::CommandBuffer& command_buffer, uint32_t set_idx, const glm::mat4& view_proj,
+                  uint32_t phase, bool pyramid_valid) const;
+
+        // Draw list writes of a compute pass against the draws & the culling of later passes
+        static void barrier_to_draw(const vk::CommandBuffer& command_buffer);
+
+        static constexpr uint32_t s_group_size = 64;
+
+    private:
+        static vk::Extent2D level_extent(const vk::Extent2D& extent) { return { std::max(1u, (extent.width + 1) / 2), std::max(1u, (extent.height + 1) / 2) }; }
+
+        std::string                      m_name;
+        std::shared_ptr<Context>         m_context;
+        std::shared_ptr<nvk::Device>     m_device;
+        std::shared_ptr<nvk::Buffer>     m_draw_list;
+        DrawListLayout                   m_layout;
+
+        std::shared_ptr<nvk::Buffer>     m_pyramid;
+        std::shared_ptr<nvk::Pipeline>   m_reduce_pipeline;
+        std::shared_ptr<nvk::Pipeline>   m_cull_pipeline;
+        std::shared_ptr<nvk::Descriptor> m_reduce_descriptor;
+        std::shared_ptr<nvk::Descriptor> m_cull_descriptor;
+
+        vk::Extent2D                     m_depth_extent {1, 1};
+        vk::Extent2D                     m_level_0 {1, 1};
+        uint32_t                         m_level_count {1};
+    };
+}
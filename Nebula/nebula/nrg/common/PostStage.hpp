@@ -0,0 +1,39 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+namespace Nebula::nrg
+{
+    // Operations of the post-processing uber shader, values match the OP_* constants of nrg_post_process.comp
+    enum class PostOp : uint32_t
+    {
+        eNone        = 0,
+        eResample    = 1,   // Bilinear resample of the active input area, only valid as the first stage
+        eToneMapping = 2,
+    };
+
+    inline std::string to_string(const PostOp op)
+    {
+        using enum PostOp;
+        switch (op)
+        {
+            case eResample:    return "Resample";
+            case eToneMapping: return "Tone Mapping";
+            default:           return "None";
+        }
+    }
+
+    /**
+     * Per-pixel post-processing step of a node, reading at most a bounded neighbourhood of a single input.
+     * Chains of stages where each output is only read by the next stage are fused into one PostProcess pass.
+     */
+    struct PostStage
+    {
+        PostOp               op {PostOp::eNone};
+        std::array<float, 4> params {};
+        std::string          input;     // Resource keys of the node the stage reads & writes
+        std::string          output;
+    };
+}
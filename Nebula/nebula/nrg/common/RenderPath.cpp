@@ -1,9 +1,13 @@
 #include "RenderPath.hpp"
 
+#include <fmt/format.h>
+#include <tuple>
 #include <vulkan/vulkan.hpp>
+#include "nrg/common/GpuTimer.hpp"
 #include "nrg/common/Node.hpp"
 #include "nrg/resource/Resources.hpp"
 #include "nvk/Barrier.hpp"
+#include "nvk/Device.hpp"
 
 #ifdef NBL_DEBUG
 #include <fmt/printf.h>
@@ -12,6 +16,14 @@
 
 namespace Nebula::nrg
 {
+    namespace
+    {
+        constexpr vk::AccessFlags2 s_write_access = vk::AccessFlagBits2::eShaderWrite | vk::AccessFlagBits2::eShaderStorageWrite
+                                                  | vk::AccessFlagBits2::eColorAttachmentWrite | vk::AccessFlagBits2::eDepthStencilAttachmentWrite
+                                                  | vk::AccessFlagBits2::eTransferWrite | vk::AccessFlagBits2::eHostWrite
+                                                  | vk::AccessFlagBits2::eMemoryWrite;
+    }
+
     void push_debug_label(const std::array<float, 4>& color, const std::string& name, const vk::CommandBuffer& command_buffer)
     {
         auto label = vk::DebugUtilsLabelEXT().setColor(color).setPLabelName(name.c_str());
@@ -23,6 +35,38 @@ namespace Nebula::nrg
         command_buffer.endDebugUtilsLabelEXT();
     }
 
+    RenderPath::RenderPath(std::vector<std::shared_ptr<Node>>&& nodes, std::map<std::string, std::shared_ptr<Resource>>&& resources,
+                           std::vector<SplitBarrier>&& split_barriers, const std::shared_ptr<nvk::Device>& device)
+    : m_nodes(std::move(nodes)), m_resources(std::move(resources))
+    , m_enabled(m_nodes.size(), true), m_pending_enabled(m_nodes.size(), true)
+    , m_split_barriers(std::move(split_barriers)), m_device(device)
+    {
+        // Events are only ever set & waited on from the device
+        const auto event_create_info = vk::EventCreateInfo().setFlags(vk::EventCreateFlagBits::eDeviceOnly);
+        for (auto& split_barrier : m_split_barriers)
+        {
+            if (const vk::Result result = m_device->handle().createEvent(&event_create_info, nullptr, &split_barrier.event);
+                result != vk::Result::eSuccess)
+            {
+                throw nlog::make_exception("Failed to create vk::Event for split barrier {} -> {}: {}",
+                                           m_nodes[split_barrier.producer]->name(), m_nodes[split_barrier.consumer]->name(), to_string(result));
+            }
+            m_device->name_object(split_barrier.event,
+                                  fmt::format("Split Barrier ({} -> {})", m_nodes[split_barrier.producer]->name(), m_nodes[split_barrier.consumer]->name()),
+                                  vk::ObjectType::eEvent);
+        }
+
+        m_gpu_timer = std::make_shared<GpuTimer>(m_device, s_query_slots, "RenderPath");
+    }
+
+    RenderPath::~RenderPath()
+    {
+        for (const auto& split_barrier : m_split_barriers)
+        {
+            m_device->handle().destroyEvent(split_barrier.event);
+        }
+    }
+
     void RenderPath::execute(const vk::CommandBuffer& command_buffer)
     {
         if (!m_initialized)
@@ -35,9 +79,26 @@ namespace Nebula::nrg
             #endif
         }
 
-        for (const auto& node : m_nodes)
+        apply_pending_node_states();
+
+        const uint32_t query_slot = m_frame_count++ % s_query_slots;
+        if (const auto gpu_time_ms = m_gpu_timer->read(query_slot); gpu_time_ms.has_value())
+        {
+            m_gpu_time_ms = gpu_time_ms;
+        }
+        m_gpu_timer->begin(command_buffer, query_slot, vk::PipelineStageFlagBits2::eTopOfPipe);
+
+        // The previous frame has finished on the device, events can be reused
+        for (auto& split_barrier : m_split_barriers)
+        {
+            command_buffer.resetEvent2(split_barrier.event, vk::PipelineStageFlagBits2::eAllCommands);
+            split_barrier.pending = false;
+        }
+
+        for (size_t i = 0; i < m_nodes.size(); i++)
         {
-            if (node->type() == NodeType::eSceneDataProvider)
+            const auto& node = m_nodes[i];
+            if (node->type() == NodeType::eSceneDataProvider || !m_enabled[i])
             {
                 continue;
             }
@@ -48,14 +109,18 @@ namespace Nebula::nrg
 
             node->update();
 
+            const auto split_covered = wait_split_barriers(i, command_buffer);
+
             #pragma region "evaluate barriers"
             std::vector<vk::ImageMemoryBarrier2> barriers;
             auto res_reqs = node->get_resource_requirements();
+
+            // Images bound to multiple requirements (in-place execution) transition to the output layout
+            std::map<std::shared_ptr<nvk::Image>, ImageRequirement> image_requirements;
             for (const auto& [ id, resource ] : node->resources())
             {
                 if (resource->type() != ResourceType::eImage) continue;
                 auto r_image = resource->as<ImageResource>();
-                if (r_image.get_image()->state().layout == vk::ImageLayout::eDepthAttachmentOptimal) continue;
 
                 auto fnd = std::ranges::find_if(res_reqs, [&, id](const auto& rr){ return rr->name == id; });
                 if (fnd == std::end(res_reqs))
@@ -64,46 +129,303 @@ namespace Nebula::nrg
                 }
                 ImageRequirement req = (*fnd)->as<ImageRequirement>();
 
-                const auto& image = r_image.get_image();
+                const auto& image = req.previous_frame ? r_image.get_previous_image() : r_image.get_image();
+                if (image_requirements.contains(image) && req.usage != ResourceUsage::eOutput) continue;
+                image_requirements.insert_or_assign(image, req);
+            }
+
+            const auto& attachment_infos = node->attachment_infos();
+            std::vector<vk::MemoryBarrier2> memory_barriers;
+            std::vector<std::tuple<std::shared_ptr<nvk::Image>, vk::PipelineStageFlags2, vk::AccessFlags2>> accesses;
+            for (const auto& [ image, req ] : image_requirements)
+            {
+                // Memory last used by another image (aliasing) holds nothing this one could read,
+                // on first use the image keeps the layout it was prepared in (e.g. cleared history)
+                const nvk::Image* memory_user = image.get();
+                if (const auto& allocation = image->allocation())
+                {
+                    auto& last_user = m_memory_users[allocation.get()];
+                    if (last_user != nullptr) memory_user = last_user;
+                    last_user = image.get();
+                }
+                const bool memory_switched = (memory_user != image.get());
+
+                vk::ImageLayout old_layout = memory_switched ? vk::ImageLayout::eUndefined : image->state().layout;
+                vk::ImageLayout new_layout = req.expected_layout;
+                const vk::PipelineStageFlags2 dst_stage = node->get_stage_mask(req);
+                vk::AccessFlags2 dst_access = req.access_mask();
+                bool discarded = false;
+                if (auto it = attachment_infos.find(req.name); it != std::end(attachment_infos))
+                {
+                    // Discarded attachments are transitioned from eUndefined by the render pass again, nothing to keep
+                    discarded = (it->second.initial_layout == vk::ImageLayout::eUndefined);
+                    if (discarded)
+                    {
+                        old_layout = vk::ImageLayout::eUndefined;
+                    }
+                    else
+                    {
+                        new_layout = it->second.initial_layout;
+                    }
+
+                    // Loaded attachments are read by the render pass as well
+                    if (it->second.load_op == vk::AttachmentLoadOp::eLoad)
+                    {
+                        ImageRequirement loaded = req;
+                        loaded.usage = ResourceUsage::eInput;
+                        dst_access |= loaded.access_mask();
+                    }
+                }
+                accesses.emplace_back(image, dst_stage, dst_access);
+
+                // Ordered after the producer or the previous readers by the events the node waited on
+                if (split_covered.contains(image)) continue;
+
+                // Accesses to the memory since its last barrier, by this image or the one it was aliased with
+                const auto& previous = memory_user->state();
+                const vk::AccessFlags2 dst_reads = dst_access & ~s_write_access;
+                const bool reads_visible = (previous.stage_flags & dst_stage) == dst_stage && (previous.access_flags & dst_reads) == dst_reads;
+                const bool used = (previous.stage_flags != vk::PipelineStageFlagBits2::eNone);
+
+                const bool hazard = (old_layout != new_layout && !discarded)                   // Layout transition
+                                 || (previous.access_flags & s_write_access)                   // Read / write after write
+                                 || (used && (dst_access & s_write_access))                    // Write after read
+                                 || (used && !reads_visible);                                  // Earlier writes visible to other stages only
+
+                if (!hazard)
+                {
+                    // Reads in the same layout don't need to wait for each other
+                    const auto& current = memory_switched ? nvk::ImageState {} : image->state();
+                    image->update_state({current.access_flags | dst_access, new_layout, current.stage_flags | dst_stage});
+                    continue;
+                }
+
+                // Waits for the stages that used the memory last & makes their writes visible, nothing before them
+                vk::PipelineStageFlags2 src_stage = previous.stage_flags;
+                const vk::AccessFlags2 src_access = previous.access_flags & s_write_access;
+                if (!used && src_access) src_stage = vk::PipelineStageFlagBits2::eAllCommands;
 
-                auto barrier = nvk::ImageBarrier(image, image->state().layout, req.expected_layout);
-                barriers.push_back(barrier.barrier());
+                auto barrier = nvk::ImageBarrier(image, old_layout, new_layout).barrier();
+                barrier
+                    .setSrcStageMask(src_stage)
+                    .setSrcAccessMask(src_access)
+                    .setDstStageMask(dst_stage)
+                    .setDstAccessMask(dst_access);
+                barriers.push_back(barrier);
 
-                // Interesting assumption but let's go with this for now
-                image->update_state({vk::AccessFlagBits2::eNone, req.expected_layout});
+                // The writes of the aliased image aren't covered by a barrier on this one
+                if (memory_switched && src_access)
+                {
+                    memory_barriers.push_back(vk::MemoryBarrier2(src_stage, src_access, dst_stage, dst_access));
+                }
+
+                image->update_state({dst_access, new_layout, dst_stage});
             }
 
-            auto barrier_dependency_info = vk::DependencyInfo()
-                .setPImageMemoryBarriers(barriers.data())
-                .setImageMemoryBarrierCount(barriers.size());
+            if (!barriers.empty() || !memory_barriers.empty())
+            {
+                auto barrier_dependency_info = vk::DependencyInfo()
+                    .setImageMemoryBarriers(barriers)
+                    .setMemoryBarriers(memory_barriers);
 
-            command_buffer.pipelineBarrier2(barrier_dependency_info);
+                command_buffer.pipelineBarrier2(barrier_dependency_info);
+            }
             #pragma endregion
 
             node->execute(command_buffer);
 
+            // Barriers recorded by the node itself reset the state, the accesses of the node are still outstanding
+            for (const auto& [ image, stage, access ] : accesses)
+            {
+                auto state = image->state();
+                state.stage_flags |= stage;
+                state.access_flags |= access;
+                image->update_state(state);
+            }
+
+            for (const auto& [ key, info ] : attachment_infos)
+            {
+                if (!node->resources().contains(key)) continue;
+                const auto& image = node->resources()[key]->as<ImageResource>().get_image();
+                auto state = image->state();
+                state.layout = info.final_layout;
+                image->update_state(state);
+            }
+
+            set_split_barriers(i, command_buffer);
+
             #ifdef NBL_DEBUG
             pop_debug_label(command_buffer);
             #endif
         }
+
+        m_gpu_timer->end(command_buffer, query_slot, vk::PipelineStageFlagBits2::eAllCommands);
     }
 
     void RenderPath::initialize(const vk::CommandBuffer& command_buffer)
     {
-        for (const auto& [id, resource] : m_resources)
+        // Images start out in eUndefined, the first barrier or render pass using them sets the layout
+        for (const auto& node : m_nodes)
+        {
+            node->initialize();
+        }
+
+        m_initialized = true;
+    }
+
+    std::set<std::shared_ptr<nvk::Image>> RenderPath::wait_split_barriers(size_t node_idx, const vk::CommandBuffer& command_buffer)
+    {
+        std::set<std::shared_ptr<nvk::Image>> result;
+        for (auto& split_barrier : m_split_barriers)
         {
-            if (resource->type() == ResourceType::eImage)
+            // Disabled producers never signal, their consumers fall back to the barriers of the node
+            if (split_barrier.consumer != node_idx || !split_barrier.pending) continue;
+
+            auto dependency_info = vk::DependencyInfo()
+                .setImageMemoryBarriers(split_barrier.barriers)
+                .setMemoryBarriers(split_barrier.memory_barriers);
+            command_buffer.waitEvents2(1, &split_barrier.event, &dependency_info);
+
+            for (size_t b = 0; b < split_barrier.barriers.size(); b++)
             {
-                auto image = resource->as<ImageResource>().get_image();
-                nvk::ImageBarrier(image, image->state().layout, vk::ImageLayout::eGeneral).apply(command_buffer);
+                const auto& barrier = split_barrier.barriers[b];
+                split_barrier.images[b]->update_state({barrier.dstAccessMask, barrier.newLayout, barrier.dstStageMask});
+                result.insert(split_barrier.images[b]);
             }
+            split_barrier.pending = false;
         }
+        return result;
+    }
 
-        for (const auto& node : m_nodes)
+    void RenderPath::set_split_barriers(size_t node_idx, const vk::CommandBuffer& command_buffer)
+    {
+        for (auto& split_barrier : m_split_barriers)
         {
-            node->initialize();
+            if (split_barrier.producer != node_idx || !m_enabled[split_barrier.consumer]) continue;
+
+            split_barrier.barriers.clear();
+            split_barrier.images.clear();
+            split_barrier.memory_barriers.clear();
+            for (const auto& transition : split_barrier.transitions)
+            {
+                if (transition.execution_only)
+                {
+                    split_barrier.memory_barriers.push_back(vk::MemoryBarrier2(transition.src_stage_mask, transition.src_access_mask,
+                                                                               transition.dst_stage_mask, vk::AccessFlagBits2::eNone));
+                    continue;
+                }
+
+                const auto& image = transition.resource->as<ImageResource>().get_image();
+                const auto old_layout = transition.discard ? vk::ImageLayout::eUndefined : image->state().layout;
+                auto barrier = nvk::ImageBarrier(image, old_layout, transition.new_layout).barrier();
+                barrier
+                    .setSrcStageMask(transition.src_stage_mask)
+                    .setSrcAccessMask(transition.src_access_mask)
+                    .setDstStageMask(transition.dst_stage_mask)
+                    .setDstAccessMask(transition.dst_access_mask);
+                split_barrier.barriers.push_back(barrier);
+                split_barrier.images.push_back(image);
+
+                // Writes to the aliased image aren't covered by the barrier on this one
+                if (transition.discard && transition.src_access_mask)
+                {
+                    split_barrier.memory_barriers.push_back(vk::MemoryBarrier2(transition.src_stage_mask, transition.src_access_mask,
+                                                                               transition.dst_stage_mask, transition.dst_access_mask));
+                }
+            }
+
+            auto dependency_info = vk::DependencyInfo()
+                .setImageMemoryBarriers(split_barrier.barriers)
+                .setMemoryBarriers(split_barrier.memory_barriers);
+            command_buffer.setEvent2(split_barrier.event, &dependency_info);
+            split_barrier.pending = true;
         }
+    }
 
-        m_initialized = true;
+    bool RenderPath::set_node_enabled(size_t node_idx, bool enabled)
+    {
+        if (node_idx >= m_nodes.size())
+        {
+            return false;
+        }
+
+        const auto node_type = m_nodes[node_idx]->type();
+        if (node_type == NodeType::eSceneDataProvider || node_type == NodeType::ePresent)
+        {
+            return false;
+        }
+
+        if (!enabled)
+        {
+            for (const auto& [ consumer, input ] : get_output_consumers(node_idx))
+            {
+                if (!consumer->has_input_fallback(input)) return false;
+            }
+        }
+
+        m_pending_enabled[node_idx] = enabled;
+        return true;
+    }
+
+    bool RenderPath::is_node_enabled(size_t node_idx) const
+    {
+        return node_idx < m_pending_enabled.size() && m_pending_enabled[node_idx];
+    }
+
+    void RenderPath::apply_pending_node_states()
+    {
+        for (size_t i = 0; i < m_nodes.size(); i++)
+        {
+            if (m_enabled[i] == m_pending_enabled[i]) continue;
+
+            m_enabled[i] = m_pending_enabled[i];
+            for (const auto& [ consumer, input ] : get_output_consumers(i))
+            {
+                consumer->set_input_enabled(input, m_enabled[i]);
+            }
+
+            #ifdef NBL_DEBUG
+            fmt::println("Node {} was {}", m_nodes[i]->name(), m_enabled[i] ? "enabled" : "disabled");
+            #endif
+        }
+    }
+
+    std::vector<std::pair<std::shared_ptr<Node>, std::string>> RenderPath::get_output_consumers(size_t node_idx) const
+    {
+        std::vector<std::pair<std::shared_ptr<Node>, std::string>> result;
+
+        const auto& node = m_nodes[node_idx];
+        const auto usage_of = [](const std::shared_ptr<Node>& n, const std::string& key) {
+            const auto& rs = n->get_resource_requirements();
+            auto fnd = std::ranges::find_if(rs, [&](const auto& r){ return r->name == key; });
+            return (fnd == std::end(rs)) ? ResourceUsage::eUnknown : (*fnd)->usage;
+        };
+
+        for (const auto& [ key, resource ] : node->resources())
+        {
+            if (usage_of(node, key) != ResourceUsage::eOutput) continue;
+
+            // Written in-place, the input passes through to the consumers unchanged
+            const bool is_in_place = std::ranges::any_of(node->resources(), [&](const auto& kv){
+                return kv.second == resource && usage_of(node, kv.first) == ResourceUsage::eInput;
+            });
+            if (is_in_place) continue;
+
+            // Consumers until the resource is written again by an aliased output
+            for (size_t j = node_idx + 1; j < m_nodes.size(); j++)
+            {
+                bool overwritten = false;
+                for (const auto& [ c_key, c_resource ] : m_nodes[j]->resources())
+                {
+                    if (c_resource != resource) continue;
+                    const auto usage = usage_of(m_nodes[j], c_key);
+                    if (usage == ResourceUsage::eInput)  result.emplace_back(m_nodes[j], c_key);
+                    if (usage == ResourceUsage::eOutput) overwritten = true;
+                }
+                if (overwritten) break;
+            }
+        }
+
+        return result;
     }
 }
@@ -3,37 +3,89 @@
 #include <algorithm>
 #include <map>
 #include <memory>
+#include <optional>
+#include <set>
 #include <string>
+#include <utility>
 #include <vector>
+#include <vulkan/vulkan.hpp>
+#include <nrg/common/SplitBarrier.hpp>
 
-namespace vk
+namespace Nebula::nvk
 {
-    class CommandBuffer;
+    class Allocation;
+    class Device;
+    class Image;
 }
 
 namespace Nebula::nrg
 {
+    class GpuTimer;
     class Node;
     class Resource;
 
     class RenderPath
     {
     public:
-        RenderPath(std::vector<std::shared_ptr<Node>>&& nodes, std::map<std::string, std::shared_ptr<Resource>>&& resources)
-        : m_nodes(std::move(nodes)), m_resources(std::move(resources))
-        {
-        }
+        RenderPath(std::vector<std::shared_ptr<Node>>&& nodes, std::map<std::string, std::shared_ptr<Resource>>&& resources,
+                   std::vector<SplitBarrier>&& split_barriers, const std::shared_ptr<nvk::Device>& device);
+
+        ~RenderPath();
 
         void execute(const vk::CommandBuffer& command_buffer);
 
+        /**
+         * Queues enabling or disabling a node, the change is applied before recording the next frame.
+         * Returns false if the node or one of the consumers of its outputs can't do without it.
+         */
+        bool set_node_enabled(size_t node_idx, bool enabled);
+
+        bool is_node_enabled(size_t node_idx) const;
+
+        /**
+         * GPU time of the most recent frame with available timestamps, empty until the first one is read back.
+         */
+        std::optional<double> gpu_time_ms() const noexcept { return m_gpu_time_ms; }
+
     private:
 
         void initialize(const vk::CommandBuffer& command_buffer);
 
+        void apply_pending_node_states();
+
+        // Waits on the events signalled by the producers of the node's inputs and the readers of the memory it
+        // overwrites, returns the images they transitioned
+        std::set<std::shared_ptr<nvk::Image>> wait_split_barriers(size_t node_idx, const vk::CommandBuffer& command_buffer);
+
+        // Signals the events the consumers of the node's outputs and the next writers of the images it read wait on
+        void set_split_barriers(size_t node_idx, const vk::CommandBuffer& command_buffer);
+
+        // Nodes reading the outputs of the given node, mapped to the input names they are read as
+        std::vector<std::pair<std::shared_ptr<Node>, std::string>> get_output_consumers(size_t node_idx) const;
+
         bool                                             m_initialized {false};
         std::vector<std::shared_ptr<Node>>               m_nodes;
         std::map<std::string, std::shared_ptr<Resource>> m_resources;
 
+        // Runtime node enable mask ----------------------------------------
+        std::vector<bool>                                m_enabled;
+        std::vector<bool>                                m_pending_enabled;
+
+        // Split barriers between dependency levels ------------------------
+        std::vector<SplitBarrier>                        m_split_barriers;
+        std::shared_ptr<nvk::Device>                     m_device;
+
+        // Image that last used each allocation, an aliased image taking over the memory starts from eUndefined and
+        // waits on the stages recorded in the state of the previous one
+        std::map<const nvk::Allocation*, const nvk::Image*> m_memory_users;
+
+        // GPU frame time --------------------------------------------------
+        std::shared_ptr<GpuTimer>                        m_gpu_timer;
+        uint32_t                                         m_frame_count {0};
+        std::optional<double>                            m_gpu_time_ms;
+
+        static constexpr uint32_t                        s_query_slots = 4;
+
         friend class GraphEditor;
     };
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <memory>
 #include <string>
 #include <uuid.h>
 #include <nmath/Utility.hpp>
@@ -22,5 +23,12 @@ namespace Nebula::nrg
         std::string   name()  const { return req ? req->name  : "Unknown Resource"; }
         ResourceType  type()  const { return req ? req->type  : ResourceType::eUnknown; }
         ResourceUsage usage() const { return req ? req->usage : ResourceUsage::eUnknown; }
+
+        // Input reading the version the connected output wrote in the previous frame
+        bool reads_previous_frame() const
+        {
+            const auto image_req = std::dynamic_pointer_cast<ImageRequirement>(req);
+            return image_req && image_req->previous_frame;
+        }
     };
 }
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+namespace Nebula::nvk
+{
+    class Image;
+}
+
+namespace Nebula::nrg
+{
+    class Resource;
+
+    /**
+     * Transition of a single image resource between two nodes: from its producer to the first consumer (read after
+     * write), or from the readers since the last write to the next writer (write after read).
+     */
+    struct ImageTransition
+    {
+        std::shared_ptr<Resource> resource;
+        vk::PipelineStageFlags2   src_stage_mask  {vk::PipelineStageFlagBits2::eNone};
+        vk::AccessFlags2          src_access_mask {vk::AccessFlagBits2::eNone};
+        vk::PipelineStageFlags2   dst_stage_mask  {vk::PipelineStageFlagBits2::eNone};
+        vk::AccessFlags2          dst_access_mask {vk::AccessFlagBits2::eNone};
+        vk::ImageLayout           new_layout      {vk::ImageLayout::eUndefined};
+
+        // Only orders the stages, the image is transitioned by another transition to the same node
+        bool                      execution_only  {false};
+
+        // The memory was last used by another image (aliasing), the previous contents are discarded
+        bool                      discard         {false};
+    };
+
+    /**
+     * Dependency between two nodes, signalled with vkCmdSetEvent2 after the producer
+     * and waited on with vkCmdWaitEvents2 just before the consumer.
+     */
+    struct SplitBarrier
+    {
+        size_t                                    producer {0};
+        size_t                                    consumer {0};
+        std::vector<ImageTransition>              transitions;
+
+        // Runtime state, the barriers passed to the wait must match the ones the event was set with
+        vk::Event                                 event {};
+        std::vector<vk::ImageMemoryBarrier2>      barriers;
+        std::vector<std::shared_ptr<nvk::Image>>  images;
+        std::vector<vk::MemoryBarrier2>           memory_barriers;
+        bool                                      pending {false};
+    };
+}
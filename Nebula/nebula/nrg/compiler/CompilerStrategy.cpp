@@ -84,4 +84,78 @@ namespace Nebula::nrg
 
         return result;
     }
+
+    std::map<int32_t, int32_t>
+    CompilerStrategy::get_dependency_levels(const std::vector<std::shared_ptr<EditorNode>>& execution_order,
+                                            const std::vector<Edge>& edges)
+    {
+        std::map<int32_t, int32_t> levels; // Graph ID -> Level
+        for (const auto& node : execution_order)
+        {
+            int32_t level = 0;
+            for (const auto& edge : edges)
+            {
+                // Producers later in the order can only be previous frame reads
+                if (edge.end.node_id == node->id() && levels.contains(edge.start.node_id))
+                {
+                    level = std::max(level, levels[edge.start.node_id] + 1);
+                }
+            }
+            levels.insert({ node->id(), level });
+        }
+        return levels;
+    }
+
+    std::optional<SwapchainOutput>
+    CompilerStrategy::find_swapchain_output(const std::vector<std::shared_ptr<EditorNode>>& execution_order,
+                                            const std::vector<Edge>& edges) const
+    {
+        const auto& present_node = execution_order.back();
+        if (present_node->type() != NodeType::ePresent)
+        {
+            return std::nullopt;
+        }
+
+        const auto present_edge = std::ranges::find_if(edges, [&](const Edge& e){ return e.end.node_id == present_node->id(); });
+        if (present_edge == std::end(edges))
+        {
+            return std::nullopt;
+        }
+
+        // The output may not be read by anything other than Present
+        const auto consumer_count = std::ranges::count_if(edges, [&](const Edge& e){
+            return e.start.node_id == present_edge->start.node_id && e.start.resource_id == present_edge->start.resource_id;
+        });
+        if (consumer_count != 1)
+        {
+            return std::nullopt;
+        }
+
+        const auto producer = std::ranges::find_if(execution_order, [&](const auto& n){ return n->id() == present_edge->start.node_id; });
+        if (producer == std::end(execution_order))
+        {
+            return std::nullopt;
+        }
+
+        const auto& claim = (*producer)->get_resource(present_edge->start.resource_id);
+        if (claim.type() != ResourceType::eImage)
+        {
+            return std::nullopt;
+        }
+
+        // Format of the attachment follows the swapchain, only the extent has to match
+        const auto& req = claim.req->as<ImageRequirement>();
+        const auto swapchain_extent = m_context->m_swapchain->extent();
+        const auto extent = req.get_extent(static_cast<vk::Extent2D>(m_context->m_max_render_resolution),
+                                           static_cast<vk::Extent2D>(m_context->m_target_resolution));
+        const bool extent_compatible = extent == swapchain_extent
+                                       && static_cast<vk::Extent2D>(m_context->m_max_render_resolution) == swapchain_extent;
+
+        if (!req.presentable || req.format == vk::Format::eD32Sfloat || !extent_compatible)
+        {
+            return std::nullopt;
+        }
+
+        return SwapchainOutput { *producer, claim, present_edge->id };
+    }
 }
\ No newline at end of file
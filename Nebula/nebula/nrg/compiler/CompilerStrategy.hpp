@@ -1,6 +1,8 @@
 #pragma once
 
+#include <map>
 #include <memory>
+#include <optional>
 #include <nrg/common/Context.hpp>
 #include <nrg/compiler/CompilerResult.hpp>
 #include <nrg/compiler/factory/NodeFactory.hpp>
@@ -10,6 +12,13 @@
 
 namespace Nebula::nrg
 {
+    struct SwapchainOutput
+    {
+        std::shared_ptr<EditorNode> node;           // Node feeding Present
+        ResourceClaim               claim;          // Output claim rendered into the swapchain image
+        int32_t                     present_edge;   // ID of the Edge between the output and Present
+    };
+
     class CompilerStrategy
     {
         using NodePtr = std::shared_ptr<EditorNode>;
@@ -26,10 +35,15 @@ namespace Nebula::nrg
 
         static std::vector<NodePtr> get_execution_order(const std::vector<NodePtr>& nodes);
 
+        // Groups nodes by the longest chain of producers before them, nodes on the same level are independent
+        static std::map<int32_t, int32_t> get_dependency_levels(const std::vector<NodePtr>& execution_order,
+                                                               const std::vector<Edge>& edges);
+
+        std::optional<SwapchainOutput> find_swapchain_output(const std::vector<NodePtr>& execution_order,
+                                                             const std::vector<Edge>& edges) const;
+
         std::unique_ptr<NodeFactory>     m_node_factory;
         std::unique_ptr<ResourceFactory> m_resource_factory;
-
-    private:
         std::shared_ptr<Context>         m_context;
     };
 }
\ No newline at end of file
@@ -14,10 +14,36 @@ namespace Nebula::nrg
             case NodeType::eGBuffer: {
                 return std::make_shared<GBuffer>(m_context);
             }
+            case NodeType::eVisibilityBuffer: {
+                return std::make_shared<VisibilityBuffer>(m_context);
+            }
+            case NodeType::eHiZCulling: {
+                return std::make_shared<HiZCulling>(m_context);
+            }
             case NodeType::eDeferredLighting: {
                 auto config = std::dynamic_pointer_cast<DeferredLighting::Configuration>(editor_node->node_configuration());
                 return std::make_shared<DeferredLighting>(config, m_context);
             }
+            case NodeType::eAmbientOcclusion: {
+                auto config = std::dynamic_pointer_cast<AmbientOcclusion::Configuration>(editor_node->node_configuration());
+                return std::make_shared<AmbientOcclusion>(config, m_context);
+            }
+            case NodeType::eAntiAliasing: {
+                auto config = std::dynamic_pointer_cast<AntiAliasing::Configuration>(editor_node->node_configuration());
+                return std::make_shared<AntiAliasing>(config, m_context);
+            }
+            case NodeType::eBloom: {
+                auto config = std::dynamic_pointer_cast<Bloom::Configuration>(editor_node->node_configuration());
+                return std::make_shared<Bloom>(config, m_context);
+            }
+            case NodeType::eShadowMapGeneration: {
+                auto config = std::dynamic_pointer_cast<ShadowMapGeneration::Configuration>(editor_node->node_configuration());
+                return std::make_shared<ShadowMapGeneration>(config, m_context);
+            }
+            case NodeType::eToneMapping: {
+                auto config = std::dynamic_pointer_cast<ToneMapping::Configuration>(editor_node->node_configuration());
+                return std::make_shared<ToneMapping>(config, m_context);
+            }
             case NodeType::ePresent: {
                 return std::make_shared<Present>(m_context);
             }
@@ -1,4 +1,5 @@
 #include "ResourceFactory.hpp"
+#include <fmt/format.h>
 #include <nlog/nlog.hpp>
 #include <nrg/resource/Resources.hpp>
 
@@ -20,11 +21,13 @@ namespace Nebula::nrg
             }
             case ResourceType::eImage: {
                 bool is_depth_image = (create_info.format == vk::Format::eD32Sfloat);
-                vk::Extent2D extent = create_info.claim.req->as<ImageRequirement>().extent;
+                vk::Extent2D extent = create_info.extent;
 
                 if (extent.width == 0 || extent.height == 0)
                 {
-                    extent = m_context->m_swapchain->extent();
+                    extent = create_info.claim.req->as<ImageRequirement>().get_extent(
+                        static_cast<vk::Extent2D>(m_context->m_max_render_resolution),
+                        static_cast<vk::Extent2D>(m_context->m_target_resolution));
                 }
 
                 using enum vk::ImageAspectFlagBits;
@@ -38,7 +41,20 @@ namespace Nebula::nrg
                     .set_sample_count(vk::SampleCountFlagBits::e1)
                     .set_usage_flags((is_depth_image ? eSampled | eDepthStencilAttachment : create_info.usage_flags | eColorAttachment))
                     .set_tiling(vk::ImageTiling::eOptimal)
+                    .set_memory_alias(create_info.memory_alias)
                     .set_with_sampler(true);
+
+                if (create_info.history)
+                {
+                    std::vector<std::shared_ptr<nvk::Image>> images;
+                    for (uint32_t i = 0; i < s_history_length; i++)
+                    {
+                        image_info.set_name(fmt::format("{} (Frame {})", create_info.name, i));
+                        images.push_back(nvk::Image::create(image_info, m_context->m_device));
+                    }
+                    return std::make_shared<ImageResource>(images, m_context->m_current_frame, create_info.name);
+                }
+
                 return std::make_shared<ImageResource>(nvk::Image::create(image_info, m_context->m_device),
                                                        create_info.name);
             }
@@ -46,7 +62,22 @@ namespace Nebula::nrg
                 throw nlog::make_exception("ImageArray Resources are not supported yet.");
             }
             case ResourceType::eStorageBuffer: {
-                throw nlog::make_exception("StorageBuffer Resources are not supported yet.");
+                const auto& req = create_info.claim.req->as<BufferRequirement>();
+                if (!req.size)
+                {
+                    throw nlog::make_exception("StorageBuffer Resource \"{}\" has no size", req.name);
+                }
+
+                // Written & read on the GPU only, barriers between the nodes are up to the producer
+                auto buffer_info = nvk::BufferCreateInfo()
+                    .set_buffer_type(nvk::BufferType::eCustom)
+                    .add_usage_flags(req.usage_flags | vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eShaderDeviceAddress)
+                    .add_memory_property_flags(vk::MemoryPropertyFlagBits::eDeviceLocal)
+                    .set_size(req.size(*m_context->get_selected_scene()))
+                    .set_name(create_info.name);
+
+                return std::make_shared<BufferResource>(nvk::Buffer::create(buffer_info, m_context->m_device),
+                                                        create_info.name);
             }
             default:
                 return nullptr;
@@ -17,6 +17,9 @@ namespace Nebula::nrg
         std::string           name;
         ResourceType          type;
         vk::ImageUsageFlags   usage_flags;
+        bool                  history {false};
+        vk::Extent2D          extent {0, 0};    // Resolved extent, taken from the requirement if 0x0
+        std::shared_ptr<nvk::Allocation> memory_alias {};
     };
 
     class ResourceFactory
@@ -27,6 +30,9 @@ namespace Nebula::nrg
         std::shared_ptr<Resource> create(const ResourceCreateInfo& create_info);
 
     private:
+        // Number of versions kept of history resources: current and previous frame
+        static constexpr uint32_t s_history_length = 2;
+
         std::shared_ptr<Context> m_context;
     };
 }
\ No newline at end of file
@@ -1,8 +1,12 @@
 #include "OptimizedCompiler.hpp"
 
+#include <algorithm>
 #include <fmt/format.h>
 #include <fmt/chrono.h>
+#include <functional>
 #include <sstream>
+#include <nrg/node/PostProcess.hpp>
+#include <nrg/resource/Resources.hpp>
 #include "ResourceOptimizer.hpp"
 
 namespace Nebula::nrg
@@ -14,8 +18,8 @@ namespace Nebula::nrg
 
     CompilerResult OptimizedCompiler::compile(const Graph& graph)
     {
-        auto  nodes = graph.get_nodes_vector();
-        auto& edges = graph.edges;
+        auto nodes = graph.get_nodes_vector();
+        auto edges = graph.edges;
 
         CompilerResult result = {};
         std::vector<std::string>& logs = result.internal_logs;
@@ -49,15 +53,38 @@ namespace Nebula::nrg
         std::vector<node_ptr> execution_order;
         try {
             execution_order = get_execution_order(connected_nodes);
+
+            // Only a reorder: independent nodes end up between producers and consumers, so the split barriers
+            // can overlap with them. The levels aren't used past this point
+            const auto levels = get_dependency_levels(execution_order, edges);
+            std::ranges::stable_sort(execution_order, {}, [&](const auto& n){ return levels.at(n->id()); });
+
             logs.push_back(fmt_nodes_str(fmt::format("Execution order: ({}):", execution_order.size()), execution_order));
+            logs.push_back(fmt::format("Dependency levels: {}", levels.at(execution_order.back()->id()) + 1));
         }
         catch (const std::runtime_error& ex) {
             make_failed_result(result, ex.what());
             return result;
         }
 
-        // 3. Resource optimization ---------------------------------
+        // 2.1 Render directly into the swapchain image -------------
         ResourceOptimizerOptions optimizer_options { true };
+        optimizer_options.render_resolution = static_cast<vk::Extent2D>(m_context->m_max_render_resolution);
+        optimizer_options.target_resolution = static_cast<vk::Extent2D>(m_context->m_target_resolution);
+
+        auto swapchain_output = find_swapchain_output(execution_order, edges);
+        if (swapchain_output.has_value())
+        {
+            // Present copy pass is no longer needed
+            execution_order.pop_back();
+            std::erase_if(edges, [&](const Edge& e){ return e.id == swapchain_output->present_edge; });
+            optimizer_options.external_resources.insert(swapchain_output->claim.id);
+
+            logs.push_back(fmt::format("Node [{}] renders \"{}\" directly into the swapchain image, Present pass was removed.",
+                                       swapchain_output->node->name(), swapchain_output->claim.name()));
+        }
+
+        // 3. Resource optimization ---------------------------------
         ResourceOptimizerResult optimizer_result;
         auto resource_optimizer = std::make_shared<ResourceOptimizer>(execution_order, edges, optimizer_options);
 
@@ -75,24 +102,56 @@ namespace Nebula::nrg
         {
             auto name = fmt::format("({:%Y-%m-%d %H:%M}) Resource {}", result.start_timestamp, gen_res.id);
 
-            ResourceCreateInfo create_info = {
+            std::vector<std::pair<std::string, ResourceCreateInfo>> segments;
+            segments.emplace_back(std::to_string(gen_res.id), ResourceCreateInfo {
                 .claim       = gen_res.original_info.claim,
                 .format      = gen_res.format,
                 .name        = name,
                 .type        = gen_res.type,
                 .usage_flags = gen_res.usage_flags,
-            };
-
-            auto resource = m_resource_factory->create(create_info);
+                .history     = gen_res.persistent,
+                .extent      = gen_res.extent,
+            });
 
-            if (!resource)
+            for (size_t i = 0; i < gen_res.memory_aliases.size(); i++)
             {
-                logs.push_back(fmt::format("Failed to create {} resource: {}", to_string(gen_res.type), name));
-                continue;
+                const auto& alias = gen_res.memory_aliases[i];
+                segments.emplace_back(get_alias_key(gen_res.id, i), ResourceCreateInfo {
+                    .claim       = alias.original_info.claim,
+                    .format      = alias.format,
+                    .name        = fmt::format("{} (Alias {})", name, i),
+                    .type        = gen_res.type,
+                    .usage_flags = alias.usage_flags,
+                    .extent      = alias.extent,
+                });
             }
 
-            logs.push_back(fmt::format("Created {} resource: {}", to_string(gen_res.type), name));
-            resources.insert({ std::to_string(gen_res.id), resource });
+            // The largest image owns the memory, the rest of the timeline is bound to it
+            std::ranges::stable_sort(segments, std::greater {}, [](const auto& segment){
+                const auto& info = segment.second;
+                return static_cast<vk::DeviceSize>(info.extent.width) * info.extent.height * get_format_size(info.format);
+            });
+
+            std::shared_ptr<nvk::Allocation> memory;
+            for (auto& [ key, create_info ] : segments)
+            {
+                create_info.memory_alias = memory;
+                auto resource = m_resource_factory->create(create_info);
+
+                if (!resource)
+                {
+                    logs.push_back(fmt::format("Failed to create {} resource: {}", to_string(gen_res.type), create_info.name));
+                    continue;
+                }
+
+                if (!memory && !gen_res.memory_aliases.empty())
+                {
+                    memory = resource->as<ImageResource>().get_image()->allocation();
+                }
+
+                logs.push_back(fmt::format("Created {}{} resource: {}", gen_res.persistent ? "history " : "", to_string(gen_res.type), create_info.name));
+                resources.insert({ key, resource });
+            }
         }
 
         // 5. Create Nodes ------------------------------------------
@@ -108,6 +167,12 @@ namespace Nebula::nrg
             }
         }
 
+        if (swapchain_output.has_value() && node_mapping.contains(swapchain_output->node->id()))
+        {
+            auto& rgn = rg_nodes[node_mapping[swapchain_output->node->id()]];
+            rgn->set_swapchain_output(swapchain_output->claim.name());
+        }
+
         // 6. Connect resources to nodes ----------------------------
         for (const auto& opt_resource : optimizer_result.resources)
         {
@@ -125,10 +190,45 @@ namespace Nebula::nrg
                 auto& cnode_consumer = rg_nodes[node_mapping[consumer.user_node_id]];
                 cnode_consumer->set_resource(consumer.used_as, resource);
             }
+
+            // 6.3 Connect memory aliases to their users
+            for (size_t i = 0; i < opt_resource.memory_aliases.size(); i++)
+            {
+                auto& alias_resource = resources[get_alias_key(opt_resource.id, i)];
+                for (const auto& user : opt_resource.memory_aliases[i].usage_points)
+                {
+                    auto& cnode_user = rg_nodes[node_mapping[user.user_node_id]];
+                    cnode_user->set_resource(user.used_as, alias_resource);
+                }
+            }
+
+            // 6.4 Connect to nodes writing the resource in-place
+            for (const auto& writer : opt_resource.in_place_points)
+            {
+                auto& cnode_writer = rg_nodes[node_mapping[writer.user_node_id]];
+                cnode_writer->set_resource(writer.used_as, resource);
+            }
         }
 
+        // 6.5 Fuse per-pixel post-processing chains --------------
+        fuse_post_process_chains(rg_nodes, resources, logs);
+
+        // 6.6 Derive attachment load/store ops and layouts --------
+        derive_attachment_infos(rg_nodes, logs);
+
+        // 6.7 Schedule split barriers between producers & consumers
+        auto split_barriers = schedule_split_barriers(rg_nodes);
+        logs.push_back(fmt::format("Scheduled {} split barrier(s).", split_barriers.size()));
+
         // 7. Create RenderPath -------------------------------------
-        auto render_path = std::make_shared<RenderPath>(std::move(rg_nodes), std::move(resources));
+        std::shared_ptr<RenderPath> render_path;
+        try {
+            render_path = std::make_shared<RenderPath>(std::move(rg_nodes), std::move(resources), std::move(split_barriers), m_context->m_device);
+        }
+        catch (const std::runtime_error& ex) {
+            make_failed_result(result, ex.what());
+            return result;
+        }
 
         // 8. Fill & Finalize result --------------------------------
         result.render_path = render_path;
@@ -137,6 +237,345 @@ namespace Nebula::nrg
         return result;
     }
 
+    std::string OptimizedCompiler::get_alias_key(int32_t resource_id, size_t alias_idx)
+    {
+        return fmt::format("{}.{}", resource_id, alias_idx);
+    }
+
+    std::shared_ptr<ImageRequirement> OptimizedCompiler::get_image_requirement(const std::shared_ptr<Node>& node, const std::string& key)
+    {
+        const auto& rs = node->get_resource_requirements();
+        auto fnd = std::ranges::find_if(rs, [&](const auto& r){ return r->name == key; });
+        return (fnd == std::end(rs)) ? nullptr : std::dynamic_pointer_cast<ImageRequirement>(*fnd);
+    }
+
+    std::optional<OptimizedCompiler::NextAccess>
+    OptimizedCompiler::find_next_access(const std::vector<std::shared_ptr<Node>>& nodes, size_t node_idx, const std::shared_ptr<Resource>& resource)
+    {
+        for (size_t j = node_idx + 1; j < nodes.size(); j++)
+        {
+            NextAccess access { .node_idx = j };
+            for (const auto& [ key, c_resource ] : nodes[j]->resources())
+            {
+                if (c_resource != resource) continue;
+                auto req = get_image_requirement(nodes[j], key);
+                if (!req) continue;
+
+                if (req->usage == ResourceUsage::eOutput) access.write = req;
+                else if (req->usage == ResourceUsage::eInput && !req->previous_frame) access.read = req;
+            }
+
+            if (access.read || access.write)
+            {
+                return access;
+            }
+        }
+        return std::nullopt;
+    }
+
+    std::vector<OptimizedCompiler::PreviousRead>
+    OptimizedCompiler::find_previous_reads(const std::vector<std::shared_ptr<Node>>& nodes, size_t node_idx, const std::shared_ptr<Resource>& resource)
+    {
+        std::vector<PreviousRead> result;
+        for (size_t j = node_idx; j-- > 0;)
+        {
+            bool written = false;
+            for (const auto& [ key, p_resource ] : nodes[j]->resources())
+            {
+                if (!shares_memory(p_resource, resource)) continue;
+                auto req = get_image_requirement(nodes[j], key);
+                if (!req) continue;
+
+                if (req->usage == ResourceUsage::eOutput) written = true;
+                else if (req->usage == ResourceUsage::eInput && !req->previous_frame)
+                {
+                    if (result.empty() || result.back().node_idx != j) result.push_back({ j, p_resource, req });
+                }
+            }
+
+            // Reads of an in-place writer are ordered before its own write
+            if (written)
+            {
+                std::erase_if(result, [&](const PreviousRead& read){ return read.node_idx == j; });
+                break;
+            }
+        }
+        return result;
+    }
+
+    bool OptimizedCompiler::shares_memory(const std::shared_ptr<Resource>& a, const std::shared_ptr<Resource>& b)
+    {
+        if (a == b) return true;
+        if (a->type() != ResourceType::eImage || b->type() != ResourceType::eImage) return false;
+        return std::ranges::any_of(a->as<ImageResource>().images(), [&](const auto& image){
+            return std::ranges::any_of(b->as<ImageResource>().images(), [&](const auto& other){
+                return image->allocation() != nullptr && image->allocation() == other->allocation();
+            });
+        });
+    }
+
+    bool OptimizedCompiler::is_in_place_output(const std::shared_ptr<Node>& node, const std::shared_ptr<Resource>& resource)
+    {
+        return std::ranges::any_of(node->resources(), [&](const auto& kv){
+            auto req = get_image_requirement(node, kv.first);
+            return kv.second == resource && req && req->usage == ResourceUsage::eInput;
+        });
+    }
+
+    void OptimizedCompiler::fuse_post_process_chains(std::vector<std::shared_ptr<Node>>& nodes,
+                                                     std::map<std::string, std::shared_ptr<Resource>>& resources,
+                                                     std::vector<std::string>& logs) const
+    {
+        const auto uses_resource = [](const std::shared_ptr<Node>& node, const std::shared_ptr<Resource>& resource) {
+            return std::ranges::any_of(node->resources(), [&](const auto& kv){ return kv.second == resource; });
+        };
+
+        // Nodes are only fused with their direct successor, moving a pass would break the memory aliasing timeline
+        for (size_t i = 0; i < nodes.size(); i++)
+        {
+            const auto first_stage = nodes[i]->get_post_stage();
+            if (!first_stage.has_value())
+            {
+                continue;
+            }
+
+            if (!nodes[i]->resources().contains(first_stage->input))
+            {
+                continue;
+            }
+
+            std::vector<PostStage> stages = { *first_stage };
+            std::vector<std::shared_ptr<Resource>> intermediates;
+            const auto chain_input = nodes[i]->resources().at(first_stage->input);
+            bool rejected_alias = false;
+            for (size_t j = i + 1; j < nodes.size() && stages.size() < PostProcess::s_max_stages; j++)
+            {
+                const auto& prev = nodes[j - 1];
+                const auto& prev_stage = stages.back();
+                if (prev->is_swapchain_output(prev_stage.output) || !prev->resources().contains(prev_stage.output))
+                {
+                    break;
+                }
+
+                // The output may not be written in-place or read by anything but the next stage
+                const auto intermediate = prev->resources().at(prev_stage.output);
+                const auto next_stage = nodes[j]->get_post_stage();
+                if (!next_stage.has_value() || next_stage->op == PostOp::eResample
+                    || (prev->resources().contains(prev_stage.input) && prev->resources().at(prev_stage.input) == intermediate)
+                    || std::ranges::count_if(nodes, [&](const auto& node){ return uses_resource(node, intermediate); }) != 2
+                    || std::ranges::count_if(nodes[j]->resources(), [&](const auto& kv){ return kv.second == intermediate; }) != 1
+                    || !nodes[j]->resources().contains(next_stage->input) || nodes[j]->resources().at(next_stage->input) != intermediate
+                    || !nodes[j]->resources().contains(next_stage->output))
+                {
+                    break;
+                }
+
+                // A fused pass reads its input while writing the output, the two can't be the same image or memory
+                if (shares_memory(chain_input, nodes[j]->resources().at(next_stage->output)))
+                {
+                    rejected_alias = true;
+                    break;
+                }
+
+                stages.push_back(*next_stage);
+                intermediates.push_back(intermediate);
+            }
+
+            if (rejected_alias)
+            {
+                logs.push_back(fmt::format("Stopped fusing after [{}], the next output shares memory with the chain input.",
+                                           nodes[i + stages.size() - 1]->name()));
+            }
+
+            if (stages.size() < 2)
+            {
+                continue;
+            }
+
+            const size_t last = i + stages.size() - 1;
+            std::string fused_names;
+            for (size_t j = i; j <= last; j++)
+            {
+                fused_names += fmt::format(" [{}]", nodes[j]->name());
+            }
+
+            auto fused = std::make_shared<PostProcess>(stages, m_context);
+            fused->set_resource(PostProcess::s_input, nodes[i]->resources().at(stages.front().input));
+            fused->set_resource(PostProcess::s_output, nodes[last]->resources().at(stages.back().output));
+
+            nodes.erase(nodes.begin() + static_cast<std::ptrdiff_t>(i) + 1, nodes.begin() + static_cast<std::ptrdiff_t>(last) + 1);
+            nodes[i] = fused;
+
+            // Intermediates are released unless another resource is bound to their memory
+            size_t released = 0;
+            for (const auto& intermediate : intermediates)
+            {
+                const bool memory_in_use = std::ranges::any_of(resources, [&](const auto& kv){
+                    return kv.second != intermediate && shares_memory(kv.second, intermediate);
+                });
+
+                if (!memory_in_use)
+                {
+                    released += std::erase_if(resources, [&](const auto& kv){ return kv.second == intermediate; });
+                }
+            }
+
+            logs.push_back(fmt::format("Fused{} into a single pass \"{}\", released {} intermediate image(s).",
+                                       fused_names, fused->name(), released));
+        }
+    }
+
+    void OptimizedCompiler::derive_attachment_infos(const std::vector<std::shared_ptr<Node>>& nodes, std::vector<std::string>& logs)
+    {
+        using enum vk::AttachmentLoadOp;
+        using enum vk::AttachmentStoreOp;
+
+        int32_t discarded_loads = 0, discarded_stores = 0;
+        for (size_t i = 0; i < nodes.size(); i++)
+        {
+            const auto& node = nodes[i];
+            for (const auto& [ key, resource ] : node->resources())
+            {
+                auto req = get_image_requirement(node, key);
+                if (!req || req->usage != ResourceUsage::eOutput || !req->is_attachment() || node->is_swapchain_output(key))
+                {
+                    continue;
+                }
+
+                // Previous contents are only needed when written in-place on an input
+                const bool is_in_place = is_in_place_output(node, resource);
+
+                // Outputs read as the previous frame by a consumer are promoted to history resources
+                const bool is_history = req->history || resource->as<ImageResource>().is_history();
+
+                Node::AttachmentInfo info {
+                    .load_op        = is_in_place ? eLoad : eDontCare,
+                    .store_op       = is_history ? eStore : eDontCare,
+                    .initial_layout = is_in_place ? req->expected_layout : vk::ImageLayout::eUndefined,
+                    .final_layout   = req->expected_layout,
+                };
+
+                // The next node touching the resource decides whether the result is stored and in which layout
+                if (auto next = find_next_access(nodes, i, resource); next.has_value() && next->read)
+                {
+                    // In-place writers transition the image to their output layout
+                    info.store_op = eStore;
+                    info.final_layout = next->write ? next->write->expected_layout : next->read->expected_layout;
+                }
+
+                if (info.load_op == eDontCare) discarded_loads++;
+                if (info.store_op == eDontCare) discarded_stores++;
+                node->set_attachment_info(key, info);
+            }
+        }
+
+        logs.push_back(fmt::format("Derived attachment operations, discarded {} load(s) and {} store(s).", discarded_loads, discarded_stores));
+    }
+
+    std::vector<SplitBarrier> OptimizedCompiler::schedule_split_barriers(const std::vector<std::shared_ptr<Node>>& nodes)
+    {
+        std::vector<SplitBarrier> result;
+
+        // All transitions between the same two nodes share an event
+        const auto add_transition = [&](size_t producer, size_t consumer, const ImageTransition& transition) {
+            auto fnd = std::ranges::find_if(result, [&](const SplitBarrier& sb){
+                return sb.producer == producer && sb.consumer == consumer;
+            });
+            if (fnd == std::end(result))
+            {
+                result.push_back(SplitBarrier { .producer = producer, .consumer = consumer });
+                fnd = std::prev(std::end(result));
+            }
+            fnd->transitions.push_back(transition);
+        };
+
+        // Read after write, from the producer to the first consumer
+        for (size_t i = 0; i < nodes.size(); i++)
+        {
+            const auto& node = nodes[i];
+            for (const auto& [ key, resource ] : node->resources())
+            {
+                auto req = get_image_requirement(node, key);
+                if (!req || req->usage != ResourceUsage::eOutput || node->is_swapchain_output(key)) continue;
+
+                // In-place outputs are signalled once, by the producer of the input
+                if (is_in_place_output(node, resource)) continue;
+
+                auto next = find_next_access(nodes, i, resource);
+                if (!next.has_value() || !next->read) continue;
+
+                // The consumer needs the image in its output layout if it writes in-place
+                const auto& dst = next->write ? next->write : next->read;
+                vk::ImageLayout new_layout = dst->expected_layout;
+                if (const auto& infos = nodes[next->node_idx]->attachment_infos(); next->write && infos.contains(next->write->name))
+                {
+                    new_layout = infos.at(next->write->name).initial_layout;
+                }
+
+                ImageTransition transition {
+                    .resource        = resource,
+                    .src_stage_mask  = node->get_stage_mask(*req),
+                    .src_access_mask = req->access_mask(),
+                    .dst_stage_mask  = nodes[next->node_idx]->get_stage_mask(*next->read) | nodes[next->node_idx]->get_stage_mask(*dst),
+                    .dst_access_mask = next->read->access_mask() | dst->access_mask(),
+                    .new_layout      = new_layout,
+                };
+                add_transition(i, next->node_idx, transition);
+            }
+        }
+
+        // Write after read, from the readers since the last write to the next writer of the memory (reused or aliased)
+        for (size_t i = 0; i < nodes.size(); i++)
+        {
+            const auto& node = nodes[i];
+            for (const auto& [ key, resource ] : node->resources())
+            {
+                auto req = get_image_requirement(node, key);
+                if (!req || req->usage != ResourceUsage::eOutput || node->is_swapchain_output(key)) continue;
+
+                const auto reads = find_previous_reads(nodes, i, resource);
+                if (reads.empty()) continue;
+
+                // Discarded attachments are transitioned from eUndefined by the render pass, the others are expected
+                // in the layout they're loaded or written in
+                vk::ImageLayout new_layout = req->expected_layout;
+                if (const auto& infos = node->attachment_infos(); infos.contains(key) && infos.at(key).initial_layout != vk::ImageLayout::eUndefined)
+                {
+                    new_layout = infos.at(key).initial_layout;
+                }
+
+                // In-place writers read the image as well
+                vk::PipelineStageFlags2 dst_stage = node->get_stage_mask(*req);
+                vk::AccessFlags2 dst_access = req->access_mask();
+                for (const auto& [ i_key, i_resource ] : node->resources())
+                {
+                    auto input = get_image_requirement(node, i_key);
+                    if (i_resource != resource || !input || input->usage != ResourceUsage::eInput) continue;
+                    dst_stage |= node->get_stage_mask(*input);
+                    dst_access |= input->access_mask();
+                }
+
+                // Only the closest reader transitions the image, the earlier ones just have to finish first
+                for (size_t r = 0; r < reads.size(); r++)
+                {
+                    const auto& read = reads[r];
+                    ImageTransition transition {
+                        .resource        = resource,
+                        .src_stage_mask  = nodes[read.node_idx]->get_stage_mask(*read.requirement),
+                        .src_access_mask = vk::AccessFlagBits2::eNone,
+                        .dst_stage_mask  = dst_stage,
+                        .dst_access_mask = dst_access,
+                        .new_layout      = new_layout,
+                        .execution_only  = r > 0,
+                        .discard         = read.resource != resource,
+                    };
+                    add_transition(read.node_idx, i, transition);
+                }
+            }
+        }
+        return result;
+    }
+
     std::string OptimizedCompiler::fmt_nodes_str(const std::string& prefix, const std::vector<node_ptr>& nodes)
     {
         std::stringstream input_nodes_str;
@@ -1,7 +1,10 @@
 #pragma once
 
+#include <map>
 #include <memory>
+#include <optional>
 #include <nrg/common/Context.hpp>
+#include <nrg/common/SplitBarrier.hpp>
 #include <nrg/compiler/CompilerResult.hpp>
 #include <nrg/compiler/CompilerStrategy.hpp>
 #include <nrg/editor/Graph.hpp>
@@ -22,6 +25,63 @@ namespace Nebula::nrg
     private:
         static void make_failed_result(CompilerResult& result, const std::string& error_message);
 
+        static std::string get_alias_key(int32_t resource_id, size_t alias_idx);
+
+        /**
+         * Replaces chains of adjacent per-pixel post-processing nodes with a single PostProcess pass. A node joins the
+         * chain if it is the only reader of the previous stage's output, the intermediate images are released.
+         * Runs after resource optimization, so the chain ends before an output that is the chain input or is aliased to
+         * its memory.
+         */
+        void fuse_post_process_chains(std::vector<std::shared_ptr<Node>>& nodes,
+                                      std::map<std::string, std::shared_ptr<Resource>>& resources,
+                                      std::vector<std::string>& logs) const;
+
+        /**
+         * Derives the load/store ops and layouts of every output attachment from the readers of its resource:
+         * previous contents are only loaded for in-place writes, stores are dropped if nothing reads the result later
+         * and the final layout is the one the next reader expects.
+         */
+        static void derive_attachment_infos(const std::vector<std::shared_ptr<Node>>& nodes, std::vector<std::string>& logs);
+
+        /**
+         * Creates a split barrier from each producer to the first consumer of its outputs, with the stage & access
+         * masks of both sides. Later readers in the same layout are covered by the same dependency.
+         * Outputs that reuse an image or aliased memory also wait on the readers since its last write, the closest one
+         * transitions the image and the earlier ones only add an execution dependency.
+         */
+        static std::vector<SplitBarrier> schedule_split_barriers(const std::vector<std::shared_ptr<Node>>& nodes);
+
+        // Helpers for walking the created nodes --------------------
+        struct NextAccess
+        {
+            size_t                            node_idx {0};
+            std::shared_ptr<ImageRequirement> read;
+            std::shared_ptr<ImageRequirement> write;
+        };
+
+        static std::shared_ptr<ImageRequirement> get_image_requirement(const std::shared_ptr<Node>& node, const std::string& key);
+
+        // First node after the given one reading or writing the resource
+        static std::optional<NextAccess> find_next_access(const std::vector<std::shared_ptr<Node>>& nodes, size_t node_idx,
+                                                          const std::shared_ptr<Resource>& resource);
+
+        struct PreviousRead
+        {
+            size_t                            node_idx {0};
+            std::shared_ptr<Resource>         resource;
+            std::shared_ptr<ImageRequirement> requirement;
+        };
+
+        // Nodes reading the memory of the resource since its last write, closest first
+        static std::vector<PreviousRead> find_previous_reads(const std::vector<std::shared_ptr<Node>>& nodes, size_t node_idx,
+                                                             const std::shared_ptr<Resource>& resource);
+
+        // Resources are already aliased, different resources may still be bound to the same memory
+        static bool shares_memory(const std::shared_ptr<Resource>& a, const std::shared_ptr<Resource>& b);
+
+        static bool is_in_place_output(const std::shared_ptr<Node>& node, const std::shared_ptr<Resource>& resource);
+
         static std::string fmt_nodes_str(const std::string& prefix, const std::vector<node_ptr>& nodes);
     };
 }
\ No newline at end of file
@@ -1,9 +1,11 @@
 #include "ResourceOptimizer.hpp"
 
+#include <algorithm>
 #include <bitset>
 #include <fmt/format.h>
 #include <fmt/chrono.h>
 #include <fstream>
+#include <iterator>
 #include <queue>
 #include <nlohmann/json.hpp>
 
@@ -31,17 +33,24 @@ namespace Nebula::nrg
                 .usage_points = {},
                 .original_info = r,
                 .type = r.type,
+                .persistent = r.history,
             };
 
             if (resource.type == ResourceType::eImage) {
-                resource.format = r.claim.req->as<ImageRequirement>().format;
-                resource.usage_flags = r.claim.req->as<ImageRequirement>().usage_flags;
+                // Copied, a configured scale replaces the declared one for this node only
+                auto req = r.claim.req->as<ImageRequirement>();
+                if (const auto& configuration = m_nodes[r.origin_node_idx]->node_configuration(); req.configured_scale && configuration) {
+                    req.resolution_scale = req.configured_scale(*configuration);
+                }
+                resource.format = req.format;
+                resource.extent = req.get_extent(m_options.render_resolution, m_options.target_resolution);
+                resource.usage_flags = req.usage_flags;
             }
 
             auto& usage_points = resource.usage_points;
             usage_points = get_usage_points_for_resource_info(r);
 
-            Range incoming_range(usage_points);
+            Range incoming_range = resource.get_usage_range();
 
             // Case: Non-Optimizable Resource Type
             if (!r.optimizable) {
@@ -52,6 +61,20 @@ namespace Nebula::nrg
                 continue;
             }
 
+            // Case: Node can write the output into one of its inputs (read-modify-write)
+            bool was_written_in_place = false;
+            for (auto& timeline: gen_resources) {
+                if (try_insert_in_place(timeline, resource)) {
+                    was_written_in_place = true;
+                    logs.push_back(fmt::format("Resource with id {} of type {} is written in-place by node {} as \"{}\"",
+                                               timeline.id, to_string(timeline.type), r.origin_node_name, r.origin_res_name));
+                    break;
+                }
+            }
+            if (was_written_in_place) {
+                continue;
+            }
+
             // Case: No generated resources yet
             if (gen_resources.empty()) {
                 gen_resources.push_back(resource);
@@ -69,21 +92,19 @@ namespace Nebula::nrg
                     flags[0] = !current_range.overlaps(incoming_range);
                     flags[1] = r.optimizable;
                     flags[2] = r.type == timeline.type;
-                    flags[3] = true; // Image Format compatibility
+                    flags[3] = true; // Image Format & Extent compatibility
                 }
 
                 if (flags[2] && r.type == ResourceType::eImage) {
-                    auto tl_req = timeline.original_info.claim.req->as<ImageRequirement>();
-                    auto in_req = r.claim.req->as<ImageRequirement>();
-                    flags[3] = tl_req.format == in_req.format;
-
-                    // Combine image usage flags
-                    tl_req.usage_flags |= in_req.usage_flags;
+                    flags[3] = timeline.has_layout(resource.format, resource.extent);
                 }
 
                 if (flags.all()) {
                     was_inserted = timeline.insert_usage_points(usage_points);
                     if (was_inserted) {
+                        // Combine image usage flags
+                        timeline.usage_flags |= resource.usage_flags;
+
                         logs.push_back(
                             fmt::format(
                                 "Resource with id {} of type {} was reused in range [{}, {}], {} new usage points were added",
@@ -97,6 +118,18 @@ namespace Nebula::nrg
                 }
             }
 
+            // Case: Differently sized or formatted image, alias the memory of a timeline by byte footprint
+            if (!was_inserted && r.type == ResourceType::eImage) {
+                if (auto* timeline = find_memory_alias_target(gen_resources, resource); timeline != nullptr) {
+                    was_inserted = timeline->insert_memory_alias(r, resource.format, resource.extent, resource.usage_flags, usage_points);
+                    if (was_inserted) {
+                        logs.push_back(fmt::format("Resource with id {} of type {} aliases the memory of resource {} ({}x{}, {} bytes)",
+                                                   resource.id, to_string(resource.type), timeline->id,
+                                                   resource.extent.width, resource.extent.height, resource.footprint()));
+                    }
+                }
+            }
+
             // Case: Failed to Insert
             if (!was_inserted) {
                 gen_resources.push_back(resource);
@@ -185,6 +218,7 @@ namespace Nebula::nrg
             auto& claims = node->resource_claims();
             for (const auto& resource: claims) {
                 if (resource.usage() == ResourceUsage::eInput) continue;
+                if (m_options.external_resources.contains(resource.id)) continue;
                 result.push_back(resource_info::create_from(*node, resource, i));
             }
         }
@@ -220,6 +254,16 @@ namespace Nebula::nrg
 
                 res_info.consumers.push_back(consumer);
             }
+
+            // History resources: requested by the producer or by a consumer reading the previous frame
+            if (res_info.type == ResourceType::eImage) {
+                res_info.history = res_info.claim.req->as<ImageRequirement>().history
+                    || std::ranges::any_of(res_info.consumers, [](const consumer_info& c){
+                        const auto& req = c.node->get_resource(c.resource_id).req;
+                        return req->type == ResourceType::eImage && req->as<ImageRequirement>().previous_frame;
+                    });
+                res_info.optimizable = res_info.optimizable && !res_info.history;
+            }
         }
 
         return result;
@@ -240,6 +284,72 @@ namespace Nebula::nrg
         return usage_points;
     }
 
+    bool ResourceOptimizer::try_insert_in_place(OptimizerResource& timeline, const OptimizerResource& resource)
+    {
+        const auto& resource_info = resource.original_info;
+        const auto& usage_points = resource.usage_points;
+        if (resource_info.type != ResourceType::eImage || timeline.type != ResourceType::eImage) return false;
+
+        const auto& out_req = resource_info.claim.req->as<ImageRequirement>();
+        if (out_req.in_place_of.empty()) return false;
+
+        // The input has to be last used by the producer of the output
+        const int32_t point = resource_info.origin_node_idx;
+        if (timeline.get_usage_range().end != point) return false;
+
+        const auto input_point = timeline.get_usage_point(point);
+        if (!input_point.has_value()
+            || !timeline.usage_points.contains(*input_point)
+            || input_point->user_node_id != resource_info.origin_node_id
+            || input_point->used_as != out_req.in_place_of
+            || input_point->usage != ResourceUsage::eInput)
+        {
+            return false;
+        }
+
+        if (!timeline.has_layout(resource.format, resource.extent)) return false;
+
+        // Producer point is shared with the input, only the consumers extend the timeline
+        std::set<usage_point> consumer_points;
+        std::ranges::copy_if(usage_points, std::inserter(consumer_points, std::end(consumer_points)),
+                             [&](const usage_point& up){ return up.point != point; });
+
+        if (!timeline.insert_usage_points(consumer_points)) return false;
+
+        timeline.in_place_points.emplace_back(resource_info);
+        timeline.usage_flags |= out_req.usage_flags;
+
+        return true;
+    }
+
+    OptimizerResource* ResourceOptimizer::find_memory_alias_target(std::vector<OptimizerResource>& timelines,
+                                                                  const OptimizerResource& resource)
+    {
+        if (is_depth_format(resource.format)) return nullptr;
+
+        const Range incoming_range = resource.get_usage_range();
+        const vk::DeviceSize incoming_footprint = resource.footprint();
+
+        // Prefer the smallest timeline the image fits into, otherwise grow the largest one
+        OptimizerResource* best_fit = nullptr;
+        OptimizerResource* largest = nullptr;
+        for (auto& timeline: timelines) {
+            if (timeline.type != ResourceType::eImage || timeline.persistent || !timeline.original_info.optimizable) continue;
+            if (is_depth_format(timeline.format)) continue;
+            if (timeline.get_usage_range().overlaps(incoming_range)) continue;
+
+            const vk::DeviceSize footprint = timeline.footprint();
+            if (footprint >= incoming_footprint && (!best_fit || footprint < best_fit->footprint())) {
+                best_fit = &timeline;
+            }
+            if (!largest || footprint > largest->footprint()) {
+                largest = &timeline;
+            }
+        }
+
+        return best_fit ? best_fit : largest;
+    }
+
     void ResourceOptimizer::export_json_result(const ResourceOptimizerResult& result)
     {
         using json = nlohmann::json;
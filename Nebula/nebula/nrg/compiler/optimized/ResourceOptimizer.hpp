@@ -1,5 +1,6 @@
 #pragma once
 
+#include <limits>
 #include <memory>
 #include <set>
 #include <string>
@@ -16,6 +17,34 @@ namespace Nebula::nrg
         return resource_type == ResourceType::eImage;
     }
 
+    // Bytes per texel of the formats used by graph resources
+    static constexpr vk::DeviceSize get_format_size(const vk::Format format)
+    {
+        using enum vk::Format;
+        switch (format)
+        {
+            case eR8Unorm:              return 1;
+            case eR16Sfloat:            return 2;
+            case eR8G8B8A8Unorm:
+            case eB8G8R8A8Unorm:
+            case eR16G16Sfloat:
+            case eR32Sfloat:
+            case eR32Uint:
+            case eB10G11R11UfloatPack32:
+            case eD32Sfloat:            return 4;
+            case eR16G16B16A16Sfloat:
+            case eR32G32Sfloat:
+            case eR32G32Uint:           return 8;
+            case eR32G32B32A32Sfloat:
+            default:                    return 16;
+        }
+    }
+
+    static constexpr bool is_depth_format(const vk::Format format)
+    {
+        return format == vk::Format::eD32Sfloat;
+    }
+
     struct consumer_info
     {
         int32_t         node_id {};     // ID of the Consumer Node
@@ -37,6 +66,7 @@ namespace Nebula::nrg
         ResourceType  type {ResourceType::eUnknown};
         ResourceUsage usage {ResourceUsage::eUnknown};
         bool          optimizable {false};
+        bool          history {false};  // Double-buffered across frames, lives for the whole timeline
         ResourceClaim claim;
         std::vector<consumer_info> consumers;
 
@@ -51,6 +81,7 @@ namespace Nebula::nrg
                 .type = claim.type(),
                 .usage = claim.usage(),
                 .optimizable = is_optimizable_type(claim.type()),
+                .history = false,
                 .claim = claim,
                 .consumers = {},
             };
@@ -135,6 +166,21 @@ namespace Nebula::nrg
         }
     };
 
+    // Image of a different size or format placed into the memory of a timeline
+    struct memory_alias
+    {
+        resource_info         original_info;
+        vk::Format            format;
+        vk::Extent2D          extent;
+        vk::ImageUsageFlags   usage_flags;
+        std::set<usage_point> usage_points;
+
+        vk::DeviceSize footprint() const
+        {
+            return static_cast<vk::DeviceSize>(extent.width) * extent.height * get_format_size(format);
+        }
+    };
+
     struct OptimizerResource
     {
         int32_t               id;
@@ -144,25 +190,61 @@ namespace Nebula::nrg
 
         // Ensure image format compatibility
         vk::Format            format;
+        vk::Extent2D          extent;
         vk::ImageUsageFlags   usage_flags;
 
-        Range get_usage_range() const { return Range(usage_points); }
+        // Differently sized images sharing the memory of this resource
+        std::vector<memory_alias> memory_aliases;
+
+        // Outputs written in-place, their usage point coincides with an input usage point
+        std::vector<usage_point> in_place_points;
+
+        // History resources are read in the next frame, nothing can be aliased into them
+        bool                  persistent {false};
+
+        std::set<usage_point> all_usage_points() const
+        {
+            std::set<usage_point> result = usage_points;
+            for (const auto& alias : memory_aliases)
+            {
+                result.insert(std::begin(alias.usage_points), std::end(alias.usage_points));
+            }
+            return result;
+        }
+
+        Range get_usage_range() const
+        {
+            return persistent ? Range(0, std::numeric_limits<int32_t>::max()) : Range(all_usage_points());
+        }
 
         std::optional<usage_point> get_usage_point(const int32_t value) const
         {
-            auto find = std::ranges::find_if(usage_points, [&](const usage_point& up){ return up.point == value; });
-            return (find == std::end(usage_points))
+            const auto points = all_usage_points();
+            auto find = std::ranges::find_if(points, [&](const usage_point& up){ return up.point == value; });
+            return (find == std::end(points))
                 ? std::nullopt
                 : std::make_optional(*find);
         }
 
-        bool insert_usage_points(const std::set<usage_point>& points)
+        bool has_layout(const vk::Format other_format, const vk::Extent2D& other_extent) const
         {
-            // Validation for occupied usage points
-            std::vector<usage_point> intersection;
-            std::set_intersection(std::begin(usage_points), std::end(usage_points), std::begin(points), std::end(points), std::back_inserter(intersection));
+            return format == other_format && extent == other_extent;
+        }
 
-            if (!intersection.empty())
+        // Largest image placed into the memory of this resource
+        vk::DeviceSize footprint() const
+        {
+            vk::DeviceSize result = static_cast<vk::DeviceSize>(extent.width) * extent.height * get_format_size(format);
+            for (const auto& alias : memory_aliases)
+            {
+                result = std::max(result, alias.footprint());
+            }
+            return result;
+        }
+
+        bool insert_usage_points(const std::set<usage_point>& points)
+        {
+            if (!is_free(points))
             {
                 return false;
             }
@@ -174,6 +256,39 @@ namespace Nebula::nrg
 
             return true;
         }
+
+        bool insert_memory_alias(const resource_info& info, const vk::Format alias_format, const vk::Extent2D& alias_extent,
+                                 const vk::ImageUsageFlags alias_usage_flags, const std::set<usage_point>& points)
+        {
+            if (!is_free(points))
+            {
+                return false;
+            }
+
+            auto alias = std::ranges::find_if(memory_aliases, [&](const memory_alias& a){
+                return a.format == alias_format && a.extent == alias_extent;
+            });
+
+            if (alias == std::end(memory_aliases))
+            {
+                memory_aliases.push_back({ info, alias_format, alias_extent, alias_usage_flags, points });
+                return true;
+            }
+
+            alias->usage_flags |= alias_usage_flags;
+            alias->usage_points.insert(std::begin(points), std::end(points));
+            return true;
+        }
+
+    private:
+        // Validation for occupied usage points
+        bool is_free(const std::set<usage_point>& points) const
+        {
+            const auto occupied = all_usage_points();
+            std::vector<usage_point> intersection;
+            std::set_intersection(std::begin(occupied), std::end(occupied), std::begin(points), std::end(points), std::back_inserter(intersection));
+            return intersection.empty();
+        }
     };
 
     struct ResourceOptimizerResult
@@ -193,7 +308,12 @@ namespace Nebula::nrg
 
     struct ResourceOptimizerOptions
     {
-        bool export_result {false};
+        bool              export_result {false};
+        std::set<int32_t> external_resources {};  // Output claims not backed by a graph resource (e.g. swapchain)
+
+        // Resolutions relative image extents are resolved against
+        vk::Extent2D      render_resolution {0, 0};
+        vk::Extent2D      target_resolution {0, 0};
     };
 
     class ResourceOptimizer
@@ -214,6 +334,10 @@ namespace Nebula::nrg
 
         static std::set<usage_point> get_usage_points_for_resource_info(const resource_info& resource_info);
 
+        static bool try_insert_in_place(OptimizerResource& timeline, const OptimizerResource& resource);
+
+        static OptimizerResource* find_memory_alias_target(std::vector<OptimizerResource>& timelines, const OptimizerResource& resource);
+
         int32_t                         m_id_sequence {0};
         const ResourceOptimizerOptions& m_options;
         const std::vector<node_ptr>     m_nodes;
@@ -29,6 +29,7 @@ namespace Nebula::nrg
                 for (const auto& resource : m_resource_claims)
                 {
                     if (resource.usage() == ResourceUsage::eUnknown) continue;
+                    if (resource.type() == ResourceType::eImage && resource.req->as<ImageRequirement>().scratch) continue;
 
                     const int32_t attribute_id = resource.id;
                     ImNodes::PushColorStyle(ImNodesCol_Pin, TO_IM_COL32(get_resource_color(resource.type())));
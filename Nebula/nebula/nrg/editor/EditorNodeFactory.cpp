@@ -35,10 +35,15 @@ namespace Nebula::nrg
         {
             nrg_case_RC_NC(eAmbientOcclusion, AmbientOcclusion);
             nrg_case_RC_NC(eAntiAliasing, AntiAliasing);
+            nrg_case_RC_NC(eBloom, Bloom);
             nrg_case_RC_NC(eDeferredLighting, DeferredLighting);
             nrg_case_RC(eGBuffer, GBuffer);
+            nrg_case_RC(eHiZCulling, HiZCulling);
             nrg_case_RC(ePresent, Present);
             nrg_case_RC(eSceneDataProvider, SceneDataProvider);
+            nrg_case_RC_NC(eShadowMapGeneration, ShadowMapGeneration);
+            nrg_case_RC_NC(eToneMapping, ToneMapping);
+            nrg_case_RC(eVisibilityBuffer, VisibilityBuffer);
             default:
                 throw std::runtime_error(fmt::format("EditorNode creation for {} node type not supported", to_string(node_type)));
         }
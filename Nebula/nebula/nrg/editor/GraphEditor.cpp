@@ -186,7 +186,10 @@ namespace Nebula::nrg
             auto& e_attr = e_node->get_resource(edge->end.resource_id);
             e_attr.input_connected = false;
 
-            EditorNode::delete_directed_edge(s_node, e_node);
+            if (!e_attr.reads_previous_frame())
+            {
+                EditorNode::delete_directed_edge(s_node, e_node);
+            }
 
             edges.erase(edge);
 
@@ -269,7 +272,11 @@ namespace Nebula::nrg
                 return false;
             }
 
-            EditorNode::make_directed_edge(s_node, e_node);
+            // Previous frame reads close a loop over frames, they don't order the nodes within one
+            if (!e_attr.reads_previous_frame())
+            {
+                EditorNode::make_directed_edge(s_node, e_node);
+            }
             edges.emplace_back(*s_node, s_attr, *e_node, e_attr, s_attr.type());
             e_attr.input_connected = true;
 
@@ -339,6 +346,69 @@ namespace Nebula::nrg
                 ImGui::EndMenu();
             }
 
+            const auto& render_resolution = m_context->m_max_render_resolution;
+            const auto& target_resolution = m_context->m_target_resolution;
+            std::string render_scale_text = fmt::format(
+                "Render Resolution ({}x{})",
+                m_context->m_render_resolution.width, m_context->m_render_resolution.height);
+
+            // Lower render scales are only upscaled back to the target resolution by the temporal anti-aliasing node
+            if (ImGui::BeginMenu(render_scale_text.c_str()))
+            {
+                for (const float scale : { 1.0f, 0.77f, 0.67f, 0.59f, 0.5f })
+                {
+                    const Size2D resolution = {
+                        std::max(1u, static_cast<uint32_t>(static_cast<float>(target_resolution.width) * scale)),
+                        std::max(1u, static_cast<uint32_t>(static_cast<float>(target_resolution.height) * scale)),
+                    };
+                    const bool selected = (resolution.width == render_resolution.width);
+                    const auto label = fmt::format("{:.0f}% ({}x{})", scale * 100.0f, resolution.width, resolution.height);
+                    if (ImGui::MenuItem(label.c_str(), nullptr, selected) && !selected)
+                    {
+                        m_context->set_max_render_resolution(resolution);
+                        m_logger->info("Render resolution set to {}x{}, recompile the graph to apply", resolution.width, resolution.height);
+                    }
+                }
+
+                // Scales within the resolution above without recompiling, only with an anti-aliasing node
+                auto& dynamic_resolution = m_context->m_dynamic_resolution;
+                ImGui::Separator();
+                ImGui::Checkbox("Dynamic Resolution", &dynamic_resolution.enabled);
+                ImGui::PushItemWidth(128);
+                ImGui::SliderFloat("Frame Budget (ms)", &dynamic_resolution.target_frame_time_ms, 4.0f, 33.3f);
+                ImGui::SliderFloat("Minimum Scale", &dynamic_resolution.min_scale, 0.25f, 1.0f);
+                ImGui::PopItemWidth();
+                if (dynamic_resolution.enabled && !m_context->m_upscaling_enabled)
+                {
+                    ImGui::TextDisabled("Inactive, the graph has no Anti-Aliasing node");
+                }
+                else if (dynamic_resolution.enabled)
+                {
+                    ImGui::TextDisabled("%.0f%% at %.2f ms", dynamic_resolution.scale() * 100.0f, dynamic_resolution.filtered_frame_time_ms());
+                }
+
+                ImGui::EndMenu();
+            }
+
+            if (m_context->m_render_path && ImGui::BeginMenu("Toggle Nodes"))
+            {
+                const auto& render_path = m_context->m_render_path;
+                for (size_t i = 0; i < render_path->m_nodes.size(); i++)
+                {
+                    const auto& node = render_path->m_nodes[i];
+                    if (node->type() == NodeType::eSceneDataProvider || node->type() == NodeType::ePresent) continue;
+
+                    const bool enabled = render_path->is_node_enabled(i);
+                    if (ImGui::MenuItem(node->name().c_str(), nullptr, enabled)
+                        && !render_path->set_node_enabled(i, !enabled))
+                    {
+                        m_logger->warning(R"(Node "{}" can't be disabled, a consumer has no fallback for its outputs)", node->name());
+                    }
+                }
+
+                ImGui::EndMenu();
+            }
+
             if (ImGui::Button("Compile"))
             {
                 _handle_compile();
@@ -1,16 +1,188 @@
 #include "AmbientOcclusion.hpp"
+#include <cmath>
+#include <iostream>
+#include <nlog/nlog.hpp>
 #include <nrg/common/ResourceTraits.hpp>
+#include <nrg/resource/Resources.hpp>
+#include <nvk/Barrier.hpp>
+
+#ifdef NBL_DEBUG
+#include <fmt/printf.h>
+#endif
 
 namespace Nebula::nrg
 {
     nrg_def_resource_requirements(AmbientOcclusion, ({
-        std::make_shared<ImageRequirement>(s_position, ResourceUsage::eInput, ResourceType::eImage, vk::Format::eR32G32B32A32Sfloat),
-        std::make_shared<ImageRequirement>(s_normal, ResourceUsage::eInput, ResourceType::eImage, vk::Format::eR32G32B32A32Sfloat),
-        std::make_shared<ImageRequirement>(s_depth, ResourceUsage::eInput, ResourceType::eImage, vk::Format::eD32Sfloat),
+        std::make_shared<ImageRequirement>(s_position, ResourceUsage::eInput, ResourceType::eImage, vk::ImageLayout::eShaderReadOnlyOptimal, vk::Format::eR32G32B32A32Sfloat),
+        std::make_shared<ImageRequirement>(s_normal, ResourceUsage::eInput, ResourceType::eImage, vk::ImageLayout::eShaderReadOnlyOptimal, vk::Format::eR32G32B32A32Sfloat),
         std::make_shared<Requirement>(s_scene_data, ResourceUsage::eInput, ResourceType::eSceneData),
-        std::make_shared<ImageRequirement>(s_output, ResourceUsage::eOutput, ResourceType::eImage, vk::Format::eR32Sfloat)
+        std::make_shared<ImageRequirement>(s_output, ResourceUsage::eOutput, ResourceType::eImage, vk::ImageLayout::eGeneral, vk::Format::eR32Sfloat),
+        history(scratch(configured_extent(std::make_shared<ImageRequirement>(s_ao_target, ResourceUsage::eOutput, ResourceType::eImage, vk::ImageLayout::eGeneral, vk::Format::eR32G32Sfloat,
+                                                                             vk::Extent2D {0, 0}, vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eTransferDst),
+                                          [](const NodeConfiguration& configuration){
+                                              return dynamic_cast<const Configuration&>(configuration).half_resolution ? 0.5f : 1.0f;
+                                          }))),
     }));
 
+    AmbientOcclusion::AmbientOcclusion(const std::shared_ptr<Configuration>& configuration, const std::shared_ptr<Context>& context)
+    : ComputeNode("AmbientOcclusion", NodeType::eAmbientOcclusion, context)
+    , m_configuration(*configuration)
+    {
+    }
+
+    void AmbientOcclusion::initialize()
+    {
+        if (m_configuration.selected_mode_idx != static_cast<int>(AmbientOcclusionMode::eSSAO))
+        {
+            std::cout << nlog::fmt_warning("{} is not implemented yet, falling back to SSAO",
+                                           to_string(static_cast<AmbientOcclusionMode>(m_configuration.selected_mode_idx))) << std::endl;
+        }
+
+        m_output_extent = get_image_extent(s_output);
+        m_ao_extent = get_image_extent(s_ao_target);
+        clear_ao_targets();
+        m_gpu_timer = std::make_shared<GpuTimer>(m_device, m_context->m_frames, "AmbientOcclusion");
+
+        m_uniform_buffer.resize(m_context->m_frames);
+        for (uint32_t i = 0; i < m_context->m_frames; i++)
+        {
+            nvk::BufferCreateInfo buf_create_info{};
+            buf_create_info
+                .set_buffer_type(nvk::BufferType::eUniform)
+                .set_name(fmt::format("AmbientOcclusion Uniform #{}", i))
+                .set_size(sizeof(Uniform));
+            m_uniform_buffer[i] = std::make_shared<nvk::Buffer>(buf_create_info, m_device);
+        }
+
+        // 1. AO at reduced resolution, accumulated with the reprojected result of the previous frame
+        auto ao_info = ComputePipelineInfo()
+            .set_shader("nrg_ambient_occlusion.comp.spv")
+            .add_uniform_buffer(0, m_uniform_buffer)
+            .add_sampled_image(1, s_position)
+            .add_sampled_image(2, s_normal)
+            .add_history_image(3, s_ao_target)
+            .add_storage_image(4, s_ao_target)
+            .set_push_constant_size(sizeof(PushConstant))
+            .set_group_size(s_group_size, s_group_size);
+        m_ao_pipeline = create_compute_pipeline(ao_info);
+
+        // 2. Depth-aware bilateral upsample to the output resolution
+        auto upsample_info = ComputePipelineInfo()
+            .set_shader("nrg_ambient_occlusion_upsample.comp.spv")
+            .add_uniform_buffer(0, m_uniform_buffer)
+            .add_sampled_image(1, s_position)
+            .add_storage_image(2, s_ao_target)
+            .add_storage_image(3, s_output)
+            .set_push_constant_size(sizeof(PushConstant))
+            .set_group_size(s_group_size, s_group_size);
+        m_upsample_pipeline = create_compute_pipeline(upsample_info);
+
+        const auto& camera = get_resource<SceneResource>(s_scene_data).ref_scene().active_camera()->uniform_data();
+        m_prev_view = camera.view;
+        m_prev_proj = camera.proj;
+    }
+
+    void AmbientOcclusion::clear_ao_targets()
+    {
+        // Targets stay in eGeneral, cleared to unoccluded with an invalid depth so the first frame rejects its history
+        const auto& ao_target = get_resource<ImageResource>(s_ao_target);
+        m_context->m_command_pool->exec_single_time_command([&](const vk::CommandBuffer& cmd) {
+            for (const auto& target : ao_target.images())
+            {
+                const auto& range = target->properties().subresource_range;
+                nvk::ImageBarrier(target, vk::ImageLayout::eUndefined, vk::ImageLayout::eGeneral).apply(cmd);
+                cmd.clearColorImage(target->image(), vk::ImageLayout::eGeneral, vk::ClearColorValue(std::array<float, 4>{1.0f, 0.0f, 0.0f, 0.0f}), range);
+            }
+        });
+    }
+
+    void AmbientOcclusion::read_timestamps(uint32_t slot)
+    {
+        // The slot was last used frames_in_flight frames ago, its results are available
+        const auto gpu_time_ms = m_gpu_timer->read(slot);
+        if (!gpu_time_ms.has_value()) return;
+
+        m_gpu_time_ms += gpu_time_ms.value();
+        m_gpu_time_samples++;
+
+        if (m_gpu_time_samples == s_report_every)
+        {
+            auto& reported = m_configuration.half_resolution ? s_half_resolution_ms : s_full_resolution_ms;
+            reported = m_gpu_time_ms / m_gpu_time_samples;
+            m_gpu_time_ms = 0.0;
+            m_gpu_time_samples = 0;
+
+            #ifdef NBL_DEBUG
+            fmt::println("AmbientOcclusion ({}x{}): {}", m_ao_extent.width, m_ao_extent.height, fmt_gpu_times());
+            #endif
+        }
+    }
+
+    std::string AmbientOcclusion::fmt_gpu_times()
+    {
+        const auto fmt_ms = [](const std::optional<double>& ms) {
+            return ms.has_value() ? fmt::format("{:.3f} ms", ms.value()) : std::string("not measured");
+        };
+        return fmt::format("half resolution + upsample {} | full resolution + upsample {}",
+                           fmt_ms(s_half_resolution_ms), fmt_ms(s_full_resolution_ms));
+    }
+
+    void AmbientOcclusion::execute(const vk::CommandBuffer& command_buffer)
+    {
+        const uint32_t slot = m_current_frame % m_context->m_frames;
+        read_timestamps(slot);
+
+        m_gpu_timer->begin(command_buffer, slot, vk::PipelineStageFlagBits2::eComputeShader);
+
+        // The history image written in the previous frame is not bound to a requirement, the render path leaves it alone
+        const auto& ao_target = get_resource<ImageResource>(s_ao_target);
+        {
+            auto history_barrier = nvk::ImageBarrier(ao_target.get_previous_image(), vk::ImageLayout::eGeneral, vk::ImageLayout::eGeneral).barrier();
+            history_barrier
+                .setSrcStageMask(vk::PipelineStageFlagBits2::eAllCommands)
+                .setSrcAccessMask(vk::AccessFlagBits2::eMemoryWrite)
+                .setDstStageMask(vk::PipelineStageFlagBits2::eComputeShader)
+                .setDstAccessMask(vk::AccessFlagBits2::eShaderStorageRead);
+            command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(history_barrier));
+        }
+
+        // Only the active part of the targets is computed under dynamic resolution
+        const auto output_extent = m_context->get_active_extent(m_output_extent);
+        const vk::Extent2D ao_extent = {
+            std::min(m_ao_extent.width, (output_extent.width * m_ao_extent.width + m_output_extent.width - 1) / m_output_extent.width),
+            std::min(m_ao_extent.height, (output_extent.height * m_ao_extent.height + m_output_extent.height - 1) / m_output_extent.height),
+        };
+        const auto push_constant = PushConstant(ao_extent, output_extent);
+
+        dispatch(command_buffer, ao_extent, push_constant, m_ao_pipeline);
+        compute_barrier(command_buffer);
+        dispatch(command_buffer, output_extent, push_constant, m_upsample_pipeline);
+
+        m_gpu_timer->end(command_buffer, slot, vk::PipelineStageFlagBits2::eComputeShader);
+
+        m_frame_index++;
+    }
+
+    void AmbientOcclusion::update()
+    {
+        const auto& camera = get_resource<SceneResource>(s_scene_data).ref_scene().active_camera()->uniform_data();
+
+        // Without accumulation every frame stands on its own
+        const float history_weight = m_configuration.temporal_accumulation ? 0.1f : 1.0f;
+
+        Uniform uniform_data {
+            .view      = camera.view,
+            .proj      = camera.proj,
+            .prev_view = m_prev_view,
+            .prev_proj = m_prev_proj,
+            .params    = { m_configuration.radius, 0.025f, static_cast<float>(m_frame_index), history_weight },
+        };
+        m_uniform_buffer[m_current_frame]->set_data(&uniform_data);
+
+        m_prev_view = camera.view;
+        m_prev_proj = camera.proj;
+    }
+
     void AmbientOcclusion::Configuration::render()
     {
         ImGui::PushItemWidth(128);
@@ -29,7 +201,13 @@ namespace Nebula::nrg
                 ImGui::EndCombo();
             }
 
+            ImGui::Checkbox("Half Resolution", &half_resolution);
+            ImGui::Checkbox("Temporal Accumulation", &temporal_accumulation);
+            ImGui::SliderFloat("Radius", &radius, 0.05f, 2.0f);
+
+            // Averages of the last report in each mode, toggle Half Resolution & recompile to fill in the other one
+            ImGui::TextUnformatted(fmt_gpu_times().c_str());
         }
         ImGui::PopItemWidth();
     }
-}
\ No newline at end of file
+}
@@ -1,15 +1,20 @@
 #pragma once
 
+#include <array>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
+#include <glm/glm.hpp>
 #include <vulkan/vulkan.hpp>
-#include <nrg/common/Node.hpp>
+#include <nrg/common/ComputeNode.hpp>
+#include <nrg/common/Context.hpp>
+#include <nrg/common/GpuTimer.hpp>
 #include <nrg/common/NodeConfiguration.hpp>
 #include <nrg/common/NodeTraits.hpp>
 #include <nrg/common/ResourceClaim.hpp>
 #include <nrg/resource/Requirement.hpp>
-#include <nvk/Device.hpp>
+#include <nvk/Buffer.hpp>
 
 namespace Nebula::nrg
 {
@@ -32,12 +37,36 @@ namespace Nebula::nrg
         }
     }
 
-    class AmbientOcclusion : public Node
+    class AmbientOcclusion : public ComputeNode
     {
+        struct alignas(glm::vec4) Uniform
+        {
+            glm::mat4 view;
+            glm::mat4 proj;
+            glm::mat4 prev_view;
+            glm::mat4 prev_proj;
+            glm::vec4 params;  // [ Radius, Bias, Frame Index, History Weight ]
+        };
+
+        struct PushConstant
+        {
+            glm::ivec4 extent;  // [ AO Width, AO Height, Output Width, Output Height ]
+
+            PushConstant() = default;
+
+            PushConstant(const vk::Extent2D& ao_extent, const vk::Extent2D& output_extent)
+            : extent(ao_extent.width, ao_extent.height, output_extent.width, output_extent.height)
+            {
+            }
+        };
+
     public:
         struct Configuration : public NodeConfiguration
         {
-            int selected_mode_idx {0};
+            int   selected_mode_idx     {0};
+            bool  half_resolution       {true};
+            bool  temporal_accumulation {true};
+            float radius                {0.5f};
 
             void render() override;
             bool validate() override { return true; }
@@ -50,29 +79,58 @@ namespace Nebula::nrg
             };
         };
 
-        explicit AmbientOcclusion(const std::shared_ptr<Configuration>& configuration,const std::shared_ptr<nvk::Device>& device)
-        : Node("AmbientOcclusion", NodeType::eAmbientOcclusion)
-        , m_configuration(*configuration), m_device(device) {}
+        AmbientOcclusion(const std::shared_ptr<Configuration>& configuration, const std::shared_ptr<Context>& context);
 
         ~AmbientOcclusion() override = default;
 
-        void initialize() override {}
+        void initialize() override;
 
-        void execute(const vk::CommandBuffer& command_buffer) override {}
+        void execute(const vk::CommandBuffer& command_buffer) override;
 
-        void update() override {}
+        void update() override;
 
     private:
-        const Configuration          m_configuration;
-        std::shared_ptr<nvk::Device> m_device;
+        // Clears both history images of the AO target, invalid depth makes the first frame reject its history
+        void clear_ao_targets();
+
+        // GPU time reported for half & full resolution AO, side by side
+        static std::string fmt_gpu_times();
+
+        void read_timestamps(uint32_t slot);
+
+        const Configuration                         m_configuration;
+
+        uint32_t                                    m_ao_pipeline {0};
+        uint32_t                                    m_upsample_pipeline {0};
+        std::vector<std::shared_ptr<nvk::Buffer>>   m_uniform_buffer;
+
+        // Extent of the AO target, half of the output if configured so
+        vk::Extent2D                                m_ao_extent {};
+        vk::Extent2D                                m_output_extent {};
+
+        glm::mat4                                   m_prev_view {1.0f};
+        glm::mat4                                   m_prev_proj {1.0f};
+        uint32_t                                    m_frame_index {0};
+
+        // GPU time of the AO & upsample dispatches
+        std::shared_ptr<GpuTimer>                   m_gpu_timer;
+        double                                      m_gpu_time_ms {0.0};
+        uint32_t                                    m_gpu_time_samples {0};
+
+        // Last average per resolution, kept across graph recompilations to compare the two modes
+        inline static std::optional<double>         s_half_resolution_ms;
+        inline static std::optional<double>         s_full_resolution_ms;
+
+        static constexpr uint32_t    s_group_size   = 8;
+        static constexpr uint32_t    s_report_every = 256;
 
         static constexpr const char* s_output       = "AO Buffer";
         static constexpr const char* s_position     = "Position Buffer";
         static constexpr const char* s_normal       = "Normal Buffer";
-        static constexpr const char* s_depth        = "Depth Buffer";
         static constexpr const char* s_scene_data   = "Scene Data";
+        static constexpr const char* s_ao_target    = "AO Target";  // AO & view depth, history for temporal accumulation
 
         nrg_decl_resource_requirements();
         nrg_def_get_resource_claims();
     };
-}
\ No newline at end of file
+}
@@ -1,40 +1,171 @@
 #include "AntiAliasing.hpp"
+#include <iostream>
+#include <nlog/nlog.hpp>
 #include <nrg/common/ResourceTraits.hpp>
+#include <nrg/resource/Resources.hpp>
+#include <nvk/Barrier.hpp>
 
 namespace Nebula::nrg
 {
     nrg_def_resource_requirements(AntiAliasing, ({
-        std::make_shared<ImageRequirement>(s_input_name, ResourceUsage::eInput, ResourceType::eImage, vk::Format::eR32G32B32A32Sfloat),
-        std::make_shared<ImageRequirement>(s_output_name, ResourceUsage::eOutput, ResourceType::eImage, vk::Format::eR32G32B32A32Sfloat)
+        std::make_shared<ImageRequirement>(s_input_name, ResourceUsage::eInput, ResourceType::eImage, vk::ImageLayout::eShaderReadOnlyOptimal, vk::Format::eR32G32B32A32Sfloat),
+        std::make_shared<ImageRequirement>(s_motion_vec, ResourceUsage::eInput, ResourceType::eImage, vk::ImageLayout::eShaderReadOnlyOptimal, vk::Format::eR32G32B32A32Sfloat),
+        history(relative_extent(std::make_shared<ImageRequirement>(s_output_name, ResourceUsage::eOutput, ResourceType::eImage, vk::ImageLayout::eGeneral, vk::Format::eR32G32B32A32Sfloat),
+                                1.0f, ResolutionReference::eTargetResolution)),
     }));
 
     AntiAliasing::AntiAliasing(const std::shared_ptr<Configuration>& configuration,
-                               const std::shared_ptr<nvk::Device>& device)
-    : Node("Anti-Aliasing", NodeType::eAntiAliasing), m_configuration(*configuration)
+                               const std::shared_ptr<Context>& context)
+    : Node("Anti-Aliasing", NodeType::eAntiAliasing)
+    , m_configuration(*configuration)
+    , m_context(context)
+    , m_device(context->m_device)
+    , m_current_frame(context->m_current_frame)
     {
     }
 
     void AntiAliasing::initialize()
     {
+        using enum AntiAliasingMode;
+        const auto mode = m_configuration.m_mode;
+        if (mode == eFXAA || mode == eFSR2)
+        {
+            std::cout << nlog::fmt_warning("{} is not implemented yet, falling back to {}",
+                                           to_string(mode), to_string(eTemporalUpscaling)) << std::endl;
+        }
+
+        // Disabled only resamples the input to the target resolution, without jitter or history
+        m_context->m_jitter_enabled = (mode != eDisabled);
+        m_context->m_upscaling_enabled = true;
+
+        const auto& input = get_resource<ImageResource>(s_input_name);
+        const auto& motion_vec = get_resource<ImageResource>(s_motion_vec);
+        const auto& output = get_resource<ImageResource>(s_output_name);
+
+        m_render_extent = input.get_image()->properties().extent;
+        m_target_extent = output.get_image()->properties().extent;
+
+        using SSFB = vk::ShaderStageFlagBits;
+        using enum nvk::DescriptorType;
+
+        const auto set_count = static_cast<uint32_t>(output.images().size());
+        auto descriptor_create_info = nvk::DescriptorCreateInfo()
+            .add(eCombinedImageSampler, 0, SSFB::eCompute)
+            .add(eCombinedImageSampler, 1, SSFB::eCompute)
+            .add(eCombinedImageSampler, 2, SSFB::eCompute)
+            .add(eStorageImage, 3, SSFB::eCompute)
+            .set_count(set_count)
+            .set_name("Temporal Upscaling");
+        m_descriptor = std::make_shared<nvk::Descriptor>(descriptor_create_info, m_device);
+
+        auto pipeline_create_info = nvk::PipelineCreateInfo()
+            .set_pipeline_type(nvk::PipelineType::eCompute)
+            .add_push_constant({ SSFB::eCompute, 0, sizeof(TemporalPushConstant) })
+            .add_descriptor_set_layout(m_descriptor->layout())
+            .add_shader("nrg_temporal_upscaling.comp.spv", SSFB::eCompute)
+            .set_name("Temporal Upscaling");
+        m_pipeline = std::make_shared<nvk::Pipeline>(pipeline_create_info, m_device);
+
+        for (uint32_t i = 0; i < set_count; i++)
+        {
+            // Set i writes history image i and reads the one written in the previous frame
+            const auto& color    = input.get_image(i);
+            const auto& motion   = motion_vec.get_image(i);
+            const auto& current  = output.get_image(i);
+            const auto& previous = output.get_image(i + set_count - 1);
+
+            vk::DescriptorImageInfo color_info   = { color->default_sampler(), color->image_view(), vk::ImageLayout::eShaderReadOnlyOptimal };
+            vk::DescriptorImageInfo motion_info  = { motion->default_sampler(), motion->image_view(), vk::ImageLayout::eShaderReadOnlyOptimal };
+            vk::DescriptorImageInfo history_info = { previous->default_sampler(), previous->image_view(), vk::ImageLayout::eShaderReadOnlyOptimal };
+            vk::DescriptorImageInfo output_info  = { nullptr, current->image_view(), vk::ImageLayout::eGeneral };
+
+            auto write_info = nvk::DescriptorWriteInfo()
+                .add_combined_image_sampler(0, color_info)
+                .add_combined_image_sampler(1, motion_info)
+                .add_combined_image_sampler(2, history_info)
+                .add_storage_image(3, output_info)
+                .set_set_index(i);
+            m_descriptor->write(write_info);
+        }
+
+        m_frame_index = 0;
     }
 
     void AntiAliasing::execute(const vk::CommandBuffer& command_buffer)
     {
+        const auto& output = get_resource<ImageResource>(s_output_name);
+
+        // The previous output is not a requirement of this node, the render path leaves its layout alone
+        const auto& previous = output.get_previous_image();
+        if (previous->state().layout != vk::ImageLayout::eShaderReadOnlyOptimal)
+        {
+            auto barrier = nvk::ImageBarrier(previous, previous->state().layout, vk::ImageLayout::eShaderReadOnlyOptimal).barrier();
+            barrier
+                .setSrcStageMask(vk::PipelineStageFlagBits2::eAllCommands)
+                .setSrcAccessMask(vk::AccessFlagBits2::eMemoryWrite)
+                .setDstStageMask(vk::PipelineStageFlagBits2::eComputeShader)
+                .setDstAccessMask(vk::AccessFlagBits2::eShaderSampledRead);
+            command_buffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(barrier));
+            previous->update_state({vk::AccessFlagBits2::eShaderSampledRead, vk::ImageLayout::eShaderReadOnlyOptimal, vk::PipelineStageFlagBits2::eComputeShader});
+        }
+
+        const bool temporal = (m_configuration.m_mode != AntiAliasingMode::eDisabled);
+        const bool history_valid = temporal && m_frame_index > 0;
+        const auto& jitter = m_context->m_jitter;
+        const auto render_extent = m_context->get_active_extent(m_render_extent);
+
+        TemporalPushConstant push_constant {
+            .jitter = { jitter.x, jitter.y, temporal ? m_configuration.blend_factor : 1.0f, history_valid ? 1.0f : 0.0f },
+            .extent = glm::ivec4(render_extent.width, render_extent.height, m_target_extent.width, m_target_extent.height),
+        };
 
+        const uint32_t set_idx = m_current_frame % output.images().size();
+        m_pipeline->bind(command_buffer);
+        m_pipeline->bind_descriptor_set(command_buffer, m_descriptor->set(set_idx));
+        command_buffer.pushConstants(m_pipeline->layout(), vk::ShaderStageFlagBits::eCompute, 0, sizeof(TemporalPushConstant), &push_constant);
+        command_buffer.dispatch((m_target_extent.width + s_group_size - 1) / s_group_size, (m_target_extent.height + s_group_size - 1) / s_group_size, 1);
+
+        m_frame_index++;
     }
 
     void AntiAliasing::update()
     {
+    }
 
+    std::optional<PostStage> AntiAliasing::get_post_stage() const
+    {
+        if (m_configuration.m_mode != AntiAliasingMode::eDisabled)
+        {
+            return std::nullopt;
+        }
+        return PostStage { .op = PostOp::eResample, .input = s_input_name, .output = s_output_name };
     }
 
     void AntiAliasing::Configuration::render()
     {
+        ImGui::PushItemWidth(128);
+        {
+            if (ImGui::BeginCombo("Mode", to_string(m_mode).c_str()))
+            {
+                for (const auto mode : m_modes)
+                {
+                    const bool is_selected = (m_mode == mode);
+                    if (ImGui::Selectable(to_string(mode).c_str(), is_selected))
+                        m_mode = mode;
+
+                    if (is_selected)
+                        ImGui::SetItemDefaultFocus();
+                }
+                ImGui::EndCombo();
+            }
 
+            ImGui::SliderFloat("Blend Factor", &blend_factor, 0.02f, 0.5f);
+        }
+        ImGui::PopItemWidth();
     }
 
     bool AntiAliasing::Configuration::validate()
     {
-        return true;
+        return m_mode != AntiAliasingMode::eUnknown && blend_factor > 0.0f && blend_factor <= 1.0f;
     }
 }
@@ -2,15 +2,18 @@
 
 #include <array>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 #include <glm/vec2.hpp>
 #include <glm/vec4.hpp>
 #include <vulkan/vulkan.hpp>
+#include <nrg/common/Context.hpp>
 #include <nrg/common/Node.hpp>
 #include <nrg/common/NodeConfiguration.hpp>
 #include <nrg/common/NodeTraits.hpp>
 #include <nrg/common/ResourceClaim.hpp>
+#include <nrg/resource/Requirement.hpp>
 #include <nvk/Descriptor.hpp>
 #include <nvk/Device.hpp>
 #include <nvk/render/Pipeline.hpp>
@@ -22,20 +25,41 @@ namespace Nebula::nrg
         eDisabled,
         eFXAA,
         eFSR2,
+        eTemporalUpscaling,
         eUnknown,
     };
 
+    inline std::string to_string(const AntiAliasingMode aa_mode)
+    {
+        using enum AntiAliasingMode;
+        switch (aa_mode)
+        {
+            case eDisabled:          return "Disabled";
+            case eFXAA:              return "FXAA";
+            case eFSR2:              return "FSR2";
+            case eTemporalUpscaling: return "TAAU";
+            default:                 return "Unknown";
+        }
+    }
+
     class AntiAliasing : public Node
     {
     public:
         struct Configuration : public NodeConfiguration
         {
-            AntiAliasingMode m_mode {AntiAliasingMode::eFXAA};
+            AntiAliasingMode m_mode       {AntiAliasingMode::eTemporalUpscaling};
+            float            blend_factor {0.1f};
 
             void render() override;
             bool validate() override;
 
             ~Configuration() override = default;
+
+        private:
+            std::vector<AntiAliasingMode> m_modes = {
+                AntiAliasingMode::eDisabled, AntiAliasingMode::eFXAA,
+                AntiAliasingMode::eFSR2, AntiAliasingMode::eTemporalUpscaling,
+            };
         };
 
         struct alignas(glm::vec4) PushConstant
@@ -56,8 +80,14 @@ namespace Nebula::nrg
             glm::vec2                        resolution_rcp; // 1/res
         };
 
+        struct TemporalPushConstant
+        {
+            glm::vec4  jitter;  // [ Jitter X, Jitter Y, Blend Factor, History Valid ]
+            glm::ivec4 extent;  // [ Render Width, Render Height, Target Width, Target Height ]
+        };
+
         AntiAliasing(const std::shared_ptr<Configuration>& configuration,
-                     const std::shared_ptr<nvk::Device>& device);
+                     const std::shared_ptr<Context>& context);
 
         void initialize() override;
 
@@ -65,27 +95,32 @@ namespace Nebula::nrg
 
         void update() override;
 
+        vk::PipelineStageFlags2 shader_stages() const override { return vk::PipelineStageFlagBits2::eComputeShader; }
+
+        // With anti-aliasing disabled the node only resamples its input to the target resolution
+        std::optional<PostStage> get_post_stage() const override;
+
     private:
+        static constexpr uint32_t    s_group_size  = 8;
+
         static constexpr const char* s_input_name  = "AA Input";
+        static constexpr const char* s_motion_vec  = "Motion Vectors";
         static constexpr const char* s_output_name = "AA Output";
 
-        const Configuration          m_configuration;
-        std::shared_ptr<nvk::Device> m_device;
-        std::unique_ptr<Renderer>    m_renderer;
+        const Configuration              m_configuration;
+        std::shared_ptr<Context>         m_context;
+        std::shared_ptr<nvk::Device>     m_device;
+        std::unique_ptr<Renderer>        m_renderer;
+
+        // Temporal upscaling, one descriptor set per history image
+        uint32_t&                        m_current_frame;
+        std::shared_ptr<nvk::Pipeline>   m_pipeline;
+        std::shared_ptr<nvk::Descriptor> m_descriptor;
+        vk::Extent2D                     m_render_extent {};
+        vk::Extent2D                     m_target_extent {};
+        uint32_t                         m_frame_index {0};
 
         nrg_decl_resource_requirements();
         nrg_def_get_resource_claims();
     };
-
-    inline std::string to_string(const AntiAliasingMode aa_mode)
-    {
-        using enum AntiAliasingMode;
-        switch (aa_mode)
-        {
-            case eDisabled: return "Disabled";
-            case eFXAA:     return "FXAA";
-            case eFSR2:     return "FSR2";
-            default:        return "Unknown";
-        }
-    }
-}
\ No newline at end of file
+}
@@ -0,0 +1,142 @@
+#include "Bloom.hpp"
+#include <algorithm>
+#include <nrg/common/ResourceTraits.hpp>
+#include <nrg/resource/Resources.hpp>
+
+namespace Nebula::nrg
+{
+    #define nrg_bloom_mip(idx, scale) \
+        scratch(relative_extent(std::make_shared<ImageRequirement>(s_mips[idx], ResourceUsage::eOutput, ResourceType::eImage, vk::ImageLayout::eGeneral, vk::Format::eR16G16B16A16Sfloat), \
+                                scale, ResolutionReference::eTargetResolution))
+
+    nrg_def_resource_requirements(Bloom, ({
+        std::make_shared<ImageRequirement>(s_input, ResourceUsage::eInput, ResourceType::eImage, vk::ImageLayout::eShaderReadOnlyOptimal, vk::Format::eR32G32B32A32Sfloat),
+        relative_extent(std::make_shared<ImageRequirement>(s_output, ResourceUsage::eOutput, ResourceType::eImage, vk::ImageLayout::eGeneral, vk::Format::eR32G32B32A32Sfloat),
+                        1.0f, ResolutionReference::eTargetResolution),
+        nrg_bloom_mip(0, 1.0f / 2.0f),
+        nrg_bloom_mip(1, 1.0f / 4.0f),
+        nrg_bloom_mip(2, 1.0f / 8.0f),
+        nrg_bloom_mip(3, 1.0f / 16.0f),
+        nrg_bloom_mip(4, 1.0f / 32.0f),
+        nrg_bloom_mip(5, 1.0f / 64.0f),
+    }));
+
+    #undef nrg_bloom_mip
+
+    Bloom::Bloom(const std::shared_ptr<Configuration>& configuration, const std::shared_ptr<Context>& context)
+    : ComputeNode("Bloom", NodeType::eBloom, context)
+    , m_configuration(*configuration)
+    {
+    }
+
+    void Bloom::initialize()
+    {
+        m_levels = static_cast<uint32_t>(std::clamp(m_configuration.mip_count, 1, static_cast<int>(s_mip_count)));
+        m_input_extent = get_image_extent(s_input);
+        m_output_extent = get_image_extent(s_output);
+        for (uint32_t i = 0; i < s_mip_count; i++)
+        {
+            m_mip_extents[i] = get_image_extent(s_mips[i]);
+        }
+
+        // 1. Downsample, the first level reads the input of the frame, variant i reads level i - 1 into level i
+        auto downsample_info = ComputePipelineInfo()
+            .set_shader("nrg_bloom_downsample.comp.spv")
+            .add_sampled_image(0, s_input)
+            .add_storage_image(1, s_mips[0])
+            .set_push_constant_size(sizeof(PushConstant))
+            .set_group_size(s_group_size, s_group_size);
+
+        // 2. Upsample, variant i adds level i + 1 onto level i
+        auto upsample_info = ComputePipelineInfo()
+            .set_shader("nrg_bloom_upsample.comp.spv")
+            .add_sampled_image(0, s_mips[1])
+            .add_storage_image(1, s_mips[0])
+            .set_push_constant_size(sizeof(PushConstant))
+            .set_group_size(s_group_size, s_group_size);
+
+        for (uint32_t level = 1; level < s_mip_count; level++)
+        {
+            downsample_info.add_variant({ { 0, s_mips[level - 1] }, { 1, s_mips[level] } });
+            if (level + 1 < s_mip_count)
+            {
+                upsample_info.add_variant({ { 0, s_mips[level + 1] }, { 1, s_mips[level] } });
+            }
+        }
+
+        // 3. Composite of the first level onto the input
+        auto composite_info = ComputePipelineInfo()
+            .set_shader("nrg_bloom_composite.comp.spv")
+            .add_sampled_image(0, s_mips[0])
+            .add_sampled_image(1, s_input)
+            .add_storage_image(2, s_output)
+            .set_push_constant_size(sizeof(PushConstant))
+            .set_group_size(s_group_size, s_group_size);
+
+        m_downsample_pipeline = create_compute_pipeline(downsample_info);
+        m_upsample_pipeline = create_compute_pipeline(upsample_info);
+        m_composite_pipeline = create_compute_pipeline(composite_info);
+    }
+
+    void Bloom::execute(const vk::CommandBuffer& command_buffer)
+    {
+        // 1. Downsample chain, the first pass applies the threshold
+        for (uint32_t level = 0; level < m_levels; level++)
+        {
+            const auto& source = (level == 0) ? m_input_extent : m_mip_extents[level - 1];
+            const auto& destination = m_mip_extents[level];
+
+            const PushConstant push_constant {
+                .extent = glm::ivec4(source.width, source.height, destination.width, destination.height),
+                .params = { m_configuration.threshold, m_configuration.knee, (level == 0) ? 1.0f : 0.0f, 0.0f },
+            };
+
+            dispatch(command_buffer, destination, push_constant, m_downsample_pipeline, level);
+            compute_barrier(command_buffer);
+        }
+
+        // 2. Upsample chain, accumulating from the smallest level upwards
+        for (uint32_t level = m_levels - 1; level > 0; level--)
+        {
+            const auto& source = m_mip_extents[level];
+            const auto& destination = m_mip_extents[level - 1];
+
+            const PushConstant push_constant {
+                .extent = glm::ivec4(source.width, source.height, destination.width, destination.height),
+                .params = { 0.0f, 0.0f, 1.0f, 0.0f },
+            };
+
+            dispatch(command_buffer, destination, push_constant, m_upsample_pipeline, level - 1);
+            compute_barrier(command_buffer);
+        }
+
+        // 3. Composite, the accumulated levels are averaged so the intensity doesn't depend on the level count
+        const PushConstant push_constant {
+            .extent = glm::ivec4(m_mip_extents[0].width, m_mip_extents[0].height, m_output_extent.width, m_output_extent.height),
+            .params = { 0.0f, 0.0f, m_configuration.intensity / static_cast<float>(m_levels), 0.0f },
+        };
+
+        dispatch(command_buffer, m_output_extent, push_constant, m_composite_pipeline);
+    }
+
+    void Bloom::update()
+    {
+    }
+
+    void Bloom::Configuration::render()
+    {
+        ImGui::PushItemWidth(128);
+        {
+            ImGui::SliderInt("Levels", &mip_count, 1, static_cast<int>(s_mip_count));
+            ImGui::SliderFloat("Threshold", &threshold, 0.0f, 4.0f);
+            ImGui::SliderFloat("Knee", &knee, 0.0f, 1.0f);
+            ImGui::SliderFloat("Intensity", &intensity, 0.0f, 0.5f);
+        }
+        ImGui::PopItemWidth();
+    }
+
+    bool Bloom::Configuration::validate()
+    {
+        return mip_count >= 1 && mip_count <= static_cast<int>(s_mip_count) && threshold >= 0.0f && knee >= 0.0f && intensity >= 0.0f;
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.hpp>
+#include <nrg/common/ComputeNode.hpp>
+#include <nrg/common/Context.hpp>
+#include <nrg/common/NodeConfiguration.hpp>
+#include <nrg/common/NodeTraits.hpp>
+#include <nrg/common/ResourceClaim.hpp>
+#include <nrg/resource/Requirement.hpp>
+
+namespace Nebula::nrg
+{
+    /**
+     * Bloom from a progressive compute downsample & upsample chain.
+     * Every level is downsampled with a separable binomial filter out of groupshared memory, the chain is then
+     * accumulated back up with a tent filter and added to the input. The levels are scratch graph resources.
+     */
+    class Bloom : public ComputeNode
+    {
+        struct PushConstant
+        {
+            glm::ivec4 extent;  // [ Source Width, Source Height, Destination Width, Destination Height ]
+            glm::vec4  params;  // [ Threshold, Knee, Prefilter | Intensity, - ]
+        };
+
+    public:
+        struct Configuration : public NodeConfiguration
+        {
+            int   mip_count {6};
+            float threshold {1.0f};
+            float knee      {0.5f};    // Width of the soft threshold transition
+            float intensity {0.05f};
+
+            void render() override;
+            bool validate() override;
+            ~Configuration() override = default;
+        };
+
+        Bloom(const std::shared_ptr<Configuration>& configuration, const std::shared_ptr<Context>& context);
+
+        ~Bloom() override = default;
+
+        void initialize() override;
+
+        void execute(const vk::CommandBuffer& command_buffer) override;
+
+        void update() override;
+
+    private:
+        static constexpr uint32_t s_mip_count = 6;
+
+        const Configuration                         m_configuration;
+
+        uint32_t                                    m_downsample_pipeline {0};
+        uint32_t                                    m_upsample_pipeline {0};
+        uint32_t                                    m_composite_pipeline {0};
+
+        std::array<vk::Extent2D, s_mip_count>       m_mip_extents {};
+        vk::Extent2D                                m_input_extent {};
+        vk::Extent2D                                m_output_extent {};
+        uint32_t                                    m_levels {s_mip_count};
+
+        static constexpr uint32_t    s_group_size = 8;
+
+        static constexpr const char* s_input      = "Input";
+        static constexpr const char* s_output     = "Output";
+
+        static constexpr std::array<const char*, s_mip_count> s_mips = {
+            "Bloom Mip 1", "Bloom Mip 2", "Bloom Mip 3", "Bloom Mip 4", "Bloom Mip 5", "Bloom Mip 6",
+        };
+
+        nrg_decl_resource_requirements();
+        nrg_def_get_resource_claims();
+    };
+}
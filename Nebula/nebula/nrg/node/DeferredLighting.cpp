@@ -1,5 +1,6 @@
 #include "DeferredLighting.hpp"
 #include <nrg/resource/Resources.hpp>
+#include <nvk/Barrier.hpp>
 
 namespace Nebula::nrg
 {
@@ -10,7 +11,7 @@ namespace Nebula::nrg
         std::make_shared<ImageRequirement>(s_ao, ResourceUsage::eInput, ResourceType::eImage, vk::ImageLayout::eShaderReadOnlyOptimal,vk::Format::eR32Sfloat),
         std::make_shared<ImageRequirement>(s_shadows, ResourceUsage::eInput, ResourceType::eImage, vk::ImageLayout::eShaderReadOnlyOptimal,vk::Format::eR32Sfloat),
         std::make_shared<Requirement>(s_scene_data, ResourceUsage::eInput, ResourceType::eSceneData),
-        std::make_shared<ImageRequirement>(s_output, ResourceUsage::eOutput, ResourceType::eImage, vk::Format::eR32G32B32A32Sfloat),
+        presentable(std::make_shared<ImageRequirement>(s_output, ResourceUsage::eOutput, ResourceType::eImage, vk::Format::eR32G32B32A32Sfloat)),
     }))
 
     DeferredLighting::DeferredLighting(const std::shared_ptr<Configuration>& configuration, const std::shared_ptr<Context>& context)
@@ -24,13 +25,13 @@ namespace Nebula::nrg
 
     void DeferredLighting::initialize()
     {
-        auto render_resolution = m_context->m_render_resolution.operator vk::Extent2D();
+        auto render_resolution = m_context->m_max_render_resolution.operator vk::Extent2D();
+        m_render_extent = render_resolution;
 
         const auto& scene = get_resource<SceneResource>(s_scene_data).get_scene();
         const auto& position = get_resource<ImageResource>(s_position).get_image();
         const auto& normal = get_resource<ImageResource>(s_normal).get_image();
         const auto& albedo = get_resource<ImageResource>(s_albedo).get_image();
-        const auto& output = get_resource<ImageResource>(s_output).get_image();
 
         using SSFB = vk::ShaderStageFlagBits;
         auto descriptor_create_info = nvk::DescriptorCreateInfo()
@@ -39,23 +40,37 @@ namespace Nebula::nrg
             .add(nvk::DescriptorType::eSampledImage, 2, SSFB::eFragment)
             .add(nvk::DescriptorType::eSampledImage, 3, SSFB::eFragment)
             .add(nvk::DescriptorType::eSampledImage, 4, SSFB::eFragment)
+            .add(nvk::DescriptorType::eSampledImage, 5, SSFB::eFragment)
+            .add(nvk::DescriptorType::eSampledImage, 6, SSFB::eFragment)
             .set_count(2)
             .set_name("DeferredLighting");
         m_descriptor = std::make_shared<nvk::Descriptor>(descriptor_create_info, m_device);
 
-        auto render_pass_create_info = nvk::RenderPassCreateInfo()
-            .add_attachment(output)
-            .set_name("DeferredLighting")
-            .set_render_area({{0,0}, render_resolution});
-        m_render_pass = std::make_shared<nvk::RenderPass>(render_pass_create_info, m_device);
-
-        auto framebuffer_create_info = nvk::FramebufferCreateInfo()
-            .set_framebuffer_count(m_context->m_frames)
-            .set_render_pass(m_render_pass->render_pass())
-            .set_extent(render_resolution)
-            .set_name("DeferredLighting Framebuffer")
-            .add_attachment(output->image_view());
-        m_framebuffers = std::make_shared<nvk::Framebuffer>(framebuffer_create_info, m_device);
+        if (is_swapchain_output(s_output))
+        {
+            create_swapchain_targets(render_resolution);
+        }
+        else
+        {
+            const auto& output = get_resource<ImageResource>(s_output).get_image();
+            const auto output_info = get_attachment_info(s_output);
+
+            // Every pixel is written by the fullscreen pass, no need to clear
+            auto render_pass_create_info = nvk::RenderPassCreateInfo()
+                .add_attachment(output, output_info.final_layout, {0.0f, 0.0f, 0.0f, 1.0f},
+                                output_info.load_op, output_info.store_op, output_info.initial_layout)
+                .set_name("DeferredLighting")
+                .set_render_area({{0,0}, render_resolution});
+            m_render_pass = std::make_shared<nvk::RenderPass>(render_pass_create_info, m_device);
+
+            auto framebuffer_create_info = nvk::FramebufferCreateInfo()
+                .set_framebuffer_count(m_context->m_frames)
+                .set_render_pass(m_render_pass->render_pass())
+                .set_extent(render_resolution)
+                .set_name("DeferredLighting Framebuffer")
+                .add_attachment(output->image_view());
+            m_framebuffers = std::make_shared<nvk::Framebuffer>(framebuffer_create_info, m_device);
+        }
 
         auto pipeline_create_info = nvk::PipelineCreateInfo()
             .set_pipeline_type(nvk::PipelineType::eGraphics)
@@ -89,21 +104,120 @@ namespace Nebula::nrg
                 .set_set_index(i);
             m_descriptor->write(write_info);
         }
+
+        create_input_fallback();
+        m_ao_enabled = m_configuration.use_ambient_occlusion && m_resources.contains(s_ao);
+        write_ao_descriptor();
+
+        m_shadows_enabled = uses_shadow_maps() && m_resources.contains(s_shadows);
+        write_shadow_descriptor();
+    }
+
+    bool DeferredLighting::has_input_fallback(const std::string& key) const
+    {
+        return key == s_ao || key == s_shadows;
+    }
+
+    void DeferredLighting::set_input_enabled(const std::string& key, bool enabled)
+    {
+        if (key == s_ao)
+        {
+            m_ao_enabled = enabled && m_configuration.use_ambient_occlusion && m_resources.contains(s_ao);
+            write_ao_descriptor();
+        }
+        else if (key == s_shadows)
+        {
+            m_shadows_enabled = enabled && uses_shadow_maps() && m_resources.contains(s_shadows);
+            write_shadow_descriptor();
+        }
+    }
+
+    void DeferredLighting::create_input_fallback()
+    {
+        using enum vk::ImageUsageFlagBits;
+        auto image_info = nvk::ImageCreateInfo()
+            .set_extent({1, 1})
+            .set_format(vk::Format::eR32Sfloat)
+            .set_name("DeferredLighting Input Fallback")
+            .set_usage_flags(eSampled | eTransferDst)
+            .set_with_sampler(true);
+        m_input_fallback = nvk::Image::create(image_info, m_device);
+
+        m_context->m_command_pool->exec_single_time_command([&](const vk::CommandBuffer& cmd) {
+            const auto& range = m_input_fallback->properties().subresource_range;
+            nvk::ImageBarrier(m_input_fallback, vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal).apply(cmd);
+            cmd.clearColorImage(m_input_fallback->image(), vk::ImageLayout::eTransferDstOptimal, vk::ClearColorValue(std::array<float, 4>{1.0f, 1.0f, 1.0f, 1.0f}), range);
+            nvk::ImageBarrier(m_input_fallback, vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal).apply(cmd);
+        });
+    }
+
+    void DeferredLighting::write_ao_descriptor()
+    {
+        const auto& ao = m_ao_enabled ? get_resource<ImageResource>(s_ao).get_image() : m_input_fallback;
+        vk::DescriptorImageInfo ao_info = { ao->default_sampler(), ao->image_view(), vk::ImageLayout::eShaderReadOnlyOptimal };
+
+        for (uint32_t i = 0; i < m_descriptor->set_count(); i++)
+        {
+            auto write_info = nvk::DescriptorWriteInfo()
+                .add_combined_image_sampler(5, ao_info)
+                .set_set_index(i);
+            m_descriptor->write(write_info);
+        }
+    }
+
+    void DeferredLighting::write_shadow_descriptor()
+    {
+        const auto& shadows = m_shadows_enabled ? get_resource<ImageResource>(s_shadows).get_image() : m_input_fallback;
+        vk::DescriptorImageInfo shadow_info = { shadows->default_sampler(), shadows->image_view(), vk::ImageLayout::eShaderReadOnlyOptimal };
+
+        for (uint32_t i = 0; i < m_descriptor->set_count(); i++)
+        {
+            auto write_info = nvk::DescriptorWriteInfo()
+                .add_combined_image_sampler(6, shadow_info)
+                .set_set_index(i);
+            m_descriptor->write(write_info);
+        }
     }
 
     void DeferredLighting::execute(const vk::CommandBuffer& command_buffer)
     {
         auto scene = get_resource<SceneResource>(s_scene_data).get_scene();
+        const auto active_extent = m_context->get_active_extent(m_render_extent);
 
+        m_render_pass->set_render_area({{0, 0}, active_extent});
         m_render_pass->execute(command_buffer, m_framebuffers->get(m_current_frame), [&](const vk::CommandBuffer& cmd) {
             m_pipeline->bind(cmd);
+            cmd.setViewport(0, vk::Viewport(0.0f, 0.0f, static_cast<float>(active_extent.width), static_cast<float>(active_extent.height), 0.0f, 1.0f));
+            cmd.setScissor(0, vk::Rect2D({0, 0}, active_extent));
             cmd.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, m_pipeline->layout(), 0, 1, &m_descriptor->set(m_current_frame), 0, nullptr);
-            auto push_constant = PushConstant(static_cast<int32_t>(scene->lights().size()));
+            auto push_constant = PushConstant(static_cast<int32_t>(scene->lights().size()), is_swapchain_output(s_output), active_extent, m_render_extent);
             cmd.pushConstants(m_pipeline->layout(), vk::ShaderStageFlagBits::eFragment, 0, sizeof(PushConstant), &push_constant);
             cmd.draw(3, 1, 0, 0);
         });
     }
 
+    void DeferredLighting::create_swapchain_targets(const vk::Extent2D& render_resolution)
+    {
+        const auto& swapchain = m_context->m_swapchain;
+
+        auto render_pass_create_info = nvk::RenderPassCreateInfo()
+            .add_color_attachment(swapchain->format(), vk::ImageLayout::ePresentSrcKHR)
+            .set_name("DeferredLighting (Swapchain)")
+            .set_render_area({{0,0}, render_resolution});
+        m_render_pass = std::make_shared<nvk::RenderPass>(render_pass_create_info, m_device);
+
+        auto framebuffer_create_info = nvk::FramebufferCreateInfo()
+            .set_framebuffer_count(swapchain->image_count())
+            .set_render_pass(m_render_pass->render_pass())
+            .set_extent(render_resolution)
+            .set_name("DeferredLighting Swapchain Framebuffer");
+        for (uint32_t i = 0; i < swapchain->image_count(); i++)
+        {
+            framebuffer_create_info.add_attachment(swapchain->image_view(i), 0, i);
+        }
+        m_framebuffers = std::make_shared<nvk::Framebuffer>(framebuffer_create_info, m_device);
+    }
+
     void DeferredLighting::update()
     {
 
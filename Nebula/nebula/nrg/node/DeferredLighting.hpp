@@ -13,6 +13,7 @@
 #include <nvk/Buffer.hpp>
 #include <nvk/Device.hpp>
 #include <nvk/Descriptor.hpp>
+#include <nvk/Image.hpp>
 #include <nvk/render/Framebuffer.hpp>
 #include <nvk/render/Pipeline.hpp>
 #include <nvk/render/RenderPass.hpp>
@@ -69,10 +70,16 @@ namespace Nebula::nrg
         struct PushConstant
         {
             glm::ivec4 params;
+            glm::vec4  uv_scale;  // [ Active / Allocated Width, Active / Allocated Height, -, - ]
 
             PushConstant() = default;
 
-            explicit PushConstant(int32_t n_lights): params(n_lights, 0, 0, 0) {}
+            PushConstant(int32_t n_lights, bool swapchain_output, const vk::Extent2D& active, const vk::Extent2D& allocated)
+            : params(n_lights, swapchain_output ? 1 : 0, 0, 0)
+            , uv_scale(static_cast<float>(active.width) / static_cast<float>(allocated.width),
+                       static_cast<float>(active.height) / static_cast<float>(allocated.height), 0.0f, 0.0f)
+            {
+            }
         };
 
         DeferredLighting(const std::shared_ptr<Configuration>& configuration, const std::shared_ptr<Context>& context);
@@ -85,7 +92,24 @@ namespace Nebula::nrg
 
         void update() override;
 
+        bool has_input_fallback(const std::string& key) const override;
+
+        void set_input_enabled(const std::string& key, bool enabled) override;
+
     private:
+        void create_swapchain_targets(const vk::Extent2D& render_resolution);
+
+        void create_input_fallback();
+
+        void write_ao_descriptor();
+
+        void write_shadow_descriptor();
+
+        bool uses_shadow_maps() const
+        {
+            return m_configuration.shadow_mode_idx == static_cast<int>(ShadowMode::eShadowMaps);
+        }
+
         const Configuration                         m_configuration;
         std::shared_ptr<Context>                    m_context;
         std::shared_ptr<nvk::Device>                m_device;
@@ -96,6 +120,12 @@ namespace Nebula::nrg
         std::shared_ptr<nvk::Framebuffer>           m_framebuffers;
         std::shared_ptr<nvk::Descriptor>            m_descriptor;
 
+        // 1x1 white image bound in place of a missing or disabled AO or shadow input
+        std::shared_ptr<nvk::Image>                 m_input_fallback;
+        bool                                        m_ao_enabled {false};
+        bool                                        m_shadows_enabled {false};
+        vk::Extent2D                                m_render_extent {};
+
         static constexpr const char* s_output     = "Output Image";
         static constexpr const char* s_position   = "Position Buffer";
         static constexpr const char* s_normal     = "Normal Buffer";
@@ -1,6 +1,10 @@
 #include "GBuffer.hpp"
+#include <algorithm>
+#include <cstring>
+#include <nlog/nlog.hpp>
 #include <nrg/common/ResourceTraits.hpp>
 #include <nrg/resource/Resources.hpp>
+#include <nscene/InstancedDraws.hpp>
 #include <nscene/Vertex.hpp>
 
 namespace Nebula::nrg
@@ -12,13 +16,25 @@ namespace Nebula::nrg
         std::make_shared<ImageRequirement>(s_albedo, ResourceUsage::eOutput, ResourceType::eImage, vk::Format::eR32G32B32A32Sfloat),
         std::make_shared<ImageRequirement>(s_depth, ResourceUsage::eOutput, ResourceType::eImage, vk::Format::eD32Sfloat),
         std::make_shared<ImageRequirement>(s_motion_vec, ResourceUsage::eOutput, ResourceType::eImage, vk::Format::eR32G32B32A32Sfloat),
+        std::make_shared<BufferRequirement>(s_draw_list, ResourceUsage::eInput, ResourceType::eStorageBuffer, vk::BufferUsageFlagBits::eStorageBuffer),
     }))
 
+    GBuffer::~GBuffer()
+    {
+        release_object_staging();
+    }
+
     void GBuffer::initialize()
     {
-        auto render_resolution = m_context->m_render_resolution.operator vk::Extent2D();
+        auto render_resolution = m_context->m_max_render_resolution.operator vk::Extent2D();
+        m_render_extent = render_resolution;
 
         auto scene = get_resource<SceneResource>(s_scene_data).get_scene();
+        if (scene->objects().empty())
+        {
+            throw nlog::make_exception("{}: Scene \"{}\" has no objects", name(), scene->name());
+        }
+
         auto position = get_resource<ImageResource>(s_position).get_image();
         auto normal = get_resource<ImageResource>(s_normal).get_image();
         auto albedo = get_resource<ImageResource>(s_albedo).get_image();
@@ -27,16 +43,28 @@ namespace Nebula::nrg
 
         auto descriptor_create_info = nvk::DescriptorCreateInfo()
             .add(nvk::DescriptorType::eUniformBuffer, 0, vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment)
+            .add(nvk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eVertex)
+            .add(nvk::DescriptorType::eStorageBuffer, 2, vk::ShaderStageFlagBits::eVertex)
             .set_count(2)
             .set_name("G-Buffer");
         m_descriptor = std::make_shared<nvk::Descriptor>(descriptor_create_info, m_device);
 
-        auto render_pass_create_info = nvk::RenderPassCreateInfo()
-            .add_attachment(position)
-            .add_attachment(normal)
-            .add_attachment(albedo)
-            .add_attachment(motion_vec)
-            .set_depth_attachment(depth)
+        // Lighting relies on the cleared background, discarded contents are cleared instead
+        auto render_pass_create_info = nvk::RenderPassCreateInfo();
+        const auto add_attachment = [&](const std::string& key, const std::shared_ptr<nvk::Image>& image) {
+            const auto info = get_attachment_info(key);
+            render_pass_create_info.add_attachment(image, info.final_layout, {0.0f, 0.0f, 0.0f, 1.0f},
+                                                   info.load_op_or_clear(), info.store_op, info.initial_layout);
+        };
+        add_attachment(s_position, position);
+        add_attachment(s_normal, normal);
+        add_attachment(s_albedo, albedo);
+        add_attachment(s_motion_vec, motion_vec);
+
+        const auto depth_info = get_attachment_info(s_depth);
+        render_pass_create_info
+            .set_depth_attachment(depth, {1.0f, 0}, depth_info.load_op_or_clear(), depth_info.store_op,
+                                  depth_info.initial_layout, depth_info.final_layout)
             .set_name("G-Buffer RenderPass")
             .set_render_area({{0,0}, render_resolution});
         m_render_pass = std::make_shared<nvk::RenderPass>(render_pass_create_info, m_device);
@@ -51,11 +79,63 @@ namespace Nebula::nrg
             .add_attachment(albedo->image_view())
             .add_attachment(motion_vec->image_view())
             .add_attachment(depth->image_view());
+
+        // Depth read by the culling of the next frame is kept for every frame in flight
+        const auto& r_depth = get_resource<ImageResource>(s_depth);
+        if (r_depth.is_history())
+        {
+            for (uint32_t i = 0; i < m_context->m_frames; i++)
+            {
+                framebuffer_create_info.add_attachment(r_depth.get_image(i)->image_view(), 4, i);
+            }
+        }
         m_framebuffers = std::make_shared<nvk::Framebuffer>(framebuffer_create_info, m_device);
 
+        if (m_resources.contains(s_draw_list))
+        {
+            m_draw_list_layout = DrawListLayout(*scene);
+
+            std::vector<std::shared_ptr<nvk::Image>> depth_images;
+            for (uint32_t i = 0; i < m_context->m_frames; i++)
+            {
+                depth_images.push_back(r_depth.get_image(i));
+            }
+            m_culler = std::make_unique<OcclusionCuller>(name(), depth_images, get_resource<BufferResource>(s_draw_list).get_buffer(),
+                                                         m_draw_list_layout, m_context);
+
+            // The first phase keeps everything for the second, which continues with the final layouts of the graph
+            using enum vk::ImageLayout;
+            auto occlusion_create_info = nvk::RenderPassCreateInfo();
+            auto retest_create_info = nvk::RenderPassCreateInfo();
+            const auto add_phase_attachments = [&](const std::string& key, const std::shared_ptr<nvk::Image>& image) {
+                const auto info = get_attachment_info(key);
+                occlusion_create_info.add_attachment(image, eColorAttachmentOptimal, {0.0f, 0.0f, 0.0f, 1.0f},
+                                                     vk::AttachmentLoadOp::eClear, vk::AttachmentStoreOp::eStore, info.initial_layout);
+                retest_create_info.add_attachment(image, info.final_layout, {0.0f, 0.0f, 0.0f, 1.0f},
+                                                  vk::AttachmentLoadOp::eLoad, info.store_op, eColorAttachmentOptimal);
+            };
+            add_phase_attachments(s_position, position);
+            add_phase_attachments(s_normal, normal);
+            add_phase_attachments(s_albedo, albedo);
+            add_phase_attachments(s_motion_vec, motion_vec);
+
+            occlusion_create_info
+                .set_depth_attachment(depth, {1.0f, 0}, vk::AttachmentLoadOp::eClear, vk::AttachmentStoreOp::eStore,
+                                      depth_info.initial_layout, eShaderReadOnlyOptimal)
+                .set_name("G-Buffer Occlusion RenderPass")
+                .set_render_area({{0,0}, render_resolution});
+            retest_create_info
+                .set_depth_attachment(depth, {1.0f, 0}, vk::AttachmentLoadOp::eLoad, depth_info.store_op,
+                                      eShaderReadOnlyOptimal, depth_info.final_layout)
+                .set_name("G-Buffer Retest RenderPass")
+                .set_render_area({{0,0}, render_resolution});
+            m_occlusion_render_pass = std::make_shared<nvk::RenderPass>(occlusion_create_info, m_device);
+            m_retest_render_pass = std::make_shared<nvk::RenderPass>(retest_create_info, m_device);
+            m_gpu_culling = true;
+        }
+
         auto pipeline_create_info = nvk::PipelineCreateInfo()
             .set_pipeline_type(nvk::PipelineType::eGraphics)
-            .add_push_constant({ vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment, 0, sizeof(PushConstant) })
             .add_descriptor_set_layout(m_descriptor->layout())
             .add_attribute_descriptions<ns::Vertex>()
             .add_binding_description<ns::Vertex>()
@@ -67,7 +147,38 @@ namespace Nebula::nrg
             .set_name("G-Buffer");
         m_pipeline = std::make_shared<nvk::Pipeline>(pipeline_create_info, m_device);
 
+        const auto& objects = scene->objects();
+        auto object_create_info = nvk::BufferCreateInfo()
+            .set_buffer_type(nvk::BufferType::eCustom)
+            .add_usage_flags(vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst)
+            .add_memory_property_flags(vk::MemoryPropertyFlagBits::eDeviceLocal)
+            .set_name("G-Buffer Objects")
+            .set_size(sizeof(ns::ObjectPushConstant) * objects.size());
+        m_object_buffer = std::make_shared<nvk::Buffer>(object_create_info, m_device);
+
+        // Every staging copy starts complete, the first frame copies all of it
+        std::vector<ns::ObjectPushConstant> object_data(objects.size());
+        for (uint32_t i = 0; i < objects.size(); i++)
+        {
+            object_data[i] = objects[i].get_push_constants(scene->world(i));
+        }
+
+        release_object_staging();
+        for (uint32_t i = 0; i < m_context->m_frames; i++)
+        {
+            auto staging_create_info = nvk::BufferCreateInfo()
+                .set_buffer_type(nvk::BufferType::eStaging)
+                .set_name(fmt::format("G-Buffer Objects #{}", i))
+                .set_size(sizeof(ns::ObjectPushConstant) * objects.size());
+            m_object_staging.push_back(std::make_shared<nvk::Buffer>(staging_create_info, m_device));
+            m_object_mapped.push_back(static_cast<ns::ObjectPushConstant*>(m_object_staging.back()->map()));
+            std::memcpy(m_object_mapped.back(), object_data.data(), sizeof(ns::ObjectPushConstant) * object_data.size());
+        }
+        m_transform_updates = scene->transforms().update_count();
+        m_copy_all = true;
+
         m_uniform_buffer.resize(m_context->m_frames);
+        m_instance_buffer.resize(m_context->m_frames);
         for (int32_t i = 0; i < m_context->m_frames; i++)
         {
             nvk::BufferCreateInfo buf_create_info{};
@@ -78,12 +189,46 @@ namespace Nebula::nrg
 
             m_uniform_buffer[i] = std::make_shared<nvk::Buffer>(buf_create_info, m_device);
 
+            auto instance_create_info = nvk::BufferCreateInfo()
+                .set_buffer_type(nvk::BufferType::eStorage)
+                .set_name(fmt::format("G-Buffer Instances #{}", i))
+                .set_size(sizeof(uint32_t) * objects.size());
+            m_instance_buffer[i] = std::make_shared<nvk::Buffer>(instance_create_info, m_device);
+
             vk::DescriptorBufferInfo buffer_info = { m_uniform_buffer[i]->buffer(), 0, sizeof(CameraUniform)};
             auto write_info = nvk::DescriptorWriteInfo()
                 .set_set_index(i)
                 .add_uniform_buffer(0, buffer_info);
             m_descriptor->write(write_info);
         }
+        write_object_descriptor();
+
+        // At most one instanced indirect draw per unique mesh, the objects of a scene don't change after it was initialized
+        const auto& geometry = scene->shared_geometry();
+        for (const auto& batch : scene->instance_batches())
+        {
+            m_batch_ranges.push_back(geometry.range(*batch.mesh));
+        }
+        m_max_draw_count = static_cast<uint32_t>(m_batch_ranges.size());
+
+        m_draw_buffer.resize(m_context->m_frames);
+        m_draw_count_buffer.resize(m_context->m_frames);
+        for (int32_t i = 0; i < m_context->m_frames; i++)
+        {
+            auto draw_create_info = nvk::BufferCreateInfo()
+                .set_buffer_type(nvk::BufferType::eStorage)
+                .add_usage_flags(vk::BufferUsageFlagBits::eIndirectBuffer)
+                .set_name(fmt::format("G-Buffer Draw Commands #{}", i))
+                .set_size(sizeof(vk::DrawIndexedIndirectCommand) * m_max_draw_count);
+            m_draw_buffer[i] = std::make_shared<nvk::Buffer>(draw_create_info, m_device);
+
+            auto draw_count_create_info = nvk::BufferCreateInfo()
+                .set_buffer_type(nvk::BufferType::eStorage)
+                .add_usage_flags(vk::BufferUsageFlagBits::eIndirectBuffer)
+                .set_name(fmt::format("G-Buffer Draw Count #{}", i))
+                .set_size(sizeof(uint32_t));
+            m_draw_count_buffer[i] = std::make_shared<nvk::Buffer>(draw_count_create_info, m_device);
+        }
 
         const auto& camera = get_resource<SceneResource>(s_scene_data).ref_scene().active_camera();
         m_camera_previous_frame = camera->uniform_data();
@@ -92,32 +237,204 @@ namespace Nebula::nrg
     void GBuffer::execute(const vk::CommandBuffer& command_buffer)
     {
         auto scene = get_resource<SceneResource>(s_scene_data).get_scene();
+        const auto& geometry = scene->shared_geometry();
+        const auto active_extent = m_context->get_active_extent(m_render_extent);
+
+        if (m_gpu_culling)
+        {
+            execute_occlusion_culled(command_buffer, active_extent);
+            return;
+        }
+
+        copy_objects(command_buffer);
 
+        m_render_pass->set_render_area({{0, 0}, active_extent});
         m_render_pass->execute(command_buffer, m_framebuffers->get(m_current_frame), [&](const vk::CommandBuffer& cmd) {
             m_pipeline->bind(cmd);
+            cmd.setViewport(0, vk::Viewport(0.0f, 0.0f, static_cast<float>(active_extent.width), static_cast<float>(active_extent.height), 0.0f, 1.0f));
+            cmd.setScissor(0, vk::Rect2D({0, 0}, active_extent));
             cmd.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, m_pipeline->layout(), 0, 1, &m_descriptor->set(m_current_frame), 0, nullptr);
-            for (const auto& object : scene->objects())
-            {
-                using enum vk::ShaderStageFlagBits;
-                auto push_constant = PushConstant(object.get_push_constants());
-                cmd.pushConstants(m_pipeline->layout(), eVertex | eFragment, 0, sizeof(PushConstant), &push_constant);
-                object.mesh->draw(cmd);
-            }
+            geometry.bind(cmd);
+            cmd.drawIndexedIndirectCount(m_draw_buffer[m_current_frame]->buffer(), 0, m_draw_count_buffer[m_current_frame]->buffer(), 0,
+                                         m_max_draw_count, sizeof(vk::DrawIndexedIndirectCommand));
         });
     }
 
     void GBuffer::update()
     {
-        auto scene = get_resource<SceneResource>(s_scene_data).ref_scene();
+        const auto& scene = get_resource<SceneResource>(s_scene_data).ref_scene();
         auto camera_data = scene.active_camera()->uniform_data();
 
+        // Jitter is only applied to the rasterized position, motion vectors stay unjittered
+        m_context->advance_jitter();
+        const auto active_extent = m_context->get_active_extent(m_render_extent);
+        const glm::vec2 jitter_ndc = 2.0f * m_context->m_jitter / glm::vec2(active_extent.width, active_extent.height);
+
         CameraUniform uniform_data {
             .current  = camera_data,
             .previous = m_camera_previous_frame,
+            .jitter   = glm::vec4(jitter_ndc, 0.0f, 0.0f),
         };
 
         m_uniform_buffer[m_current_frame]->set_data(&uniform_data);
-
         m_camera_previous_frame = camera_data;
+
+        // Commands & instances come from the draw list, culled on the GPU
+        if (m_gpu_culling)
+        {
+            m_view_proj = camera_data.proj * camera_data.view;
+            return;
+        }
+
+        // Every object after a missed scene update (culled on the GPU meanwhile), otherwise only the moved ones
+        const auto& objects = scene.objects();
+        const auto& transforms = scene.transforms();
+        m_copy_all |= (transforms.update_count() > m_transform_updates + 1);
+        m_transform_updates = transforms.update_count();
+
+        m_changed.clear();
+        if (m_copy_all)
+        {
+            for (uint32_t i = 0; i < objects.size(); i++) m_changed.push_back(i);
+            m_copy_all = false;
+        }
+        else
+        {
+            m_changed.assign(transforms.changed().begin(), transforms.changed().end());
+            std::ranges::sort(m_changed);
+        }
+
+        // Runs of adjacent objects are copied together
+        m_copy_regions.clear();
+        auto* object_data = m_object_mapped[m_current_frame];
+        for (const uint32_t object_idx : m_changed)
+        {
+            object_data[object_idx] = objects[object_idx].get_push_constants(scene.world(object_idx));
+
+            const vk::DeviceSize offset = object_idx * sizeof(ns::ObjectPushConstant);
+            if (!m_copy_regions.empty() && m_copy_regions.back().srcOffset + m_copy_regions.back().size == offset)
+            {
+                m_copy_regions.back().size += sizeof(ns::ObjectPushConstant);
+                continue;
+            }
+            m_copy_regions.push_back(vk::BufferCopy(offset, offset, sizeof(ns::ObjectPushConstant)));
+        }
+
+        // Visible objects grouped by batch, each batch with instances becomes one draw
+        const auto& visible = scene.visible_objects();
+        const auto& batch_of_object = scene.batch_of_object();
+
+        ns::build_instanced_draws(visible, batch_of_object, m_batch_ranges, m_batch_first, m_draw_commands, m_instance_objects);
+
+        const auto draw_count = static_cast<uint32_t>(m_draw_commands.size());
+        m_instance_buffer[m_current_frame]->set_data(m_instance_objects.data(), sizeof(uint32_t) * m_instance_objects.size());
+        m_draw_buffer[m_current_frame]->set_data(m_draw_commands.data(), sizeof(vk::DrawIndexedIndirectCommand) * m_draw_commands.size());
+        m_draw_count_buffer[m_current_frame]->set_data(&draw_count);
+    }
+
+    bool GBuffer::has_input_fallback(const std::string& key) const
+    {
+        return key == s_draw_list;
+    }
+
+    void GBuffer::set_input_enabled(const std::string& key, bool enabled)
+    {
+        if (key == s_draw_list)
+        {
+            m_gpu_culling = enabled && m_culler != nullptr;
+            write_object_descriptor();
+        }
+    }
+
+    void GBuffer::write_object_descriptor()
+    {
+        for (uint32_t i = 0; i < m_context->m_frames; i++)
+        {
+            vk::DescriptorBufferInfo object_info(m_object_buffer->buffer(), 0, VK_WHOLE_SIZE);
+            vk::DescriptorBufferInfo instance_info(m_instance_buffer[i]->buffer(), 0, VK_WHOLE_SIZE);
+            if (m_gpu_culling)
+            {
+                const auto& draw_list = *get_resource<BufferResource>(s_draw_list).get_buffer();
+                object_info = m_draw_list_layout.region(draw_list, m_draw_list_layout.objects, m_draw_list_layout.bounds - m_draw_list_layout.objects);
+                instance_info = m_draw_list_layout.region(draw_list, m_draw_list_layout.instances, m_draw_list_layout.size - m_draw_list_layout.instances);
+            }
+
+            auto write_info = nvk::DescriptorWriteInfo()
+                .set_set_index(i)
+                .add_storage_buffer(1, object_info)
+                .add_storage_buffer(2, instance_info);
+            m_descriptor->write(write_info);
+        }
+    }
+
+    void GBuffer::release_object_staging()
+    {
+        for (const auto& staging : m_object_staging)
+        {
+            staging->unmap();
+        }
+        m_object_staging.clear();
+        m_object_mapped.clear();
+    }
+
+    void GBuffer::copy_objects(const vk::CommandBuffer& command_buffer)
+    {
+        if (m_copy_regions.empty()) return;
+
+        using enum vk::PipelineStageFlagBits2;
+        using enum vk::AccessFlagBits2;
+
+        // The draws of the previous frame are done with the objects
+        auto reuse_barrier = vk::MemoryBarrier2()
+            .setSrcStageMask(eVertexShader)
+            .setDstStageMask(eAllTransfer)
+            .setDstAccessMask(eTransferWrite);
+        command_buffer.pipelineBarrier2(vk::DependencyInfo().setMemoryBarriers(reuse_barrier));
+
+        command_buffer.copyBuffer(m_object_staging[m_current_frame]->buffer(), m_object_buffer->buffer(), m_copy_regions);
+
+        auto copy_barrier = vk::MemoryBarrier2()
+            .setSrcStageMask(eAllTransfer)
+            .setSrcAccessMask(eTransferWrite)
+            .setDstStageMask(eVertexShader)
+            .setDstAccessMask(eShaderStorageRead);
+        command_buffer.pipelineBarrier2(vk::DependencyInfo().setMemoryBarriers(copy_barrier));
+    }
+
+    void GBuffer::execute_occlusion_culled(const vk::CommandBuffer& command_buffer, const vk::Extent2D& active_extent)
+    {
+        const auto& geometry = get_resource<SceneResource>(s_scene_data).get_scene()->shared_geometry();
+        const auto& draw_list = get_resource<BufferResource>(s_draw_list).get_buffer();
+        const auto& framebuffer = m_framebuffers->get(m_current_frame);
+
+        const auto draw_phase = [&](const std::shared_ptr<nvk::RenderPass>& render_pass, uint32_t phase) {
+            render_pass->set_render_area({{0, 0}, active_extent});
+            render_pass->execute(command_buffer, framebuffer, [&](const vk::CommandBuffer& cmd) {
+                m_pipeline->bind(cmd);
+                cmd.setViewport(0, vk::Viewport(0.0f, 0.0f, static_cast<float>(active_extent.width), static_cast<float>(active_extent.height), 0.0f, 1.0f));
+                cmd.setScissor(0, vk::Rect2D({0, 0}, active_extent));
+                cmd.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, m_pipeline->layout(), 0, 1, &m_descriptor->set(m_current_frame), 0, nullptr);
+                geometry.bind(cmd);
+                cmd.drawIndexedIndirect(draw_list->buffer(), m_draw_list_layout.commands_offset(phase),
+                                        m_draw_list_layout.batch_count, sizeof(vk::DrawIndexedIndirectCommand));
+            });
+        };
+
+        draw_phase(m_occlusion_render_pass, 0);
+
+        using enum vk::PipelineStageFlagBits2;
+        using enum vk::AccessFlagBits2;
+        auto depth_barrier = vk::MemoryBarrier2()
+            .setSrcStageMask(eLateFragmentTests)
+            .setSrcAccessMask(eDepthStencilAttachmentWrite)
+            .setDstStageMask(eComputeShader)
+            .setDstAccessMask(eShaderSampledRead);
+        command_buffer.pipelineBarrier2(vk::DependencyInfo().setMemoryBarriers(depth_barrier));
+
+        m_culler->build_pyramid(command_buffer, m_current_frame, active_extent);
+        m_culler->cull(command_buffer, m_current_frame, m_view_proj, 1, true);
+        OcclusionCuller::barrier_to_draw(command_buffer);
+
+        draw_phase(m_retest_render_pass, 1);
     }
 }
\ No newline at end of file
@@ -1,12 +1,14 @@
 #pragma once
 
 #include <memory>
+#include <string>
 #include <vector>
 #include <vulkan/vulkan.hpp>
 #include <nrg/common/Context.hpp>
 #include <nrg/common/Node.hpp>
 #include <nrg/common/NodeConfiguration.hpp>
 #include <nrg/common/NodeTraits.hpp>
+#include <nrg/common/OcclusionCulling.hpp>
 #include <nrg/common/ResourceClaim.hpp>
 #include <nrg/resource/Requirement.hpp>
 #include <nvk/Buffer.hpp>
@@ -18,24 +20,25 @@
 
 namespace Nebula::nrg
 {
+    /**
+     * GPU driven: the visible objects of every instance batch of the scene are one instanced
+     * vk::DrawIndexedIndirectCommand over the shared scene geometry, drawn with a single drawIndexedIndirectCount.
+     * Commands & the object index of every instance are compacted on the CPU each frame from the frustum culled objects
+     * of the scene, the vertex shader fetches the model matrix & color through the index from a storage buffer that is
+     * only written for the objects that moved.
+     *
+     * With a Draw List from the Hi-Z Culling node the commands & instances are taken from it instead, the objects
+     * that passed the first phase are drawn first, then the pyramid is rebuilt from this depth and the rejected
+     * objects are retested with the current camera & the newly visible ones drawn in a second render pass.
+     */
     class GBuffer : public Node
     {
-        struct PushConstant
-        {
-            ns::ObjectPushConstant object;
-
-            PushConstant() = default;
-
-            explicit PushConstant(const ns::ObjectPushConstant& obj)
-            : object(obj)
-            {
-            }
-        };
-
+        // Members start on 16 byte boundaries to match the std140 layout of the shader
         struct alignas(glm::vec4) CameraUniform
         {
-            ns::CameraData current;
-            ns::CameraData previous;
+            alignas(16) ns::CameraData current;
+            alignas(16) ns::CameraData previous;
+            alignas(16) glm::vec4      jitter;  // [ Jitter X, Jitter Y ] in NDC
         };
 
     public:
@@ -47,7 +50,7 @@ namespace Nebula::nrg
         {
         }
 
-        ~GBuffer() override = default;
+        ~GBuffer() override;
 
         void initialize() override;
 
@@ -55,7 +58,20 @@ namespace Nebula::nrg
 
         void update() override;
 
+        bool has_input_fallback(const std::string& key) const override;
+
+        void set_input_enabled(const std::string& key, bool enabled) override;
+
     private:
+        void write_object_descriptor();
+
+        void release_object_staging();
+
+        // Copies the objects written by the last update into the object buffer
+        void copy_objects(const vk::CommandBuffer& command_buffer);
+
+        void execute_occlusion_culled(const vk::CommandBuffer& command_buffer, const vk::Extent2D& active_extent);
+
         std::shared_ptr<Context>                    m_context;
         std::shared_ptr<nvk::Device>                m_device;
 
@@ -65,8 +81,36 @@ namespace Nebula::nrg
         std::shared_ptr<nvk::Framebuffer>           m_framebuffers;
         std::shared_ptr<nvk::Descriptor>            m_descriptor;
         std::vector<std::shared_ptr<nvk::Buffer>>   m_uniform_buffer;
+        std::vector<std::shared_ptr<nvk::Buffer>>   m_instance_buffer;
+        std::vector<std::shared_ptr<nvk::Buffer>>   m_draw_buffer;
+        std::vector<std::shared_ptr<nvk::Buffer>>   m_draw_count_buffer;
+        uint32_t                                    m_max_draw_count {0};
+
+        std::vector<ns::MeshRange>                  m_batch_ranges;
+        std::vector<uint32_t>                       m_batch_first;
+        std::vector<uint32_t>                       m_instance_objects;
+        std::vector<vk::DrawIndexedIndirectCommand> m_draw_commands;
+
+        // Object data in object order, kept across frames. Moved objects are written into the persistently mapped
+        // staging buffer of the frame & copied over before the draws
+        std::shared_ptr<nvk::Buffer>                m_object_buffer;
+        std::vector<std::shared_ptr<nvk::Buffer>>   m_object_staging;
+        std::vector<ns::ObjectPushConstant*>        m_object_mapped;
+        std::vector<uint32_t>                       m_changed;
+        std::vector<vk::BufferCopy>                 m_copy_regions;
+        uint64_t                                    m_transform_updates {0};
+        bool                                        m_copy_all {true};
+
+        // Second culling phase, only with a Draw List input
+        bool                                        m_gpu_culling {false};
+        DrawListLayout                              m_draw_list_layout;
+        std::unique_ptr<OcclusionCuller>            m_culler;
+        std::shared_ptr<nvk::RenderPass>            m_occlusion_render_pass;
+        std::shared_ptr<nvk::RenderPass>            m_retest_render_pass;
+        glm::mat4                                   m_view_proj {1.0f};
 
         ns::CameraData                              m_camera_previous_frame {};
+        vk::Extent2D                                m_render_extent {};
 
         static constexpr const char* s_scene_data = "Scene Data";
         static constexpr const char* s_position   = "Position Buffer";
@@ -74,6 +118,7 @@ namespace Nebula::nrg
         static constexpr const char* s_albedo     = "Albedo Buffer";
         static constexpr const char* s_depth      = "Depth Buffer";
         static constexpr const char* s_motion_vec = "Motion Vectors";
+        static constexpr const char* s_draw_list  = "Draw List";
 
         nrg_decl_resource_requirements();
         nrg_def_get_resource_claims();
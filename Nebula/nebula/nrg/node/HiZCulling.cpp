@@ -0,0 +1,217 @@
+#include "HiZCulling.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <nlog/nlog.hpp>
+#include <nrg/common/ResourceTraits.hpp>
+#include <nrg/resource/Resources.hpp>
+
+namespace Nebula::nrg
+{
+    nrg_def_resource_requirements(HiZCulling, ({
+        std::make_shared<Requirement>(s_scene_data, ResourceUsage::eInput, ResourceType::eSceneData),
+        previous_frame(std::make_shared<ImageRequirement>(s_depth, ResourceUsage::eInput, ResourceType::eImage, vk::ImageLayout::eShaderReadOnlyOptimal, vk::Format::eD32Sfloat)),
+        scene_sized(std::make_shared<BufferRequirement>(s_draw_list, ResourceUsage::eOutput, ResourceType::eStorageBuffer,
+                                                        vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer),
+                    [](const ns::Scene& scene) { return DrawListLayout(scene).size; }),
+    }));
+
+    HiZCulling::~HiZCulling()
+    {
+        release_host_buffers();
+    }
+
+    CullBounds HiZCulling::make_cull_bounds(const ns::Scene& scene, const uint32_t object_idx)
+    {
+        // Objects without bounds are always visible, flagged in extent.w as the shader can't test them
+        const auto& bounds = scene.object_bounds()[object_idx];
+        const float batch_idx = std::bit_cast<float>(scene.batch_of_object()[object_idx]);
+        if (!bounds.is_valid())
+        {
+            return {
+                .center = glm::vec4(glm::vec3(0.0f), batch_idx),
+                .extent = glm::vec4(glm::vec3(0.0f), 1.0f),
+            };
+        }
+
+        return {
+            .center = glm::vec4(bounds.center(), batch_idx),
+            .extent = glm::vec4(bounds.half_extent(), 0.0f),
+        };
+    }
+
+    void HiZCulling::release_host_buffers()
+    {
+        for (const auto& host_buffer : m_host_buffer)
+        {
+            host_buffer->unmap();
+        }
+        m_host_buffer.clear();
+        m_host_mapped.clear();
+    }
+
+    void HiZCulling::initialize()
+    {
+        auto scene = get_resource<SceneResource>(s_scene_data).get_scene();
+        if (scene->objects().empty())
+        {
+            throw nlog::make_exception("{}: Scene \"{}\" has no objects", name(), scene->name());
+        }
+
+        m_layout = DrawListLayout(*scene);
+        const auto& draw_list = get_resource<BufferResource>(s_draw_list).get_buffer();
+
+        // Set i culls against the depth written in the frame before frame i
+        const auto& r_depth = get_resource<ImageResource>(s_depth);
+        std::vector<std::shared_ptr<nvk::Image>> depth_images;
+        for (uint32_t i = 0; i < m_context->m_frames; i++)
+        {
+            depth_images.push_back(r_depth.get_image(i + static_cast<uint32_t>(r_depth.images().size()) - 1));
+        }
+        m_culler = std::make_unique<OcclusionCuller>(name(), depth_images, draw_list, m_layout, m_context);
+
+        // Draw commands of both phases with no instances, the first instance of a batch is fixed per phase
+        const auto& geometry = scene->shared_geometry();
+        const auto& batches = scene->instance_batches();
+        std::vector<vk::DrawIndexedIndirectCommand> commands;
+        for (uint32_t phase = 0; phase < DrawListLayout::s_phases; phase++)
+        {
+            for (const auto& batch : batches)
+            {
+                const auto& range = geometry.range(*batch.mesh);
+                commands.emplace_back(range.index_count, 0, range.first_index, range.vertex_offset,
+                                      phase * m_layout.object_count + batch.first_instance);
+            }
+        }
+
+        std::vector<ns::ObjectPushConstant> object_data(m_layout.object_count);
+        std::vector<CullBounds> cull_bounds(m_layout.object_count);
+        for (uint32_t i = 0; i < m_layout.object_count; i++)
+        {
+            object_data[i] = scene->objects()[i].get_push_constants(scene->world(i));
+            cull_bounds[i] = make_cull_bounds(*scene, i);
+        }
+
+        // Every host copy starts complete, the first frame copies all of it
+        release_host_buffers();
+        for (uint32_t i = 0; i < m_context->m_frames; i++)
+        {
+            auto host_create_info = nvk::BufferCreateInfo()
+                .set_buffer_type(nvk::BufferType::eStaging)
+                .set_name(fmt::format("Hi-Z Culling Draw List #{}", i))
+                .set_size(m_layout.host_size());
+            m_host_buffer.push_back(std::make_shared<nvk::Buffer>(host_create_info, m_device));
+            m_host_mapped.push_back(static_cast<uint8_t*>(m_host_buffer.back()->map()));
+            std::memcpy(m_host_mapped.back() + m_layout.commands, commands.data(), sizeof(vk::DrawIndexedIndirectCommand) * commands.size());
+            std::memcpy(m_host_mapped.back() + m_layout.objects, object_data.data(), sizeof(ns::ObjectPushConstant) * object_data.size());
+            std::memcpy(m_host_mapped.back() + m_layout.bounds, cull_bounds.data(), sizeof(CullBounds) * cull_bounds.size());
+        }
+        m_transform_updates = scene->transforms().update_count();
+        m_copy_all = true;
+
+        m_render_extent = m_context->m_max_render_resolution.operator vk::Extent2D();
+        const auto camera = scene->active_camera()->uniform_data();
+        m_view_proj = camera.proj * camera.view;
+        m_active_extent = m_context->get_active_extent(m_render_extent);
+        m_frame_index = 0;
+    }
+
+    void HiZCulling::execute(const vk::CommandBuffer& command_buffer)
+    {
+        using enum vk::PipelineStageFlagBits2;
+        using enum vk::AccessFlagBits2;
+
+        // The draws & the second phase of the previous frame are done with the draw list
+        auto reuse_barrier = vk::MemoryBarrier2()
+            .setSrcStageMask(eDrawIndirect | eVertexShader | eComputeShader)
+            .setSrcAccessMask(eIndirectCommandRead | eShaderStorageRead | eShaderStorageWrite)
+            .setDstStageMask(eAllTransfer)
+            .setDstAccessMask(eTransferWrite);
+        command_buffer.pipelineBarrier2(vk::DependencyInfo().setMemoryBarriers(reuse_barrier));
+
+        const auto& draw_list = get_resource<BufferResource>(s_draw_list).get_buffer();
+        command_buffer.copyBuffer(m_host_buffer[m_current_frame]->buffer(), draw_list->buffer(), m_copy_regions);
+
+        auto copy_barrier = vk::MemoryBarrier2()
+            .setSrcStageMask(eAllTransfer)
+            .setSrcAccessMask(eTransferWrite)
+            .setDstStageMask(eComputeShader)
+            .setDstAccessMask(eShaderStorageRead | eShaderStorageWrite);
+        command_buffer.pipelineBarrier2(vk::DependencyInfo().setMemoryBarriers(copy_barrier));
+
+        // Without a previous frame every candidate is drawn in the first phase
+        const bool pyramid_valid = m_frame_index > 0;
+        if (pyramid_valid)
+        {
+            m_culler->build_pyramid(command_buffer, m_current_frame, m_active_extent_previous);
+        }
+        m_culler->cull(command_buffer, m_current_frame, m_view_proj_previous, 0, pyramid_valid);
+        OcclusionCuller::barrier_to_draw(command_buffer);
+
+        m_frame_index++;
+    }
+
+    void HiZCulling::update()
+    {
+        const auto& scene = get_resource<SceneResource>(s_scene_data).ref_scene();
+        const auto& visible = scene.visible_objects();
+
+        m_view_proj_previous = m_view_proj;
+        m_active_extent_previous = m_active_extent;
+
+        const auto camera = scene.active_camera()->uniform_data();
+        m_view_proj = camera.proj * camera.view;
+        m_active_extent = m_context->get_active_extent(m_render_extent);
+
+        // Commands with zeroed instance counts & the candidates of the frame
+        auto* mapped = m_host_mapped[m_current_frame];
+        const auto candidate_count = static_cast<uint32_t>(visible.size());
+        std::memcpy(mapped + m_layout.candidates, &candidate_count, sizeof(uint32_t));
+        std::memcpy(mapped + m_layout.candidates + sizeof(uint32_t), visible.data(), sizeof(uint32_t) * visible.size());
+
+        // Every object after a missed scene update (the node was disabled), otherwise only the moved ones
+        const auto& transforms = scene.transforms();
+        m_copy_all |= (transforms.update_count() > m_transform_updates + 1);
+        m_transform_updates = transforms.update_count();
+
+        m_changed.clear();
+        if (m_copy_all)
+        {
+            for (uint32_t i = 0; i < m_layout.object_count; i++) m_changed.push_back(i);
+            m_copy_all = false;
+        }
+        else
+        {
+            m_changed.assign(transforms.changed().begin(), transforms.changed().end());
+            std::ranges::sort(m_changed);
+        }
+
+        // Regions in ascending order, runs of adjacent objects are copied together
+        m_copy_regions.clear();
+        const auto add_region = [&](const vk::DeviceSize offset, const vk::DeviceSize size) {
+            if (!m_copy_regions.empty() && m_copy_regions.back().srcOffset + m_copy_regions.back().size == offset)
+            {
+                m_copy_regions.back().size += size;
+                return;
+            }
+            m_copy_regions.push_back(vk::BufferCopy(offset, offset, size));
+        };
+        add_region(m_layout.commands, m_layout.objects - m_layout.commands);
+
+        auto* objects = reinterpret_cast<ns::ObjectPushConstant*>(mapped + m_layout.objects);
+        for (const uint32_t object_idx : m_changed)
+        {
+            objects[object_idx] = scene.objects()[object_idx].get_push_constants(scene.world(object_idx));
+            add_region(m_layout.objects + object_idx * sizeof(ns::ObjectPushConstant), sizeof(ns::ObjectPushConstant));
+        }
+
+        auto* bounds = reinterpret_cast<CullBounds*>(mapped + m_layout.bounds);
+        for (const uint32_t object_idx : m_changed)
+        {
+            bounds[object_idx] = make_cull_bounds(scene, object_idx);
+            add_region(m_layout.bounds + object_idx * sizeof(CullBounds), sizeof(CullBounds));
+        }
+
+        add_region(m_layout.candidates, sizeof(uint32_t) * (1 + visible.size()));
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.hpp>
+#include <nrg/common/Context.hpp>
+#include <nrg/common/Node.hpp>
+#include <nrg/common/NodeTraits.hpp>
+#include <nrg/common/OcclusionCulling.hpp>
+#include <nrg/common/ResourceClaim.hpp>
+#include <nrg/resource/Requirement.hpp>
+#include <nvk/Buffer.hpp>
+#include <nvk/Device.hpp>
+
+namespace Nebula::nrg
+{
+    /**
+     * First phase of the two-phase occlusion culling, placed before the G-Buffer Pass.
+     * Builds a max-depth pyramid from the depth the G-Buffer wrote in the previous frame and tests the frustum culled
+     * objects against it with the previous camera, the survivors are compacted into the instanced indirect draws of
+     * the draw list. The G-Buffer draws them, rebuilds the pyramid from that depth and retests the rejected objects
+     * with the current camera to draw the newly visible ones in a second pass.
+     */
+    class HiZCulling : public Node
+    {
+    public:
+        explicit HiZCulling(const std::shared_ptr<Context>& context)
+        : Node("Hi-Z Culling", NodeType::eHiZCulling)
+        , m_context(context)
+        , m_device(context->m_device)
+        , m_current_frame(context->m_current_frame)
+        {
+        }
+
+        ~HiZCulling() override;
+
+        void initialize() override;
+
+        void execute(const vk::CommandBuffer& command_buffer) override;
+
+        void update() override;
+
+        vk::PipelineStageFlags2 shader_stages() const override { return vk::PipelineStageFlagBits2::eComputeShader; }
+
+    private:
+        // Bounds & batch of an object as of the last scene update
+        static CullBounds make_cull_bounds(const ns::Scene& scene, uint32_t object_idx);
+
+        void release_host_buffers();
+
+        std::shared_ptr<Context>                    m_context;
+        std::shared_ptr<nvk::Device>                m_device;
+        uint32_t&                                   m_current_frame;
+
+        DrawListLayout                              m_layout;
+        std::unique_ptr<OcclusionCuller>            m_culler;
+
+        // Host part of the draw list per frame in flight, persistently mapped. The draw list keeps the objects & bounds
+        // across frames, only the commands, the candidates & the objects moved since the last update are copied into it
+        std::vector<std::shared_ptr<nvk::Buffer>>   m_host_buffer;
+        std::vector<uint8_t*>                       m_host_mapped;
+        std::vector<uint32_t>                       m_changed;
+        std::vector<vk::BufferCopy>                 m_copy_regions;
+        uint64_t                                    m_transform_updates {0};
+        bool                                        m_copy_all {true};
+
+        // Camera & active extent the depth of the previous frame was rendered with
+        glm::mat4                                   m_view_proj {1.0f};
+        glm::mat4                                   m_view_proj_previous {1.0f};
+        vk::Extent2D                                m_render_extent {};
+        vk::Extent2D                                m_active_extent {};
+        vk::Extent2D                                m_active_extent_previous {};
+        uint32_t                                    m_frame_index {0};
+
+        static constexpr const char* s_scene_data = "Scene Data";
+        static constexpr const char* s_depth      = "Depth Buffer";
+        static constexpr const char* s_draw_list  = "Draw List";
+
+        nrg_decl_resource_requirements();
+        nrg_def_get_resource_claims();
+    };
+}
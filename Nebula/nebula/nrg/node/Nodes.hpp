@@ -2,7 +2,13 @@
 
 #include "AmbientOcclusion.hpp"
 #include "AntiAliasing.hpp"
+#include "Bloom.hpp"
 #include "DeferredLighting.hpp"
 #include "GBuffer.hpp"
+#include "HiZCulling.hpp"
+#include "PostProcess.hpp"
 #include "Present.hpp"
 #include "SceneDataProvider.hpp"
+#include "ShadowMapGeneration.hpp"
+#include "ToneMapping.hpp"
+#include "VisibilityBuffer.hpp"
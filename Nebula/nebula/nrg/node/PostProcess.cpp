@@ -0,0 +1,89 @@
+#include "PostProcess.hpp"
+#include <fmt/format.h>
+#include <nlog/nlog.hpp>
+#include <nrg/common/ResourceTraits.hpp>
+
+namespace Nebula::nrg
+{
+    nrg_def_resource_requirements(PostProcess, ({
+        std::make_shared<ImageRequirement>(s_input, ResourceUsage::eInput, ResourceType::eImage, vk::ImageLayout::eShaderReadOnlyOptimal, vk::Format::eR32G32B32A32Sfloat),
+        in_place(relative_extent(std::make_shared<ImageRequirement>(s_output, ResourceUsage::eOutput, ResourceType::eImage, vk::ImageLayout::eGeneral, vk::Format::eR32G32B32A32Sfloat),
+                                 1.0f, ResolutionReference::eTargetResolution), s_input),
+    }));
+
+    namespace
+    {
+        std::string fmt_stages(const std::vector<PostStage>& stages)
+        {
+            std::string result;
+            for (const auto& stage : stages)
+            {
+                result += result.empty() ? to_string(stage.op) : fmt::format(" + {}", to_string(stage.op));
+            }
+            return result;
+        }
+    }
+
+    PostProcess::PostProcess(std::vector<PostStage> stages, const std::shared_ptr<Context>& context)
+    : PostProcess(fmt::format("Post-Process ({})", fmt_stages(stages)), NodeType::ePostProcess, std::move(stages), context)
+    {
+    }
+
+    PostProcess::PostProcess(const std::string& name, const NodeType node_type, std::vector<PostStage> stages,
+                             const std::shared_ptr<Context>& context)
+    : ComputeNode(name, node_type, context)
+    , m_stages(std::move(stages))
+    {
+        if (m_stages.empty() || m_stages.size() > s_max_stages)
+        {
+            throw nlog::make_exception("PostProcess supports 1 to {} stages, {} were given", s_max_stages, m_stages.size());
+        }
+    }
+
+    void PostProcess::initialize()
+    {
+        m_input_extent = get_image_extent(s_input);
+        m_output_extent = get_image_extent(s_output);
+
+        // A resampling first stage stands in for the upscaler, the input is at render resolution
+        if (m_stages.front().op == PostOp::eResample)
+        {
+            m_context->m_upscaling_enabled = true;
+        }
+
+        auto pipeline_info = ComputePipelineInfo()
+            .set_shader("nrg_post_process.comp.spv")
+            .add_sampled_image(0, s_input)
+            .add_storage_image(1, s_output)
+            .set_push_constant_size(sizeof(PushConstant))
+            .add_specialization_constant(0, static_cast<uint32_t>(m_stages.size()));
+
+        for (uint32_t i = 0; i < s_max_stages; i++)
+        {
+            const auto op = (i < m_stages.size()) ? m_stages[i].op : PostOp::eNone;
+            pipeline_info.add_specialization_constant(i + 1, static_cast<uint32_t>(op));
+        }
+        create_compute_pipeline(pipeline_info);
+    }
+
+    void PostProcess::execute(const vk::CommandBuffer& command_buffer)
+    {
+        // Only a render resolution input is partially rendered under dynamic resolution
+        const auto input_extent = (m_stages.front().op == PostOp::eResample) ? m_context->get_active_extent(m_input_extent) : m_input_extent;
+
+        PushConstant push_constant {
+            .extent = glm::ivec4(input_extent.width, input_extent.height, m_output_extent.width, m_output_extent.height),
+        };
+        for (size_t i = 0; i < m_stages.size(); i++)
+        {
+            const auto& p = m_stages[i].params;
+            push_constant.params[i] = { p[0], p[1], p[2], p[3] };
+        }
+
+        dispatch(command_buffer, m_output_extent, push_constant);
+    }
+
+    void PostProcess::update()
+    {
+    }
+}
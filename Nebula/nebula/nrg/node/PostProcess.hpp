@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.hpp>
+#include <nrg/common/ComputeNode.hpp>
+#include <nrg/common/Context.hpp>
+#include <nrg/common/NodeTraits.hpp>
+#include <nrg/common/PostStage.hpp>
+#include <nrg/common/ResourceClaim.hpp>
+#include <nrg/resource/Requirement.hpp>
+
+namespace Nebula::nrg
+{
+    /**
+     * Uber compute pass running a chain of per-pixel post-processing stages on a single input.
+     * The operations are baked in with specialization constants, only their parameters are pushed per frame.
+     * Created by the compiler in place of fused post-processing nodes, single stage nodes derive from it.
+     */
+    class PostProcess : public ComputeNode
+    {
+    public:
+        static constexpr uint32_t s_max_stages = 4;
+
+        struct PushConstant
+        {
+            glm::ivec4                           extent;  // [ Active Input Width, Active Input Height, Output Width, Output Height ]
+            std::array<glm::vec4, s_max_stages>  params;
+        };
+
+        PostProcess(std::vector<PostStage> stages, const std::shared_ptr<Context>& context);
+
+        ~PostProcess() override = default;
+
+        void initialize() override;
+
+        void execute(const vk::CommandBuffer& command_buffer) override;
+
+        void update() override;
+
+        const std::vector<PostStage>& stages() const { return m_stages; }
+
+        static constexpr const char* s_input      = "Input";
+        static constexpr const char* s_output     = "Output";
+
+    protected:
+        PostProcess(const std::string& name, NodeType node_type, std::vector<PostStage> stages, const std::shared_ptr<Context>& context);
+
+        const std::vector<PostStage>                m_stages;
+        vk::Extent2D                                m_input_extent {};
+        vk::Extent2D                                m_output_extent {};
+
+        nrg_decl_resource_requirements();
+        nrg_def_get_resource_claims();
+    };
+}
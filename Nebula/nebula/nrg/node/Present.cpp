@@ -45,11 +45,13 @@ namespace Nebula::nrg
             .set_name("Present");
         m_pipeline = std::make_shared<nvk::Pipeline>(pipeline_create_info, m_device);
 
-        const auto& input = get_resource<ImageResource>(s_input).get_image();
-        vk::DescriptorImageInfo input_info = { input->default_sampler(), input->image_view(), vk::ImageLayout::eShaderReadOnlyOptimal };
-
+        // History inputs alternate between frames, each set samples the image of its frame
+        const auto& r_input = get_resource<ImageResource>(s_input);
         for (int32_t i = 0; i < m_context->m_frames; i++)
         {
+            const auto& input = r_input.get_image(i);
+            vk::DescriptorImageInfo input_info = { input->default_sampler(), input->image_view(), vk::ImageLayout::eShaderReadOnlyOptimal };
+
             auto write_info = nvk::DescriptorWriteInfo()
                 .set_set_index(i)
                 .add_combined_image_sampler(0, input_info);
@@ -61,6 +63,9 @@ namespace Nebula::nrg
     {
         m_render_pass->execute(command_buffer, m_framebuffers->get(m_current_frame), [&](const vk::CommandBuffer& cmd) {
             m_pipeline->bind(cmd);
+            const auto extent = m_swapchain->extent();
+            cmd.setViewport(0, vk::Viewport(0.0f, 0.0f, static_cast<float>(extent.width), static_cast<float>(extent.height), 0.0f, 1.0f));
+            cmd.setScissor(0, vk::Rect2D({0, 0}, extent));
             cmd.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, m_pipeline->layout(), 0, 1, &m_descriptor->set(m_current_frame), 0, nullptr);
             cmd.draw(3, 1, 0, 0);
         });
@@ -0,0 +1,386 @@
+#include "ShadowMapGeneration.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <glm/gtc/matrix_transform.hpp>
+#include <nrg/common/ResourceTraits.hpp>
+#include <nrg/resource/Resources.hpp>
+#include <nscene/Vertex.hpp>
+
+namespace Nebula::nrg
+{
+    nrg_def_resource_requirements(ShadowMapGeneration, ({
+        std::make_shared<ImageRequirement>(s_position, ResourceUsage::eInput, ResourceType::eImage, vk::ImageLayout::eShaderReadOnlyOptimal, vk::Format::eR32G32B32A32Sfloat),
+        std::make_shared<ImageRequirement>(s_normal, ResourceUsage::eInput, ResourceType::eImage, vk::ImageLayout::eShaderReadOnlyOptimal, vk::Format::eR32G32B32A32Sfloat),
+        std::make_shared<Requirement>(s_scene_data, ResourceUsage::eInput, ResourceType::eSceneData),
+        std::make_shared<ImageRequirement>(s_output, ResourceUsage::eOutput, ResourceType::eImage, vk::ImageLayout::eGeneral, vk::Format::eR32Sfloat),
+    }));
+
+    namespace
+    {
+        // FNV-1a, only used to detect changes between frames
+        void hash_bytes(uint64_t& hash, const void* data, const size_t size)
+        {
+            const auto* bytes = static_cast<const uint8_t*>(data);
+            for (size_t i = 0; i < size; i++)
+            {
+                hash ^= bytes[i];
+                hash *= 0x100000001b3ull;
+            }
+        }
+    }
+
+    ShadowMapGeneration::ShadowMapGeneration(const std::shared_ptr<Configuration>& configuration, const std::shared_ptr<Context>& context)
+    : ComputeNode("ShadowMapGeneration", NodeType::eShadowMapGeneration, context)
+    , m_configuration(*configuration)
+    {
+    }
+
+    void ShadowMapGeneration::initialize()
+    {
+        m_output_extent = get_image_extent(s_output);
+        create_cascades();
+
+        using SSFB = vk::ShaderStageFlagBits;
+
+        // 1. Depth-only rendering of the casters into each cascade, biased against acne
+        auto pipeline_create_info = nvk::PipelineCreateInfo()
+            .set_pipeline_type(nvk::PipelineType::eGraphics)
+            .add_push_constant({ SSFB::eVertex, 0, sizeof(PushConstant) })
+            .add_attribute_descriptions<ns::Vertex>()
+            .add_binding_description<ns::Vertex>()
+            .add_shader("nrg_shadow_map.vert.spv", SSFB::eVertex)
+            .set_attachment_count(0)
+            .set_sample_count(vk::SampleCountFlagBits::e1)
+            .set_render_pass(m_render_pass->render_pass())
+            .configure_state([](nvk::PipelineState& state) {
+                state.rasterization_state
+                    .setDepthBiasEnable(true)
+                    .setDepthBiasConstantFactor(1.25f)
+                    .setDepthBiasSlopeFactor(1.75f);
+            })
+            .set_name("ShadowMapGeneration");
+        m_pipeline = std::make_shared<nvk::Pipeline>(pipeline_create_info, m_device);
+
+        m_uniform_buffer.resize(m_context->m_frames);
+        for (uint32_t i = 0; i < m_context->m_frames; i++)
+        {
+            nvk::BufferCreateInfo buf_create_info{};
+            buf_create_info
+                .set_buffer_type(nvk::BufferType::eUniform)
+                .set_name(fmt::format("ShadowMapGeneration Uniform #{}", i))
+                .set_size(sizeof(Uniform));
+            m_uniform_buffer[i] = std::make_shared<nvk::Buffer>(buf_create_info, m_device);
+        }
+
+        // Slots past the cascade count are never sampled, they alias the first cascade
+        std::vector<std::shared_ptr<nvk::Image>> cascade_depths;
+        for (uint32_t i = 0; i < s_max_cascades; i++)
+        {
+            cascade_depths.push_back(m_cascades[i < m_cascades.size() ? i : 0].depth);
+        }
+
+        // 2. Cascade selection & PCF into a screen space shadow mask
+        auto resolve_info = ComputePipelineInfo()
+            .set_shader("nrg_shadow_resolve.comp.spv")
+            .add_uniform_buffer(0, m_uniform_buffer)
+            .add_sampled_image(1, s_position)
+            .add_sampled_image(2, s_normal)
+            .add_sampled_images(3, cascade_depths)
+            .add_storage_image(4, s_output)
+            .set_push_constant_size(sizeof(ResolvePushConstant))
+            .set_group_size(s_group_size, s_group_size);
+        m_resolve_pipeline = create_compute_pipeline(resolve_info);
+
+        m_frame_index = 0;
+    }
+
+    void ShadowMapGeneration::create_cascades()
+    {
+        const auto cascade_count = static_cast<uint32_t>(std::clamp(m_configuration.cascade_count, 1, static_cast<int>(s_max_cascades)));
+        const auto resolution = static_cast<uint32_t>(m_configuration.resolution);
+        m_shadow_extent = vk::Extent2D { resolution, resolution };
+
+        m_cascades.clear();
+        m_cascades.resize(cascade_count);
+        for (uint32_t i = 0; i < cascade_count; i++)
+        {
+            using enum vk::ImageUsageFlagBits;
+            auto image_info = nvk::ImageCreateInfo()
+                .set_aspect_flags(vk::ImageAspectFlagBits::eDepth)
+                .set_extent(m_shadow_extent)
+                .set_format(vk::Format::eD32Sfloat)
+                .set_memory_property_flags(vk::MemoryPropertyFlagBits::eDeviceLocal)
+                .set_name(fmt::format("ShadowMapGeneration Cascade #{}", i))
+                .set_usage_flags(eSampled | eDepthStencilAttachment)
+                .set_tiling(vk::ImageTiling::eOptimal)
+                .set_with_sampler(true);
+            m_cascades[i].depth = nvk::Image::create(image_info, m_device);
+        }
+
+        // A cascade is always rendered in full, its previous contents are never needed
+        auto render_pass_create_info = nvk::RenderPassCreateInfo()
+            .set_depth_attachment(m_cascades[0].depth, {1.0f, 0}, vk::AttachmentLoadOp::eClear, vk::AttachmentStoreOp::eStore,
+                                  vk::ImageLayout::eUndefined, vk::ImageLayout::eShaderReadOnlyOptimal)
+            .set_name("ShadowMapGeneration RenderPass")
+            .set_render_area({{0, 0}, m_shadow_extent});
+        m_render_pass = std::make_shared<nvk::RenderPass>(render_pass_create_info, m_device);
+
+        auto framebuffer_create_info = nvk::FramebufferCreateInfo()
+            .set_framebuffer_count(cascade_count)
+            .set_render_pass(m_render_pass->render_pass())
+            .set_extent(m_shadow_extent)
+            .set_name("ShadowMapGeneration Framebuffer");
+        for (uint32_t i = 0; i < cascade_count; i++)
+        {
+            framebuffer_create_info.add_attachment(m_cascades[i].depth->image_view(), 0, i);
+        }
+        m_framebuffers = std::make_shared<nvk::Framebuffer>(framebuffer_create_info, m_device);
+    }
+
+    void ShadowMapGeneration::fit_cascades(const ns::Scene& scene)
+    {
+        const auto camera = scene.active_camera()->uniform_data();
+        const auto& objects = scene.objects();
+
+        // World space bounds of the objects, meshes without bounds can't be culled
+        const auto& object_bounds = scene.object_bounds();
+
+        // The scene only has point lights, the first one is treated as a directional light towards the origin.
+        // Aiming at the scene bounds instead would invalidate every cached cascade whenever any object moves.
+        const auto& lights = scene.lights();
+        glm::vec3 to_light = lights.empty() ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(lights[0].position);
+        to_light = (glm::length(to_light) > 1e-4f) ? glm::normalize(to_light) : glm::vec3(0.0f, 1.0f, 0.0f);
+
+        const glm::vec3 up = (std::abs(to_light.y) > 0.99f) ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+        const glm::mat4 light_view = glm::lookAt(glm::vec3(0.0f), -to_light, up);
+
+        // Practical split scheme, blending logarithmic and uniform splits
+        const float near = camera.near_plane;
+        const float far = std::max(near + 1.0f, std::min(camera.far_plane, m_configuration.max_distance));
+        const auto cascade_count = static_cast<uint32_t>(m_cascades.size());
+        for (uint32_t i = 0; i < cascade_count; i++)
+        {
+            const float p = static_cast<float>(i + 1) / static_cast<float>(cascade_count);
+            const float log_split = near * std::pow(far / near, p);
+            const float uniform_split = near + (far - near) * p;
+            m_splits[i] = m_configuration.split_lambda * log_split + (1.0f - m_configuration.split_lambda) * uniform_split;
+        }
+
+        const float tan_x = 1.0f / std::abs(camera.proj[0][0]);
+        const float tan_y = 1.0f / std::abs(camera.proj[1][1]);
+        const float resolution = static_cast<float>(m_shadow_extent.width);
+
+        for (uint32_t i = 0; i < cascade_count; i++)
+        {
+            auto& cascade = m_cascades[i];
+            cascade.cached = m_configuration.cache_far_cascades && static_cast<int>(i) >= m_configuration.first_cached_cascade;
+
+            // Bounding sphere of the frustum slice, rotation invariant so the cascade doesn't change size as the camera turns
+            const float slice_near = (i == 0) ? near : m_splits[i - 1];
+            const float slice_far = m_splits[i];
+            std::array<glm::vec3, 8> corners;
+            for (uint32_t c = 0; c < 8; c++)
+            {
+                const float d = (c & 4) ? slice_far : slice_near;
+                const float sx = (c & 1) ? 1.0f : -1.0f;
+                const float sy = (c & 2) ? 1.0f : -1.0f;
+                corners[c] = glm::vec3(camera.view_inverse * glm::vec4(sx * d * tan_x, sy * d * tan_y, -d, 1.0f));
+            }
+
+            glm::vec3 slice_center(0.0f);
+            for (const auto& corner : corners) slice_center += corner / 8.0f;
+
+            float slice_radius = 0.0f;
+            for (const auto& corner : corners) slice_radius = std::max(slice_radius, glm::length(corner - slice_center));
+            slice_radius = std::ceil(slice_radius * 16.0f) / 16.0f;
+
+            const glm::vec3 slice_center_ls = glm::vec3(light_view * glm::vec4(slice_center, 1.0f));
+
+            // Cached cascades keep their center while the slice stays inside the enlarged sphere
+            const float radius = cascade.cached ? slice_radius * s_cache_margin : slice_radius;
+            glm::vec3 center_ls = slice_center_ls;
+            if (cascade.cached && cascade.valid && cascade.rendered.radius == radius
+                && glm::length(slice_center_ls - cascade.rendered.center) + slice_radius <= radius)
+            {
+                center_ls = cascade.rendered.center;
+            }
+            else
+            {
+                // Moving in whole texels keeps the edges of the shadows from shimmering
+                const float texel = 2.0f * radius / resolution;
+                center_ls.x = std::floor(center_ls.x / texel) * texel;
+                center_ls.y = std::floor(center_ls.y / texel) * texel;
+            }
+
+            // Cull casters outside the cascade in light space X/Y, the rest extends the depth range towards the light
+            cascade.casters.clear();
+            uint64_t caster_hash = 0xcbf29ce484222325ull;
+            float z_max = center_ls.z + radius;
+            float z_min = center_ls.z - radius;
+            for (uint32_t o = 0; o < objects.size(); o++)
+            {
+                if (object_bounds[o].is_valid())
+                {
+                    const auto bounds_ls = object_bounds[o].transform(light_view);
+                    if (bounds_ls.max.x < center_ls.x - radius || bounds_ls.min.x > center_ls.x + radius ||
+                        bounds_ls.max.y < center_ls.y - radius || bounds_ls.min.y > center_ls.y + radius)
+                    {
+                        continue;
+                    }
+                    z_max = std::max(z_max, bounds_ls.max.z);
+                    z_min = std::min(z_min, bounds_ls.min.z);
+                }
+                cascade.casters.push_back(o);
+                hash_bytes(caster_hash, &o, sizeof(o));
+                hash_bytes(caster_hash, &scene.world(o), sizeof(glm::mat4));
+            }
+
+            // Light space looks down -Z, near & far are distances along it
+            const glm::mat4 light_proj = glm::orthoRH_ZO(center_ls.x - radius, center_ls.x + radius,
+                                                         center_ls.y - radius, center_ls.y + radius,
+                                                         -z_max - 1.0f, -z_min + 1.0f);
+
+            cascade.desired = CascadeFit {
+                .view_proj   = light_proj * light_view,
+                .center      = center_ls,
+                .radius      = radius,
+                .caster_hash = caster_hash,
+            };
+        }
+    }
+
+    void ShadowMapGeneration::schedule_cascades()
+    {
+        m_scheduled.clear();
+
+        // Cascades that were never rendered and the first cascade are not subject to the budget
+        std::vector<uint32_t> candidates;
+        for (uint32_t i = 0; i < m_cascades.size(); i++)
+        {
+            const auto& cascade = m_cascades[i];
+            const bool dirty = !cascade.valid
+                || cascade.desired.view_proj != cascade.rendered.view_proj
+                || cascade.desired.caster_hash != cascade.rendered.caster_hash;
+            if (!dirty) continue;
+
+            if (!cascade.valid || i == 0)
+            {
+                m_scheduled.push_back(i);
+            }
+            else
+            {
+                candidates.push_back(i);
+            }
+        }
+
+        // Oldest first, near cascades that can't be updated keep their previous fit & matrix
+        std::stable_sort(candidates.begin(), candidates.end(), [&](const uint32_t a, const uint32_t b) {
+            return m_cascades[a].last_update < m_cascades[b].last_update;
+        });
+
+        const size_t budget = (m_configuration.max_cascade_updates > 0)
+            ? static_cast<size_t>(m_configuration.max_cascade_updates)
+            : std::numeric_limits<size_t>::max();
+        for (const uint32_t i : candidates)
+        {
+            if (m_scheduled.size() >= budget) break;
+            m_scheduled.push_back(i);
+        }
+
+        for (const uint32_t i : m_scheduled)
+        {
+            auto& cascade = m_cascades[i];
+            cascade.rendered = cascade.desired;
+            cascade.last_update = m_frame_index;
+            cascade.valid = true;
+        }
+    }
+
+    void ShadowMapGeneration::execute(const vk::CommandBuffer& command_buffer)
+    {
+        const auto& scene = get_resource<SceneResource>(s_scene_data).ref_scene();
+        const auto& objects = scene.objects();
+
+        for (const uint32_t idx : m_scheduled)
+        {
+            const auto& cascade = m_cascades[idx];
+            m_render_pass->execute(command_buffer, m_framebuffers->get(idx), [&](const vk::CommandBuffer& cmd) {
+                m_pipeline->bind(cmd);
+                cmd.setViewport(0, vk::Viewport(0.0f, 0.0f, static_cast<float>(m_shadow_extent.width), static_cast<float>(m_shadow_extent.height), 0.0f, 1.0f));
+                cmd.setScissor(0, vk::Rect2D({0, 0}, m_shadow_extent));
+                for (const uint32_t object_idx : cascade.casters)
+                {
+                    const auto& object = objects[object_idx];
+                    PushConstant push_constant { .light_mvp = cascade.rendered.view_proj * scene.world(object_idx) };
+                    cmd.pushConstants(m_pipeline->layout(), vk::ShaderStageFlagBits::eVertex, 0, sizeof(PushConstant), &push_constant);
+                    object.mesh->draw(cmd);
+                }
+            });
+        }
+
+        if (!m_scheduled.empty())
+        {
+            auto barrier = vk::MemoryBarrier2()
+                .setSrcStageMask(vk::PipelineStageFlagBits2::eLateFragmentTests)
+                .setSrcAccessMask(vk::AccessFlagBits2::eDepthStencilAttachmentWrite)
+                .setDstStageMask(vk::PipelineStageFlagBits2::eComputeShader)
+                .setDstAccessMask(vk::AccessFlagBits2::eShaderSampledRead);
+            command_buffer.pipelineBarrier2(vk::DependencyInfo().setMemoryBarriers(barrier));
+        }
+
+        const auto output_extent = m_context->get_active_extent(m_output_extent);
+        ResolvePushConstant push_constant { .extent = glm::ivec4(output_extent.width, output_extent.height, 0, 0) };
+
+        dispatch(command_buffer, output_extent, push_constant, m_resolve_pipeline);
+
+        m_frame_index++;
+    }
+
+    void ShadowMapGeneration::update()
+    {
+        const auto& scene = get_resource<SceneResource>(s_scene_data).ref_scene();
+
+        fit_cascades(scene);
+        schedule_cascades();
+
+        Uniform uniform_data {
+            .view   = scene.active_camera()->uniform_data().view,
+            .splits = glm::vec4(0.0f),
+            .params = { static_cast<float>(m_cascades.size()), 0.0005f, 1.5f, 0.0f },
+        };
+        for (uint32_t i = 0; i < s_max_cascades; i++)
+        {
+            const bool in_use = i < m_cascades.size();
+            uniform_data.light_view_proj[i] = in_use ? m_cascades[i].rendered.view_proj : glm::mat4(1.0f);
+            uniform_data.splits[i] = in_use ? m_splits[i] : 0.0f;
+            uniform_data.texel_size[i] = in_use ? 2.0f * m_cascades[i].rendered.radius / static_cast<float>(m_shadow_extent.width) : 0.0f;
+        }
+        m_uniform_buffer[m_current_frame]->set_data(&uniform_data);
+    }
+
+    void ShadowMapGeneration::Configuration::render()
+    {
+        ImGui::PushItemWidth(128);
+        {
+            ImGui::SliderInt("Cascades", &cascade_count, 1, static_cast<int>(s_max_cascades));
+            ImGui::SliderInt("Resolution", &resolution, 512, 4096);
+            ImGui::SliderFloat("Max Distance", &max_distance, 10.0f, 500.0f);
+            ImGui::SliderFloat("Split Lambda", &split_lambda, 0.0f, 1.0f);
+
+            ImGui::Checkbox("Cache Far Cascades", &cache_far_cascades);
+            if (cache_far_cascades)
+            {
+                ImGui::SliderInt("First Cached Cascade", &first_cached_cascade, 1, static_cast<int>(s_max_cascades) - 1);
+            }
+            ImGui::SliderInt("Updates per Frame", &max_cascade_updates, 0, static_cast<int>(s_max_cascades));
+        }
+        ImGui::PopItemWidth();
+    }
+
+    bool ShadowMapGeneration::Configuration::validate()
+    {
+        return cascade_count >= 1 && cascade_count <= static_cast<int>(s_max_cascades)
+            && resolution > 0 && max_distance > 0.0f && split_lambda >= 0.0f && split_lambda <= 1.0f;
+    }
+}
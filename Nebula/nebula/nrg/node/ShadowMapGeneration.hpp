@@ -0,0 +1,136 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.hpp>
+#include <nmath/AABB.hpp>
+#include <nrg/common/ComputeNode.hpp>
+#include <nrg/common/Context.hpp>
+#include <nrg/common/NodeConfiguration.hpp>
+#include <nrg/common/NodeTraits.hpp>
+#include <nrg/common/ResourceClaim.hpp>
+#include <nrg/resource/Requirement.hpp>
+#include <nscene/Camera.hpp>
+#include <nscene/Scene.hpp>
+#include <nvk/Buffer.hpp>
+#include <nvk/Device.hpp>
+#include <nvk/Image.hpp>
+#include <nvk/render/Framebuffer.hpp>
+#include <nvk/render/Pipeline.hpp>
+#include <nvk/render/RenderPass.hpp>
+
+namespace Nebula::nrg
+{
+    /**
+     * Cascaded shadow maps of the first light, resolved into a screen space shadow mask.
+     * Cascades from first_cached_cascade onwards are fit with a margin and only re-rendered when their
+     * light space fit or the transforms of their casters change, the rest is refreshed in rotation
+     * under max_cascade_updates, so the cost of a frame is bounded by the budget instead of the scene.
+     */
+    class ShadowMapGeneration : public ComputeNode
+    {
+        static constexpr uint32_t s_max_cascades = 4;
+
+        struct PushConstant
+        {
+            glm::mat4 light_mvp;
+        };
+
+        struct alignas(glm::vec4) Uniform
+        {
+            glm::mat4 view;
+            glm::mat4 light_view_proj[s_max_cascades];
+            glm::vec4 splits;      // Far view depth of each cascade
+            glm::vec4 texel_size;  // World space size of a shadow map texel of each cascade
+            glm::vec4 params;      // [ Cascade Count, Depth Bias, Normal Offset, - ]
+        };
+
+        struct ResolvePushConstant
+        {
+            glm::ivec4 extent;  // [ Active Width, Active Height, -, - ]
+        };
+
+        // Light space fit of a cascade
+        struct CascadeFit
+        {
+            glm::mat4 view_proj {1.0f};
+            glm::vec3 center {0.0f};    // Light space center of the bounding sphere, snapped to the texel grid
+            float     radius {0.0f};
+            uint64_t  caster_hash {0};  // Hash of the indices & model matrices of the culled casters
+        };
+
+        struct Cascade
+        {
+            std::shared_ptr<nvk::Image> depth;
+            CascadeFit                  rendered {};  // Fit the shadow map currently holds
+            CascadeFit                  desired {};   // Fit for this frame
+            std::vector<uint32_t>       casters;      // Object indices culled against the desired fit
+            uint64_t                    last_update {0};
+            bool                        valid {false};
+            bool                        cached {false};
+        };
+
+    public:
+        struct Configuration : public NodeConfiguration
+        {
+            int   cascade_count        {4};
+            int   resolution           {2048};
+            float max_distance         {100.0f};
+            float split_lambda         {0.75f};   // Blend between the logarithmic and uniform split scheme
+            bool  cache_far_cascades   {true};
+            int   first_cached_cascade {2};
+            int   max_cascade_updates  {2};       // Shadow maps rendered per frame, 0 for no limit
+
+            void render() override;
+            bool validate() override;
+            ~Configuration() override = default;
+        };
+
+        ShadowMapGeneration(const std::shared_ptr<Configuration>& configuration, const std::shared_ptr<Context>& context);
+
+        ~ShadowMapGeneration() override = default;
+
+        void initialize() override;
+
+        void execute(const vk::CommandBuffer& command_buffer) override;
+
+        void update() override;
+
+    private:
+        void create_cascades();
+
+        void fit_cascades(const ns::Scene& scene);
+
+        void schedule_cascades();
+
+        const Configuration                         m_configuration;
+
+        // Cascades are rendered into node images, graph images are only touched by the compute resolve
+        std::shared_ptr<nvk::RenderPass>            m_render_pass;
+        std::shared_ptr<nvk::Framebuffer>           m_framebuffers;
+        std::shared_ptr<nvk::Pipeline>              m_pipeline;
+        uint32_t                                    m_resolve_pipeline {0};
+        std::vector<std::shared_ptr<nvk::Buffer>>   m_uniform_buffer;
+
+        std::vector<Cascade>                        m_cascades;
+        std::vector<uint32_t>                       m_scheduled;     // Cascades rendered this frame
+        std::array<float, s_max_cascades>           m_splits {};
+        vk::Extent2D                                m_shadow_extent {};
+        vk::Extent2D                                m_output_extent {};
+        uint64_t                                    m_frame_index {0};
+
+        static constexpr uint32_t    s_group_size    = 8;
+        static constexpr float       s_cache_margin  = 1.25f;  // Radius scale of cached cascades, room for the camera to move
+
+        static constexpr const char* s_output        = "Shadow Mask";
+        static constexpr const char* s_position      = "Position Buffer";
+        static constexpr const char* s_normal        = "Normal Buffer";
+        static constexpr const char* s_scene_data    = "Scene Data";
+
+        nrg_decl_resource_requirements();
+        nrg_def_get_resource_claims();
+    };
+}
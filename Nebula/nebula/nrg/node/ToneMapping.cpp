@@ -0,0 +1,53 @@
+#include "ToneMapping.hpp"
+
+namespace Nebula::nrg
+{
+    ToneMapping::ToneMapping(const std::shared_ptr<Configuration>& configuration, const std::shared_ptr<Context>& context)
+    : PostProcess("Tone Mapping", NodeType::eToneMapping, { make_stage(*configuration) }, context)
+    {
+    }
+
+    std::optional<PostStage> ToneMapping::get_post_stage() const
+    {
+        return m_stages.front();
+    }
+
+    PostStage ToneMapping::make_stage(const Configuration& configuration)
+    {
+        return PostStage {
+            .op     = PostOp::eToneMapping,
+            .params = { configuration.exposure, static_cast<float>(configuration.tm_operator), configuration.white_point, 0.0f },
+            .input  = s_input,
+            .output = s_output,
+        };
+    }
+
+    void ToneMapping::Configuration::render()
+    {
+        ImGui::PushItemWidth(128);
+        {
+            if (ImGui::BeginCombo("Operator", to_string(tm_operator).c_str()))
+            {
+                for (const auto op : m_operators)
+                {
+                    const bool is_selected = (tm_operator == op);
+                    if (ImGui::Selectable(to_string(op).c_str(), is_selected))
+                        tm_operator = op;
+
+                    if (is_selected)
+                        ImGui::SetItemDefaultFocus();
+                }
+                ImGui::EndCombo();
+            }
+
+            ImGui::SliderFloat("Exposure", &exposure, -4.0f, 4.0f);
+            ImGui::SliderFloat("White Point", &white_point, 1.0f, 16.0f);
+        }
+        ImGui::PopItemWidth();
+    }
+
+    bool ToneMapping::Configuration::validate()
+    {
+        return white_point >= 1.0f;
+    }
+}
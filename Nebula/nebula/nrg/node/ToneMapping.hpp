@@ -0,0 +1,65 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include <nrg/common/Context.hpp>
+#include <nrg/common/NodeConfiguration.hpp>
+#include <nrg/common/PostStage.hpp>
+#include <nrg/node/PostProcess.hpp>
+
+namespace Nebula::nrg
+{
+    enum class ToneMappingOperator
+    {
+        eClamp,
+        eReinhard,
+        eACES,
+    };
+
+    inline std::string to_string(const ToneMappingOperator op)
+    {
+        using enum ToneMappingOperator;
+        switch (op)
+        {
+            case eClamp:    return "Clamp";
+            case eReinhard: return "Reinhard";
+            case eACES:     return "ACES";
+            default:        return "Unknown";
+        }
+    }
+
+    /**
+     * Exposure & tone curve, a single stage PostProcess pass.
+     * Directly fed by other per-pixel post-processing nodes it is fused with them by the compiler.
+     */
+    class ToneMapping : public PostProcess
+    {
+    public:
+        struct Configuration : public NodeConfiguration
+        {
+            ToneMappingOperator tm_operator {ToneMappingOperator::eACES};
+            float               exposure    {0.0f};   // EV
+            float               white_point {4.0f};   // Luminance mapped to white by Reinhard
+
+            void render() override;
+            bool validate() override;
+            ~Configuration() override = default;
+
+        private:
+            std::vector<ToneMappingOperator> m_operators = {
+                ToneMappingOperator::eClamp, ToneMappingOperator::eReinhard, ToneMappingOperator::eACES,
+            };
+        };
+
+        ToneMapping(const std::shared_ptr<Configuration>& configuration, const std::shared_ptr<Context>& context);
+
+        ~ToneMapping() override = default;
+
+        std::optional<PostStage> get_post_stage() const override;
+
+    private:
+        static PostStage make_stage(const Configuration& configuration);
+    };
+}
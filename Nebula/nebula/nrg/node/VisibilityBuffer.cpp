@@ -0,0 +1,248 @@
+#include "VisibilityBuffer.hpp"
+#include <bit>
+#include <nlog/nlog.hpp>
+#include <nrg/common/ResourceTraits.hpp>
+#include <nrg/resource/Resources.hpp>
+#include <nscene/Vertex.hpp>
+
+#ifdef NBL_DEBUG
+#include <fmt/printf.h>
+#endif
+
+namespace Nebula::nrg
+{
+    nrg_def_resource_requirements(VisibilityBuffer, ({
+        std::make_shared<Requirement>(s_scene_data, ResourceUsage::eInput, ResourceType::eSceneData),
+        scratch(std::make_shared<ImageRequirement>(s_visibility, ResourceUsage::eOutput, ResourceType::eImage, vk::ImageLayout::eGeneral, vk::Format::eR32Uint)),
+        std::make_shared<ImageRequirement>(s_position, ResourceUsage::eOutput, ResourceType::eImage, vk::ImageLayout::eGeneral, vk::Format::eR32G32B32A32Sfloat),
+        std::make_shared<ImageRequirement>(s_normal, ResourceUsage::eOutput, ResourceType::eImage, vk::ImageLayout::eGeneral, vk::Format::eR32G32B32A32Sfloat),
+        std::make_shared<ImageRequirement>(s_albedo, ResourceUsage::eOutput, ResourceType::eImage, vk::ImageLayout::eGeneral, vk::Format::eR32G32B32A32Sfloat),
+        std::make_shared<ImageRequirement>(s_depth, ResourceUsage::eOutput, ResourceType::eImage, vk::Format::eD32Sfloat),
+        std::make_shared<ImageRequirement>(s_motion_vec, ResourceUsage::eOutput, ResourceType::eImage, vk::ImageLayout::eGeneral, vk::Format::eR32G32B32A32Sfloat),
+    }))
+
+    void VisibilityBuffer::initialize()
+    {
+        m_render_extent = m_context->m_max_render_resolution.operator vk::Extent2D();
+
+        const auto& scene = get_resource<SceneResource>(s_scene_data).ref_scene();
+        const auto& objects = scene.objects();
+        if (objects.empty())
+        {
+            throw nlog::make_exception("{}: Scene \"{}\" has no objects", name(), scene.name());
+        }
+
+        // Object IDs are offset by one, zero is the cleared background. The rest of the bits address the triangles.
+        const auto object_bits = static_cast<uint32_t>(std::bit_width(objects.size()));
+        m_triangle_bits = 32 - object_bits;
+        for (const auto& object : objects)
+        {
+            if (const uint32_t triangle_count = object.mesh->index_count() / 3;
+                triangle_count > (1u << m_triangle_bits))
+            {
+                throw nlog::make_exception("{}: Mesh \"{}\" has {} triangles, only {} can be addressed next to {} objects",
+                                           name(), object.mesh->name(), triangle_count, 1u << m_triangle_bits, objects.size());
+            }
+        }
+
+        m_uniform_buffer.resize(m_context->m_frames);
+        m_object_buffer.resize(m_context->m_frames);
+        for (int32_t i = 0; i < m_context->m_frames; i++)
+        {
+            auto uniform_create_info = nvk::BufferCreateInfo()
+                .set_buffer_type(nvk::BufferType::eUniform)
+                .set_name(fmt::format("Visibility Buffer Uniform #{}", i))
+                .set_size(sizeof(CameraUniform));
+            m_uniform_buffer[i] = std::make_shared<nvk::Buffer>(uniform_create_info, m_device);
+
+            auto object_create_info = nvk::BufferCreateInfo()
+                .set_buffer_type(nvk::BufferType::eStorage)
+                .set_name(fmt::format("Visibility Buffer Objects #{}", i))
+                .set_size(sizeof(ns::ObjectPushConstant) * objects.size());
+            m_object_buffer[i] = std::make_shared<nvk::Buffer>(object_create_info, m_device);
+        }
+
+        create_raster_pass();
+        create_resolve_pass();
+
+        m_raster_timer = std::make_shared<GpuTimer>(m_device, m_context->m_frames, "Visibility Buffer Raster");
+        m_resolve_timer = std::make_shared<GpuTimer>(m_device, m_context->m_frames, "Visibility Buffer Resolve");
+
+        m_camera_previous_frame = scene.active_camera()->uniform_data();
+    }
+
+    void VisibilityBuffer::create_raster_pass()
+    {
+        auto visibility = get_resource<ImageResource>(s_visibility).get_image();
+        auto depth = get_resource<ImageResource>(s_depth).get_image();
+
+        using enum vk::ShaderStageFlagBits;
+
+        auto descriptor_create_info = nvk::DescriptorCreateInfo()
+            .add(nvk::DescriptorType::eUniformBuffer, 0, eVertex)
+            .set_count(m_context->m_frames)
+            .set_name("Visibility Buffer Raster");
+        m_raster_descriptor = std::make_shared<nvk::Descriptor>(descriptor_create_info, m_device);
+
+        // The IDs are only read by the resolve of this node, they are left in the general layout for it
+        const auto depth_info = get_attachment_info(s_depth);
+        auto render_pass_create_info = nvk::RenderPassCreateInfo()
+            .add_attachment(visibility, vk::ImageLayout::eGeneral, vk::ClearColorValue(std::array<uint32_t, 4>{ 0, 0, 0, 0 }),
+                            vk::AttachmentLoadOp::eClear, vk::AttachmentStoreOp::eStore, vk::ImageLayout::eUndefined)
+            .set_depth_attachment(depth, {1.0f, 0}, depth_info.load_op_or_clear(), depth_info.store_op,
+                                  depth_info.initial_layout, depth_info.final_layout)
+            .set_name("Visibility Buffer RenderPass")
+            .set_render_area({{0, 0}, m_render_extent});
+        m_render_pass = std::make_shared<nvk::RenderPass>(render_pass_create_info, m_device);
+
+        auto framebuffer_create_info = nvk::FramebufferCreateInfo()
+            .set_framebuffer_count(m_context->m_frames)
+            .set_render_pass(m_render_pass->render_pass())
+            .set_extent(m_render_extent)
+            .set_name("Visibility Buffer Framebuffer")
+            .add_attachment(visibility->image_view())
+            .add_attachment(depth->image_view());
+        m_framebuffers = std::make_shared<nvk::Framebuffer>(framebuffer_create_info, m_device);
+
+        auto pipeline_create_info = nvk::PipelineCreateInfo()
+            .set_pipeline_type(nvk::PipelineType::eGraphics)
+            .add_push_constant({ eVertex | eFragment, 0, sizeof(PushConstant) })
+            .add_descriptor_set_layout(m_raster_descriptor->layout())
+            .add_attribute_descriptions<ns::Vertex>()
+            .add_binding_description<ns::Vertex>()
+            .add_shader("nrg_visibility_buffer.vert.spv", eVertex)
+            .add_shader("nrg_visibility_buffer.frag.spv", eFragment)
+            .add_specialization_constant(eFragment, 0, m_triangle_bits)
+            .set_attachment_count(1)
+            .set_sample_count(vk::SampleCountFlagBits::e1)
+            .set_render_pass(m_render_pass->render_pass())
+            .set_name("Visibility Buffer Raster");
+        m_raster_pipeline = std::make_shared<nvk::Pipeline>(pipeline_create_info, m_device);
+
+        for (int32_t i = 0; i < m_context->m_frames; i++)
+        {
+            const vk::DescriptorBufferInfo uniform_info = { m_uniform_buffer[i]->buffer(), 0, sizeof(CameraUniform) };
+            auto write_info = nvk::DescriptorWriteInfo()
+                .set_set_index(i)
+                .add_uniform_buffer(0, uniform_info);
+            m_raster_descriptor->write(write_info);
+        }
+    }
+
+    void VisibilityBuffer::create_resolve_pass()
+    {
+        const auto& scene = get_resource<SceneResource>(s_scene_data).ref_scene();
+
+        auto pipeline_info = ComputePipelineInfo()
+            .set_shader("nrg_visibility_resolve.comp.spv")
+            .add_uniform_buffer(0, m_uniform_buffer)
+            .add_storage_buffer(1, m_object_buffer)
+            .add_storage_buffer(2, { scene.object_descriptions_buffer() })
+            .add_storage_image(3, s_visibility)
+            .add_storage_image(4, s_position)
+            .add_storage_image(5, s_normal)
+            .add_storage_image(6, s_albedo)
+            .add_storage_image(7, s_motion_vec)
+            .add_specialization_constant(0, m_triangle_bits)
+            .set_push_constant_size(sizeof(ResolvePushConstant))
+            .set_group_size(s_group_size, s_group_size);
+        m_resolve_pipeline = create_compute_pipeline(pipeline_info);
+    }
+
+    void VisibilityBuffer::read_timestamps(uint32_t slot)
+    {
+        // The slot was last used frames_in_flight frames ago, its results are available
+        const auto raster_ms = m_raster_timer->read(slot);
+        const auto resolve_ms = m_resolve_timer->read(slot);
+        if (!raster_ms.has_value() || !resolve_ms.has_value()) return;
+
+        m_raster_time_ms += raster_ms.value();
+        m_resolve_time_ms += resolve_ms.value();
+        m_gpu_time_samples++;
+
+        if (m_gpu_time_samples == s_report_every)
+        {
+            #ifdef NBL_DEBUG
+            fmt::println("VisibilityBuffer ({}x{}): raster {:.3f} ms | resolve {:.3f} ms", m_render_extent.width, m_render_extent.height,
+                         m_raster_time_ms / m_gpu_time_samples, m_resolve_time_ms / m_gpu_time_samples);
+            #endif
+
+            m_raster_time_ms = 0.0;
+            m_resolve_time_ms = 0.0;
+            m_gpu_time_samples = 0;
+        }
+    }
+
+    void VisibilityBuffer::execute(const vk::CommandBuffer& command_buffer)
+    {
+        const auto& scene = get_resource<SceneResource>(s_scene_data).ref_scene();
+        const auto& objects = scene.objects();
+        const auto active_extent = m_context->get_active_extent(m_render_extent);
+
+        const uint32_t slot = m_current_frame % m_context->m_frames;
+        read_timestamps(slot);
+
+        // 1. IDs & depth
+        m_raster_timer->begin(command_buffer, slot, vk::PipelineStageFlagBits2::eTopOfPipe);
+        m_render_pass->set_render_area({{0, 0}, active_extent});
+        m_render_pass->execute(command_buffer, m_framebuffers->get(m_current_frame), [&](const vk::CommandBuffer& cmd) {
+            m_raster_pipeline->bind(cmd);
+            cmd.setViewport(0, vk::Viewport(0.0f, 0.0f, static_cast<float>(active_extent.width), static_cast<float>(active_extent.height), 0.0f, 1.0f));
+            cmd.setScissor(0, vk::Rect2D({0, 0}, active_extent));
+            cmd.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, m_raster_pipeline->layout(), 0, 1, &m_raster_descriptor->set(m_current_frame), 0, nullptr);
+            for (uint32_t i = 0; i < objects.size(); i++)
+            {
+                using enum vk::ShaderStageFlagBits;
+                const PushConstant push_constant { scene.world(i), i };
+                cmd.pushConstants(m_raster_pipeline->layout(), eVertex | eFragment, 0, sizeof(PushConstant), &push_constant);
+                objects[i].mesh->draw(cmd);
+            }
+        });
+        m_raster_timer->end(command_buffer, slot, vk::PipelineStageFlagBits2::eAllGraphics);
+
+        // 2. Attribute resolve, waits for the IDs written by the render pass
+        auto barrier = vk::MemoryBarrier2()
+            .setSrcStageMask(vk::PipelineStageFlagBits2::eColorAttachmentOutput)
+            .setSrcAccessMask(vk::AccessFlagBits2::eColorAttachmentWrite)
+            .setDstStageMask(vk::PipelineStageFlagBits2::eComputeShader)
+            .setDstAccessMask(vk::AccessFlagBits2::eShaderStorageRead);
+        command_buffer.pipelineBarrier2(vk::DependencyInfo().setMemoryBarriers(barrier));
+
+        const ResolvePushConstant push_constant {
+            .extent = glm::ivec4(active_extent.width, active_extent.height, 0, 0),
+        };
+
+        m_resolve_timer->begin(command_buffer, slot, vk::PipelineStageFlagBits2::eComputeShader);
+        dispatch(command_buffer, active_extent, push_constant, m_resolve_pipeline);
+        m_resolve_timer->end(command_buffer, slot, vk::PipelineStageFlagBits2::eComputeShader);
+    }
+
+    void VisibilityBuffer::update()
+    {
+        const auto& scene = get_resource<SceneResource>(s_scene_data).ref_scene();
+        auto camera_data = scene.active_camera()->uniform_data();
+
+        // Same jitter sequence as the G-Buffer Pass, the resolve removes it when reconstructing the view rays
+        m_context->advance_jitter();
+        const auto active_extent = m_context->get_active_extent(m_render_extent);
+        const glm::vec2 jitter_ndc = 2.0f * m_context->m_jitter / glm::vec2(active_extent.width, active_extent.height);
+
+        CameraUniform uniform_data {
+            .current  = camera_data,
+            .previous = m_camera_previous_frame,
+            .jitter   = glm::vec4(jitter_ndc, 0.0f, 0.0f),
+        };
+        m_uniform_buffer[m_current_frame]->set_data(&uniform_data);
+
+        const auto& objects = scene.objects();
+        std::vector<ns::ObjectPushConstant> object_data;
+        object_data.reserve(objects.size());
+        for (uint32_t i = 0; i < objects.size(); i++)
+        {
+            object_data.push_back(objects[i].get_push_constants(scene.world(i)));
+        }
+        m_object_buffer[m_current_frame]->set_data(object_data.data());
+
+        m_camera_previous_frame = camera_data;
+    }
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.hpp>
+#include <nrg/common/ComputeNode.hpp>
+#include <nrg/common/Context.hpp>
+#include <nrg/common/GpuTimer.hpp>
+#include <nrg/common/NodeTraits.hpp>
+#include <nrg/common/ResourceClaim.hpp>
+#include <nrg/resource/Requirement.hpp>
+#include <nvk/Buffer.hpp>
+#include <nvk/Descriptor.hpp>
+#include <nvk/Device.hpp>
+#include <nvk/render/Framebuffer.hpp>
+#include <nvk/render/Pipeline.hpp>
+#include <nvk/render/RenderPass.hpp>
+
+namespace Nebula::nrg
+{
+    /**
+     * Alternative to the G-Buffer Pass with the same outputs.
+     * The raster pass only writes depth and a packed [ Object ID + 1 | Triangle ID ] per pixel, a compute pass then
+     * fetches the vertices of the triangle through the buffer addresses of the object descriptions and writes the
+     * position, normal, albedo & motion vectors. Attributes are only interpolated once per pixel, not per fragment.
+     */
+    class VisibilityBuffer : public ComputeNode
+    {
+        struct PushConstant
+        {
+            glm::mat4 model;
+            uint32_t  object_id;
+        };
+
+        struct ResolvePushConstant
+        {
+            glm::ivec4 extent;  // [ Width, Height, -, - ]
+        };
+
+        // Members start on 16 byte boundaries to match the std140 layout of the shader
+        struct alignas(glm::vec4) CameraUniform
+        {
+            alignas(16) ns::CameraData current;
+            alignas(16) ns::CameraData previous;
+            alignas(16) glm::vec4      jitter;  // [ Jitter X, Jitter Y ] in NDC
+        };
+
+    public:
+        explicit VisibilityBuffer(const std::shared_ptr<Context>& context)
+        : ComputeNode("Visibility Buffer Pass", NodeType::eVisibilityBuffer, context)
+        {
+        }
+
+        ~VisibilityBuffer() override = default;
+
+        void initialize() override;
+
+        void execute(const vk::CommandBuffer& command_buffer) override;
+
+        void update() override;
+
+        // Depth & IDs are rasterized, the attributes are resolved in compute
+        vk::PipelineStageFlags2 shader_stages() const override { return Node::shader_stages(); }
+
+    private:
+        void create_raster_pass();
+
+        void create_resolve_pass();
+
+        void read_timestamps(uint32_t slot);
+
+        std::shared_ptr<nvk::RenderPass>            m_render_pass;
+        std::shared_ptr<nvk::Framebuffer>           m_framebuffers;
+        std::shared_ptr<nvk::Pipeline>              m_raster_pipeline;
+        std::shared_ptr<nvk::Descriptor>            m_raster_descriptor;
+        uint32_t                                    m_resolve_pipeline {0};
+        std::vector<std::shared_ptr<nvk::Buffer>>   m_uniform_buffer;
+        std::vector<std::shared_ptr<nvk::Buffer>>   m_object_buffer;
+
+        ns::CameraData                              m_camera_previous_frame {};
+        vk::Extent2D                                m_render_extent {};
+        uint32_t                                    m_triangle_bits {0};
+
+        // GPU time of the raster pass & the attribute resolve, compared against the G-Buffer Pass
+        std::shared_ptr<GpuTimer>                   m_raster_timer;
+        std::shared_ptr<GpuTimer>                   m_resolve_timer;
+        double                                      m_raster_time_ms {0.0};
+        double                                      m_resolve_time_ms {0.0};
+        uint32_t                                    m_gpu_time_samples {0};
+
+        static constexpr uint32_t    s_group_size   = 8;
+        static constexpr uint32_t    s_report_every = 256;
+
+        static constexpr const char* s_scene_data = "Scene Data";
+        static constexpr const char* s_visibility = "Visibility Buffer";
+        static constexpr const char* s_position   = "Position Buffer";
+        static constexpr const char* s_normal     = "Normal Buffer";
+        static constexpr const char* s_albedo     = "Albedo Buffer";
+        static constexpr const char* s_depth      = "Depth Buffer";
+        static constexpr const char* s_motion_vec = "Motion Vectors";
+
+        nrg_decl_resource_requirements();
+        nrg_def_get_resource_claims();
+    };
+}
@@ -1,9 +1,19 @@
 #pragma once
 
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <memory>
 #include <string>
 #include <vulkan/vulkan.hpp>
+#include <nrg/common/NodeConfiguration.hpp>
 #include <nrg/common/ResourceTraits.hpp>
 
+namespace Nebula::ns
+{
+    class Scene;
+}
+
 namespace Nebula::nrg
 {
     struct Requirement
@@ -28,6 +38,12 @@ namespace Nebula::nrg
         virtual ~Requirement() = default;
     };
 
+    enum class ResolutionReference
+    {
+        eRenderResolution,
+        eTargetResolution,
+    };
+
     struct ImageRequirement : public Requirement
     {
         using enum vk::ImageUsageFlagBits;
@@ -38,6 +54,30 @@ namespace Nebula::nrg
         vk::ImageUsageFlags usage_flags {eTransferSrc | eSampled | eStorage};
         vk::ImageLayout     expected_layout {vk::ImageLayout::eColorAttachmentOptimal};
 
+        // If no fixed extent is set, the image is sized relative to the render or target resolution.
+        ResolutionReference resolution_reference {ResolutionReference::eRenderResolution};
+        float               resolution_scale {1.0f};
+
+        // Replaces resolution_scale with a value read from the node's configuration when the graph is compiled.
+        std::function<float(const NodeConfiguration&)> configured_scale {};
+
+        // Name of an input of the same node this output may be written into (read-modify-write).
+        // The optimizer only aliases the two if the input has no later readers and the format & extent match.
+        std::string         in_place_of {};
+
+        // Output can be rendered directly into the acquired swapchain image if it is only consumed by Present.
+        bool                presentable {false};
+
+        // Output is double-buffered across frames in flight, the version written in the previous frame stays readable.
+        bool                history {false};
+
+        // Input reads the version written in the previous frame, implies history on the connected output.
+        bool                previous_frame {false};
+
+        // Output is an intermediate of the node itself, it has no pin in the editor and no consumers.
+        // Its lifetime is the producer's usage point, so the optimizer can alias it with images of other nodes.
+        bool                scratch {false};
+
         ImageRequirement() = default;
 
         ImageRequirement(std::string _name, ResourceUsage _usage, ResourceType _type,
@@ -65,15 +105,166 @@ namespace Nebula::nrg
         , expected_layout(_expected_layout)
         {}
 
+        // Outputs expecting an attachment layout are rendered to by a render pass
+        bool is_attachment() const
+        {
+            using enum vk::ImageLayout;
+            return expected_layout == eColorAttachmentOptimal
+                || expected_layout == eDepthAttachmentOptimal
+                || expected_layout == eDepthStencilAttachmentOptimal;
+        }
+
+        // Pipeline stages touching the image in the expected layout, used for the barriers between nodes
+        vk::PipelineStageFlags2 stage_mask() const
+        {
+            using enum vk::PipelineStageFlagBits2;
+            switch (expected_layout)
+            {
+                case vk::ImageLayout::eColorAttachmentOptimal:
+                    return eColorAttachmentOutput;
+                case vk::ImageLayout::eDepthAttachmentOptimal:
+                case vk::ImageLayout::eDepthStencilAttachmentOptimal:
+                    return eEarlyFragmentTests | eLateFragmentTests;
+                case vk::ImageLayout::eShaderReadOnlyOptimal:
+                case vk::ImageLayout::eGeneral:
+                    return eFragmentShader | eComputeShader;
+                case vk::ImageLayout::eTransferSrcOptimal:
+                case vk::ImageLayout::eTransferDstOptimal:
+                    return eAllTransfer;
+                default:
+                    return eAllCommands;
+            }
+        }
+
+        vk::AccessFlags2 access_mask() const
+        {
+            using enum vk::AccessFlagBits2;
+            const bool write = (usage == ResourceUsage::eOutput);
+            const bool read  = !write || !in_place_of.empty();
+
+            vk::AccessFlags2 result {};
+            switch (expected_layout)
+            {
+                case vk::ImageLayout::eColorAttachmentOptimal:
+                    if (read)  result |= eColorAttachmentRead;
+                    if (write) result |= eColorAttachmentWrite;
+                    return result;
+                case vk::ImageLayout::eDepthAttachmentOptimal:
+                case vk::ImageLayout::eDepthStencilAttachmentOptimal:
+                    if (read)  result |= eDepthStencilAttachmentRead;
+                    if (write) result |= eDepthStencilAttachmentWrite;
+                    return result;
+                case vk::ImageLayout::eShaderReadOnlyOptimal:
+                    return eShaderSampledRead;
+                case vk::ImageLayout::eGeneral:
+                    if (read)  result |= eShaderStorageRead;
+                    if (write) result |= eShaderStorageWrite;
+                    return result;
+                case vk::ImageLayout::eTransferSrcOptimal:
+                    return eTransferRead;
+                case vk::ImageLayout::eTransferDstOptimal:
+                    return eTransferWrite;
+                default:
+                    return eMemoryRead | eMemoryWrite;
+            }
+        }
+
+        vk::Extent2D get_extent(const vk::Extent2D& render_resolution, const vk::Extent2D& target_resolution) const
+        {
+            if (extent.width != 0 && extent.height != 0)
+            {
+                return extent;
+            }
+
+            const auto& base = (resolution_reference == ResolutionReference::eTargetResolution) ? target_resolution : render_resolution;
+            return {
+                std::max(1u, static_cast<uint32_t>(std::ceil(static_cast<float>(base.width) * resolution_scale))),
+                std::max(1u, static_cast<uint32_t>(std::ceil(static_cast<float>(base.height) * resolution_scale))),
+            };
+        }
+
         ~ImageRequirement() override = default;
     };
 
+    /**
+     * Marks an output image requirement as capable of being executed in-place on the given input.
+     */
+    inline std::shared_ptr<ImageRequirement> in_place(std::shared_ptr<ImageRequirement> requirement, const std::string& input_name)
+    {
+        requirement->in_place_of = input_name;
+        return requirement;
+    }
+
+    /**
+     * Marks an output image requirement as capable of rendering directly into the swapchain image.
+     */
+    inline std::shared_ptr<ImageRequirement> presentable(std::shared_ptr<ImageRequirement> requirement)
+    {
+        requirement->presentable = true;
+        return requirement;
+    }
+
+    /**
+     * Sizes an image requirement as a fraction of the render or target resolution (e.g. 0.5 for half resolution).
+     */
+    inline std::shared_ptr<ImageRequirement> relative_extent(std::shared_ptr<ImageRequirement> requirement, float scale,
+                                                             ResolutionReference reference = ResolutionReference::eRenderResolution)
+    {
+        requirement->extent = vk::Extent2D(0, 0);
+        requirement->resolution_scale = scale;
+        requirement->resolution_reference = reference;
+        return requirement;
+    }
+
+    /**
+     * Sizes an image requirement relative to the render or target resolution by a scale the node's configuration picks
+     * (e.g. a half resolution toggle), evaluated when the graph is compiled.
+     */
+    inline std::shared_ptr<ImageRequirement> configured_extent(std::shared_ptr<ImageRequirement> requirement,
+                                                               std::function<float(const NodeConfiguration&)> scale,
+                                                               ResolutionReference reference = ResolutionReference::eRenderResolution)
+    {
+        requirement = relative_extent(std::move(requirement), 1.0f, reference);
+        requirement->configured_scale = std::move(scale);
+        return requirement;
+    }
+
+    /**
+     * Marks an output image requirement as a history resource, kept alive across frames.
+     */
+    inline std::shared_ptr<ImageRequirement> history(std::shared_ptr<ImageRequirement> requirement)
+    {
+        requirement->history = true;
+        return requirement;
+    }
+
+    /**
+     * Marks an input image requirement as reading the previous frame's version of the connected output.
+     */
+    inline std::shared_ptr<ImageRequirement> previous_frame(std::shared_ptr<ImageRequirement> requirement)
+    {
+        requirement->previous_frame = true;
+        return requirement;
+    }
+
+    /**
+     * Marks an output image requirement as an intermediate used only by the node declaring it.
+     */
+    inline std::shared_ptr<ImageRequirement> scratch(std::shared_ptr<ImageRequirement> requirement)
+    {
+        requirement->scratch = true;
+        return requirement;
+    }
+
     struct BufferRequirement : public Requirement
     {
         using enum vk::BufferUsageFlagBits;
 
         vk::BufferUsageFlags usage_flags {eStorageBuffer};
 
+        // Size of the buffer for the scene the graph is compiled for (e.g. per-object data)
+        std::function<vk::DeviceSize(const ns::Scene&)> size {};
+
         BufferRequirement() = default;
 
         BufferRequirement(std::string _name, ResourceUsage _usage, ResourceType _type,
@@ -82,4 +273,14 @@ namespace Nebula::nrg
 
         ~BufferRequirement() override = default;
     };
+
+    /**
+     * Sizes an output buffer requirement from the scene, evaluated when the resource is created.
+     */
+    inline std::shared_ptr<BufferRequirement> scene_sized(std::shared_ptr<BufferRequirement> requirement,
+                                                          std::function<vk::DeviceSize(const ns::Scene&)> size)
+    {
+        requirement->size = std::move(size);
+        return requirement;
+    }
 }
\ No newline at end of file
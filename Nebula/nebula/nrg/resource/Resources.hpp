@@ -1,5 +1,8 @@
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
+#include <vector>
 #include <nrg/resource/Resource.hpp>
 #include <nscene/Scene.hpp>
 #include <nvk/Buffer.hpp>
@@ -8,6 +11,46 @@
 namespace Nebula::nrg
 {
     nrg_decl_resource(BufferResource, ResourceType::eStorageBuffer, nvk::Buffer, buffer);
-    nrg_decl_resource(ImageResource,  ResourceType::eImage,         nvk::Image,  image);
     nrg_decl_resource(SceneResource,  ResourceType::eSceneData,     ns::Scene,   scene);
-}
\ No newline at end of file
+
+    /**
+     * Image resource, optionally double-buffered across frames in flight (history resource).
+     * For history resources get_image() returns the version of the current frame,
+     * get_previous_image() the one written in the previous frame.
+     */
+    class ImageResource final : public Resource
+    {
+    public:
+        explicit ImageResource(const std::shared_ptr<nvk::Image>& p_image, const std::string& name = "ImageResource")
+        : Resource(name, ResourceType::eImage), m_images({ p_image }) {}
+
+        ImageResource(const std::vector<std::shared_ptr<nvk::Image>>& images, const uint32_t& current_frame,
+                      const std::string& name = "ImageResource")
+        : Resource(name, ResourceType::eImage), m_images(images), m_current_frame(&current_frame) {}
+
+        ~ImageResource() override = default;
+
+        bool is_valid() override
+        {
+            return !m_images.empty() && std::ranges::none_of(m_images, [](const auto& image){ return image == nullptr; });
+        }
+
+        const std::shared_ptr<nvk::Image>& get_image() const noexcept { return get_image(current_frame()); }
+
+        const std::shared_ptr<nvk::Image>& get_image(uint32_t frame) const noexcept { return m_images[frame % m_images.size()]; }
+
+        const std::shared_ptr<nvk::Image>& get_previous_image() const noexcept { return get_image(current_frame() + static_cast<uint32_t>(m_images.size()) - 1); }
+
+        const nvk::Image& ref_image() const noexcept { return *get_image(); }
+
+        const std::vector<std::shared_ptr<nvk::Image>>& images() const noexcept { return m_images; }
+
+        bool is_history() const noexcept { return m_images.size() > 1; }
+
+    private:
+        uint32_t current_frame() const noexcept { return m_current_frame ? *m_current_frame : 0; }
+
+        std::vector<std::shared_ptr<nvk::Image>> m_images;
+        const uint32_t*                          m_current_frame {nullptr};
+    };
+}
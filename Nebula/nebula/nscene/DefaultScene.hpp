@@ -27,16 +27,28 @@ namespace Nebula::ns
             auto camera = std::make_shared<Camera>(m_camera_size, glm::vec3(5, 5, 0));
             m_cameras.push_back(camera);
 
-            // Cube and Sphere primitive meshes
+            // Cube and Sphere primitive meshes, uploaded together
+            nvk::UploadBatch upload_batch(m_device, m_command_pool);
+
             auto cube_mesh_create_info = MeshCreateInfo()
                 .set_p_geometry(new Cube())
-                .set_name("cube");
-            m_meshes["cube"] = std::make_shared<Mesh>(cube_mesh_create_info, m_device, m_command_pool);
+                .set_name("cube")
+                .set_occluder(true);
+            m_meshes["cube"] = std::make_shared<Mesh>(cube_mesh_create_info, m_device, upload_batch);
 
             auto sphere_mesh_create_info = MeshCreateInfo()
                 .set_p_geometry(new Sphere())
                 .set_name("sphere");
-            m_meshes["sphere"] = std::make_shared<Mesh>(sphere_mesh_create_info, m_device, m_command_pool);
+            m_meshes["sphere"] = std::make_shared<Mesh>(sphere_mesh_create_info, m_device, upload_batch);
+
+            upload_batch.submit();
+            if (m_device->is_raytracing_enabled())
+            {
+                for (const auto& [name, mesh] : m_meshes)
+                {
+                    mesh->create_blas(m_device, m_command_pool);
+                }
+            }
 
             // Default lights
             Light light {
@@ -49,12 +61,14 @@ namespace Nebula::ns
             plane.mesh = m_meshes["cube"];
             plane.name = fmt::format("Object {}", m_objects.size() + 1);
             plane.transform.scale = { 192.0f, 0.05f, 192.0f};
+            plane.occluder = true;
             m_objects.push_back(plane);
 
             Object plane1 {};
             plane1.mesh = m_meshes["cube"];
             plane1.name = fmt::format("Object {}", m_objects.size() + 1);
             plane1.transform.scale = { 192.0f, 0.05f, 192.0f};
+            plane1.occluder = true;
             plane1.transform.translate = { 96.0f, 32.0f, 0.0f };
             plane1.transform.euler.z = glm::pi<float>() / 2.0f;
             plane1.rt_hit_group = 0;
@@ -64,6 +78,7 @@ namespace Nebula::ns
             plane2.mesh = m_meshes["cube"];
             plane2.name = fmt::format("Object {}", m_objects.size() + 1);
             plane2.transform.scale = { 192.0f, 0.05f, 192.0f};
+            plane2.occluder = true;
             plane2.transform.translate = { 0.0f, 32.0f, -96.0f };
             plane2.transform.euler.x = glm::pi<float>() / 2.0f;
             plane2.rt_hit_group = 1;
@@ -73,6 +88,7 @@ namespace Nebula::ns
             plane3.mesh = m_meshes["cube"];
             plane3.name = fmt::format("Object {}", m_objects.size() + 1);
             plane3.transform.scale = { 192.0f, 0.05f, 192.0f};
+            plane3.occluder = true;
             plane3.transform.translate = { 0.0f, 32.0f, 96.0f };
             plane3.transform.euler.x = glm::pi<float>() / 2.0f;
             plane3.rt_hit_group = 1;
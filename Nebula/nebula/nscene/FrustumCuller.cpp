@@ -0,0 +1,221 @@
+#include "FrustumCuller.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <nlog/nlog.hpp>
+#include <ncommon/Measure.hpp>
+#include <nscene/Camera.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define NEBULA_CULL_SSE
+#include <emmintrin.h>
+#endif
+
+namespace Nebula::ns
+{
+    namespace
+    {
+        // Half extent of invalid bounds, far enough below zero to fail every plane test
+        constexpr float s_empty_extent = -1.0e30f;
+    }
+
+    void FrustumCuller::set_bounds(const std::span<const nmath::AABB> bounds)
+    {
+        resize(bounds.size());
+        for (size_t i = 0; i < bounds.size(); i++)
+        {
+            set(i, bounds[i]);
+        }
+    }
+
+    void FrustumCuller::update_bounds(const std::span<const uint32_t> indices, const std::span<const nmath::AABB> bounds)
+    {
+        if (bounds.size() != m_count)
+        {
+            throw nlog::make_exception("Tried to update the bounds of a FrustumCuller of {} boxes from {} boxes", m_count, bounds.size());
+        }
+
+        for (const uint32_t i : indices)
+        {
+            set(i, bounds[i]);
+        }
+    }
+
+    void FrustumCuller::resize(const size_t count)
+    {
+        // Padded to whole SIMD lanes, the padding is never reported as visible
+        const size_t padded = (count + s_lanes - 1) / s_lanes * s_lanes;
+        m_count = count;
+        for (auto* array : { &m_center_x, &m_center_y, &m_center_z })
+        {
+            array->assign(padded, 0.0f);
+        }
+        for (auto* array : { &m_extent_x, &m_extent_y, &m_extent_z })
+        {
+            array->assign(padded, s_empty_extent);
+        }
+    }
+
+    void FrustumCuller::set(const size_t i, const nmath::AABB& bounds)
+    {
+        if (!bounds.is_valid())
+        {
+            m_center_x[i] = m_center_y[i] = m_center_z[i] = 0.0f;
+            m_extent_x[i] = m_extent_y[i] = m_extent_z[i] = s_empty_extent;
+            return;
+        }
+
+        const glm::vec3 c = bounds.center();
+        const glm::vec3 e = bounds.half_extent();
+        m_center_x[i] = c.x; m_center_y[i] = c.y; m_center_z[i] = c.z;
+        m_extent_x[i] = e.x; m_extent_y[i] = e.y; m_extent_z[i] = e.z;
+    }
+
+    void FrustumCuller::cull(const nmath::Frustum& frustum, std::vector<uint32_t>& visible) const
+    {
+        visible.clear();
+
+        #ifdef NEBULA_CULL_SSE
+        // Plane components broadcast once, |n| for the projected extent
+        __m128 nx[6], ny[6], nz[6], nd[6], ax[6], ay[6], az[6];
+        for (size_t p = 0; p < 6; p++)
+        {
+            const auto& plane = frustum.planes[p];
+            nx[p] = _mm_set1_ps(plane.x);
+            ny[p] = _mm_set1_ps(plane.y);
+            nz[p] = _mm_set1_ps(plane.z);
+            nd[p] = _mm_set1_ps(plane.w);
+            ax[p] = _mm_set1_ps(std::abs(plane.x));
+            ay[p] = _mm_set1_ps(std::abs(plane.y));
+            az[p] = _mm_set1_ps(std::abs(plane.z));
+        }
+
+        const __m128 zero = _mm_setzero_ps();
+        for (size_t i = 0; i < m_count; i += s_lanes)
+        {
+            const __m128 cx = _mm_loadu_ps(&m_center_x[i]);
+            const __m128 cy = _mm_loadu_ps(&m_center_y[i]);
+            const __m128 cz = _mm_loadu_ps(&m_center_z[i]);
+            const __m128 ex = _mm_loadu_ps(&m_extent_x[i]);
+            const __m128 ey = _mm_loadu_ps(&m_extent_y[i]);
+            const __m128 ez = _mm_loadu_ps(&m_extent_z[i]);
+
+            // A box is outside if it is fully behind any plane: dot(n, c) + d + dot(|n|, e) < 0
+            __m128 outside = _mm_setzero_ps();
+            for (size_t p = 0; p < 6; p++)
+            {
+                __m128 distance = _mm_add_ps(_mm_mul_ps(nx[p], cx), nd[p]);
+                distance = _mm_add_ps(distance, _mm_mul_ps(ny[p], cy));
+                distance = _mm_add_ps(distance, _mm_mul_ps(nz[p], cz));
+                __m128 radius = _mm_mul_ps(ax[p], ex);
+                radius = _mm_add_ps(radius, _mm_mul_ps(ay[p], ey));
+                radius = _mm_add_ps(radius, _mm_mul_ps(az[p], ez));
+                outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, radius), zero));
+            }
+
+            int inside_mask = ~_mm_movemask_ps(outside) & 0xF;
+            while (inside_mask != 0)
+            {
+                const uint32_t lane = std::countr_zero(static_cast<uint32_t>(inside_mask));
+                if (i + lane < m_count)
+                {
+                    visible.push_back(static_cast<uint32_t>(i + lane));
+                }
+                inside_mask &= inside_mask - 1;
+            }
+        }
+        #else
+        cull_scalar(frustum, visible);
+        #endif
+    }
+
+    void FrustumCuller::cull_scalar(const nmath::Frustum& frustum, std::vector<uint32_t>& visible) const
+    {
+        visible.clear();
+        for (size_t i = 0; i < m_count; i++)
+        {
+            bool inside = true;
+            for (const auto& plane : frustum.planes)
+            {
+                const float distance = plane.x * m_center_x[i] + plane.y * m_center_y[i] + plane.z * m_center_z[i] + plane.w;
+                const float radius = std::abs(plane.x) * m_extent_x[i] + std::abs(plane.y) * m_extent_y[i] + std::abs(plane.z) * m_extent_z[i];
+                if (distance + radius < 0.0f)
+                {
+                    inside = false;
+                    break;
+                }
+            }
+
+            if (inside)
+            {
+                visible.push_back(static_cast<uint32_t>(i));
+            }
+        }
+    }
+
+    void benchmark_frustum_culling()
+    {
+        const Camera camera({ 1600, 900 }, glm::vec3(0.0f));
+        const auto camera_data = camera.uniform_data();
+        const auto frustum = nmath::Frustum::from_matrix(camera_data.proj * camera_data.view);
+
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+        std::uniform_real_distribution<float> size(0.5f, 4.0f);
+
+        for (const size_t count : { 10'000, 100'000, 1'000'000 })
+        {
+            std::vector<nmath::AABB> bounds(count);
+            for (auto& aabb : bounds)
+            {
+                const glm::vec3 center(position(rng), position(rng), position(rng));
+                const glm::vec3 extent(size(rng));
+                aabb = { center - extent, center + extent };
+            }
+
+            FrustumCuller culler;
+            culler.set_bounds(bounds);
+
+            constexpr int32_t iterations = 100;
+            std::vector<uint32_t> visible;
+            visible.reserve(count);
+
+            const auto simd_time = measure<std::chrono::microseconds>([&]{
+                for (int32_t i = 0; i < iterations; i++) culler.cull(frustum, visible);
+            });
+            const std::vector<uint32_t> simd_visible = visible;
+
+            const auto scalar_time = measure<std::chrono::microseconds>([&]{
+                for (int32_t i = 0; i < iterations; i++) culler.cull_scalar(frustum, visible);
+            });
+
+            // Both paths report the indices in ascending order, the lists have to match exactly
+            if (visible != simd_visible)
+            {
+                const auto [simd_it, scalar_it] = std::mismatch(simd_visible.begin(), simd_visible.end(), visible.begin(), visible.end());
+                std::cout << nlog::fmt_warning("Culling results differ: {} visible with SIMD, {} with the scalar path, first difference at position {}",
+                                               simd_visible.size(), visible.size(), std::distance(simd_visible.begin(), simd_it)) << std::endl;
+            }
+
+            // A frame where 1% of the objects moved: full repack vs. only the moved boxes
+            std::vector<uint32_t> moved;
+            for (uint32_t i = 0; i < count; i += 100) moved.push_back(i);
+
+            const auto set_time = measure<std::chrono::microseconds>([&]{
+                for (int32_t i = 0; i < iterations; i++) culler.set_bounds(bounds);
+            });
+            const auto update_time = measure<std::chrono::microseconds>([&]{
+                for (int32_t i = 0; i < iterations; i++) culler.update_bounds(moved, bounds);
+            });
+
+            std::cout << nlog::fmt_info("Frustum culling {:>7} boxes: {:>8.1f} us (scalar {:>8.1f} us), {} visible, "
+                                        "repack {:>8.1f} us (1% moved {:>6.1f} us)",
+                                        count, static_cast<double>(simd_time.count()) / iterations,
+                                        static_cast<double>(scalar_time.count()) / iterations, simd_visible.size(),
+                                        static_cast<double>(set_time.count()) / iterations,
+                                        static_cast<double>(update_time.count()) / iterations) << std::endl;
+        }
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+#include <nmath/AABB.hpp>
+#include <nmath/Frustum.hpp>
+
+namespace Nebula::ns
+{
+    /**
+     * World space bounds of every object as packed structure of arrays [ Center XYZ | Half Extent XYZ ],
+     * culled against a frustum four boxes at a time with SSE (scalar fallback on other targets).
+     */
+    class FrustumCuller
+    {
+    public:
+        void set_bounds(std::span<const nmath::AABB> bounds);
+
+        // Repacks only the listed boxes, bounds holds every box & must have the size of the last set_bounds
+        void update_bounds(std::span<const uint32_t> indices, std::span<const nmath::AABB> bounds);
+
+        // Indices of the boxes intersecting the frustum in ascending order, boxes of invalid bounds are culled
+        void cull(const nmath::Frustum& frustum, std::vector<uint32_t>& visible) const;
+
+        // Reference path without SIMD, same results as cull()
+        void cull_scalar(const nmath::Frustum& frustum, std::vector<uint32_t>& visible) const;
+
+        size_t size() const { return m_count; }
+
+        static constexpr uint32_t s_lanes = 4;
+
+    private:
+        void resize(size_t count);
+
+        void set(size_t i, const nmath::AABB& bounds);
+
+        size_t              m_count {0};
+        std::vector<float>  m_center_x;
+        std::vector<float>  m_center_y;
+        std::vector<float>  m_center_z;
+        std::vector<float>  m_extent_x;
+        std::vector<float>  m_extent_y;
+        std::vector<float>  m_extent_z;
+    };
+
+    // Prints the culling & repacking time at 10k, 100k & 1M boxes scattered around a camera
+    void benchmark_frustum_culling();
+}
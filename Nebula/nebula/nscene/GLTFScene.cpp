@@ -0,0 +1,432 @@
+#include "GLTFScene.hpp"
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <fmt/format.h>
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/gtx/euler_angles.hpp>
+#include <glm/gtx/matrix_decompose.hpp>
+#include <glm/gtx/quaternion.hpp>
+#include <nlog/nlog.hpp>
+#include <tiny_gltf.h>
+#include <ncommon/Measure.hpp>
+#include <ncommon/ThreadPool.hpp>
+#include <nscene/SceneCache.hpp>
+#include <nvk/UploadBatch.hpp>
+
+namespace Nebula::ns
+{
+    namespace
+    {
+        struct AccessorView
+        {
+            const uint8_t* data {nullptr};
+            size_t         stride {0};
+            size_t         count {0};
+            int            component_type {0};
+            int            type {0};
+
+            template <typename T>
+            T read(const size_t i) const
+            {
+                T value;
+                std::memcpy(&value, data + i * stride, sizeof(T));
+                return value;
+            }
+        };
+
+        AccessorView view_accessor(const tinygltf::Model& model, const int32_t accessor_idx)
+        {
+            const auto& accessor = model.accessors[accessor_idx];
+            if (accessor.bufferView < 0 || accessor.sparse.isSparse)
+            {
+                throw nlog::make_exception("Accessor {} has no buffer view or is sparse, which is not supported", accessor_idx);
+            }
+
+            const auto& buffer_view = model.bufferViews[accessor.bufferView];
+            const auto& buffer = model.buffers[buffer_view.buffer];
+            const int stride = accessor.ByteStride(buffer_view);
+            const size_t element_size = tinygltf::GetComponentSizeInBytes(accessor.componentType) * tinygltf::GetNumComponentsInType(accessor.type);
+            const size_t offset = buffer_view.byteOffset + accessor.byteOffset;
+
+            if (stride <= 0 || (accessor.count > 0 && offset + (accessor.count - 1) * stride + element_size > buffer.data.size()))
+            {
+                throw nlog::make_exception("Accessor {} is out of the bounds of buffer {}", accessor_idx, buffer_view.buffer);
+            }
+
+            return { buffer.data.data() + offset, static_cast<size_t>(stride), accessor.count, accessor.componentType, accessor.type };
+        }
+
+        struct DefaultView
+        {
+            glm::vec3 eye;
+            Light     light;
+        };
+
+        // Camera inside the bounds of the scene, with a light above it
+        DefaultView default_view(const nmath::AABB& bounds)
+        {
+            const glm::vec3 center = bounds.is_valid() ? bounds.center() : glm::vec3(0.0f);
+            const glm::vec3 extent = bounds.is_valid() ? bounds.half_extent() : glm::vec3(1.0f);
+            return {
+                .eye   = center + glm::vec3(extent.x * 0.5f, 0.0f, 0.0f),
+                .light = { .position = glm::vec4(center + glm::vec3(0.0f, extent.y * 2.0f, 0.0f), 1.0f), .color = glm::vec4(1.0f) },
+            };
+        }
+
+        // Textures aren't used by the renderer yet, their decode is skipped entirely
+        bool skip_image_decode(tinygltf::Image*, const int, std::string*, std::string*, int, int, const unsigned char*, int, void*)
+        {
+            return true;
+        }
+    }
+
+    GLTFScene::GLTFScene(const std::string& file_path,
+                         const glm::ivec2& camera_size,
+                         const std::shared_ptr<nvk::CommandPool>& command_pool,
+                         const std::shared_ptr<nvk::Device>& device,
+                         const uint32_t thread_count)
+    : Scene(camera_size, std::filesystem::path(file_path).stem().string(), command_pool, device)
+    , m_file_path(file_path)
+    , m_thread_count(std::max(thread_count, 1u))
+    {
+    }
+
+    void GLTFScene::scene_init()
+    {
+        ThreadPool thread_pool(m_thread_count);
+
+        // 1. Parse the file, external buffers are read here as well
+        std::shared_ptr<tinygltf::Model> model;
+        const auto parse_time = measure([&]{ model = parse(m_file_path); });
+
+        // 2. Decode every primitive into a Geometry in parallel
+        Content content;
+        const auto decode_time = measure([&]{ content = decode(*model, thread_pool); });
+
+        // 3. Buffers are allocated on this thread, all of their data goes up in one submission
+        std::vector<std::shared_ptr<Mesh>> meshes(content.primitives.size());
+        vk::DeviceSize upload_size = 0;
+        const auto upload_time = measure([&]{
+            nvk::UploadBatch upload_batch(m_device, m_command_pool);
+            for (size_t i = 0; i < content.primitives.size(); i++)
+            {
+                const auto& primitive = content.primitives[i];
+                if (!primitive.geometry) continue;
+
+                const MeshDataView data = { primitive.geometry->vertices(), primitive.geometry->indices() };
+                meshes[i] = std::make_shared<Mesh>(primitive.name, data, primitive.bounds, m_device, upload_batch);
+                if (!m_meshes.emplace(primitive.name, meshes[i]).second)
+                {
+                    throw nlog::make_exception("glTF scene {} has two primitives named {}", m_file_path, primitive.name);
+                }
+            }
+
+            upload_size = upload_batch.pending_size();
+            upload_batch.submit();
+
+            // Every mesh an object can reference gets a BLAS, skipped primitives have no mesh
+            if (m_device->is_raytracing_enabled())
+            {
+                for (const auto& mesh : meshes)
+                {
+                    if (mesh) mesh->create_blas(m_device, m_command_pool);
+                }
+            }
+        });
+
+        // 4. Objects, camera & light
+        for (const auto& instance : content.instances)
+        {
+            m_objects.push_back({
+                .mesh        = meshes[instance.primitive],
+                .name        = instance.name,
+                .solid_color = instance.color,
+                .transform   = instance.transform,
+            });
+        }
+
+        const auto view = default_view(content.bounds);
+        m_cameras.push_back(std::make_shared<Camera>(m_camera_size, view.eye));
+        m_lights.push_back(view.light);
+
+        std::cout << nlog::fmt_info("Loaded glTF scene {} with {} meshes & {} objects in {} ms "
+                                    "(Parse: {} ms, Decode: {} ms on {} threads, Upload: {} ms for {:.2f} MiB)",
+                                    m_file_path, m_meshes.size(), m_objects.size(),
+                                    (parse_time + decode_time + upload_time).count(), parse_time.count(),
+                                    decode_time.count(), thread_pool.size(), upload_time.count(),
+                                    static_cast<double>(upload_size) / (1024.0 * 1024.0)) << std::endl;
+    }
+
+    void GLTFScene::bake(const std::string& file_path, const std::string& cache_path, const uint32_t thread_count)
+    {
+        ThreadPool thread_pool(std::max(thread_count, 1u));
+        const auto model = parse(file_path);
+        const auto content = decode(*model, thread_pool);
+
+        SceneCacheWriter writer;
+        std::vector<uint32_t> mesh_indices(content.primitives.size(), 0);
+        for (size_t i = 0; i < content.primitives.size(); i++)
+        {
+            const auto& primitive = content.primitives[i];
+            if (!primitive.geometry) continue;
+            mesh_indices[i] = writer.add_mesh(primitive.name, *primitive.geometry, primitive.bounds);
+        }
+
+        for (const auto& instance : content.instances)
+        {
+            writer.add_object(mesh_indices[instance.primitive], instance.name, instance.transform, instance.color);
+        }
+
+        const auto view = default_view(content.bounds);
+        writer.set_camera_eye(view.eye);
+        writer.add_light(view.light);
+        writer.write(cache_path);
+
+        std::cout << nlog::fmt_info("Baked glTF scene {} into {}", file_path, cache_path) << std::endl;
+    }
+
+    std::shared_ptr<tinygltf::Model> GLTFScene::parse(const std::string& file_path)
+    {
+        auto model = std::make_shared<tinygltf::Model>();
+
+        tinygltf::TinyGLTF loader;
+        loader.SetImageLoader(skip_image_decode, nullptr);
+
+        std::string error, warning;
+        const bool is_binary = std::filesystem::path(file_path).extension() == ".glb";
+        const bool loaded = is_binary ? loader.LoadBinaryFromFile(model.get(), &error, &warning, file_path)
+                                      : loader.LoadASCIIFromFile(model.get(), &error, &warning, file_path);
+        if (!warning.empty())
+        {
+            std::cout << nlog::fmt_warning("{}: {}", file_path, warning) << std::endl;
+        }
+        if (!loaded)
+        {
+            throw nlog::make_exception("Failed to load glTF scene {}: {}", file_path, error);
+        }
+
+        return model;
+    }
+
+    GLTFScene::Content GLTFScene::decode(const tinygltf::Model& model, ThreadPool& thread_pool)
+    {
+        Content content;
+        std::vector<std::vector<size_t>> primitive_indices(model.meshes.size());
+        for (int32_t i = 0; i < static_cast<int32_t>(model.meshes.size()); i++)
+        {
+            const auto& gltf_mesh = model.meshes[i];
+            const auto mesh_name = gltf_mesh.name.empty() ? fmt::format("Mesh {}", i) : gltf_mesh.name;
+            for (int32_t j = 0; j < static_cast<int32_t>(gltf_mesh.primitives.size()); j++)
+            {
+                primitive_indices[i].push_back(content.primitives.size());
+                // glTF mesh names don't have to be unique, the mesh index keeps the primitive names apart
+                content.primitives.push_back({ .mesh = i, .primitive = j, .name = fmt::format("{} #{}.{}", mesh_name, i, j) });
+            }
+        }
+
+        thread_pool.parallel_for(content.primitives.size(), [&](const size_t i){
+            decode_primitive(model, content.primitives[i]);
+        });
+
+        for (const auto& primitive : content.primitives)
+        {
+            if (!primitive.geometry)
+            {
+                std::cout << nlog::fmt_warning("Skipped glTF primitive {}: {}", primitive.name, primitive.skip_reason) << std::endl;
+            }
+        }
+
+        const int32_t scene_idx = std::max(model.defaultScene, 0);
+        if (scene_idx < static_cast<int32_t>(model.scenes.size()))
+        {
+            for (const int32_t node_idx : model.scenes[scene_idx].nodes)
+            {
+                collect_instances(model, node_idx, glm::mat4(1.0f), primitive_indices, content.instances);
+            }
+        }
+
+        // Instances of skipped primitives are dropped
+        std::erase_if(content.instances, [&](const Instance& instance){ return !content.primitives[instance.primitive].geometry; });
+
+        for (const auto& instance : content.instances)
+        {
+            content.bounds.expand(content.primitives[instance.primitive].bounds.transform(instance.transform.model()));
+        }
+
+        return content;
+    }
+
+    void GLTFScene::decode_primitive(const tinygltf::Model& model, Primitive& primitive)
+    {
+        const auto& gltf_primitive = model.meshes[primitive.mesh].primitives[primitive.primitive];
+        if (gltf_primitive.mode != TINYGLTF_MODE_TRIANGLES && gltf_primitive.mode != -1)
+        {
+            primitive.skip_reason = fmt::format("Primitive mode {} is not a triangle list", gltf_primitive.mode);
+            return;
+        }
+
+        const auto& attributes = gltf_primitive.attributes;
+        if (!attributes.contains("POSITION"))
+        {
+            primitive.skip_reason = "Primitive has no positions";
+            return;
+        }
+
+        const auto positions = view_accessor(model, attributes.at("POSITION"));
+        if (positions.component_type != TINYGLTF_COMPONENT_TYPE_FLOAT || positions.type != TINYGLTF_TYPE_VEC3)
+        {
+            primitive.skip_reason = "Positions are not vec3 floats";
+            return;
+        }
+
+        std::vector<Vertex> vertices(positions.count);
+        for (size_t i = 0; i < positions.count; i++)
+        {
+            vertices[i] = { .position = positions.read<glm::vec3>(i), .normal = glm::vec3(0.0f), .uv = glm::vec2(0.0f) };
+        }
+
+        bool has_normals = false;
+        if (attributes.contains("NORMAL"))
+        {
+            const auto normals = view_accessor(model, attributes.at("NORMAL"));
+            has_normals = (normals.component_type == TINYGLTF_COMPONENT_TYPE_FLOAT && normals.type == TINYGLTF_TYPE_VEC3);
+            for (size_t i = 0; has_normals && i < std::min(normals.count, vertices.size()); i++)
+            {
+                vertices[i].normal = normals.read<glm::vec3>(i);
+            }
+        }
+
+        // Quantized texture coordinates are left at zero
+        if (attributes.contains("TEXCOORD_0"))
+        {
+            const auto uvs = view_accessor(model, attributes.at("TEXCOORD_0"));
+            if (uvs.component_type == TINYGLTF_COMPONENT_TYPE_FLOAT && uvs.type == TINYGLTF_TYPE_VEC2)
+            {
+                for (size_t i = 0; i < std::min(uvs.count, vertices.size()); i++)
+                {
+                    vertices[i].uv = uvs.read<glm::vec2>(i);
+                }
+            }
+        }
+
+        std::vector<uint32_t> indices;
+        if (gltf_primitive.indices >= 0)
+        {
+            const auto index_view = view_accessor(model, gltf_primitive.indices);
+            indices.resize(index_view.count);
+            for (size_t i = 0; i < index_view.count; i++)
+            {
+                switch (index_view.component_type)
+                {
+                    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:  indices[i] = index_view.read<uint8_t>(i);  break;
+                    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT: indices[i] = index_view.read<uint16_t>(i); break;
+                    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:   indices[i] = index_view.read<uint32_t>(i); break;
+                    default:
+                        throw nlog::make_exception("Unsupported index component type {}", index_view.component_type);
+                }
+            }
+        }
+        else
+        {
+            indices.resize(vertices.size());
+            for (uint32_t i = 0; i < static_cast<uint32_t>(indices.size()); i++) indices[i] = i;
+        }
+
+        indices.resize(indices.size() - indices.size() % 3);
+        for (const uint32_t index : indices)
+        {
+            if (index >= vertices.size())
+            {
+                throw nlog::make_exception("Index {} is out of range for {} vertices", index, vertices.size());
+            }
+        }
+
+        // Area weighted vertex normals from the faces
+        if (!has_normals)
+        {
+            for (size_t i = 0; i < indices.size(); i += 3)
+            {
+                auto& v0 = vertices[indices[i + 0]];
+                auto& v1 = vertices[indices[i + 1]];
+                auto& v2 = vertices[indices[i + 2]];
+                const glm::vec3 face_normal = glm::cross(v1.position - v0.position, v2.position - v0.position);
+                v0.normal += face_normal;
+                v1.normal += face_normal;
+                v2.normal += face_normal;
+            }
+            for (auto& vertex : vertices)
+            {
+                const float length = glm::length(vertex.normal);
+                vertex.normal = (length > 0.0f) ? vertex.normal / length : glm::vec3(0.0f, 1.0f, 0.0f);
+            }
+        }
+
+        for (const auto& vertex : vertices)
+        {
+            primitive.bounds.expand(vertex.position);
+        }
+
+        primitive.geometry = std::make_unique<Geometry>(std::move(vertices), std::move(indices));
+    }
+
+    void GLTFScene::collect_instances(const tinygltf::Model& model, const int32_t node_idx, const glm::mat4& parent,
+                                      const std::vector<std::vector<size_t>>& primitive_indices,
+                                      std::vector<Instance>& instances)
+    {
+        const auto& node = model.nodes[node_idx];
+
+        glm::mat4 local(1.0f);
+        if (node.matrix.size() == 16)
+        {
+            local = glm::mat4(glm::make_mat4(node.matrix.data()));
+        }
+        else
+        {
+            const glm::vec3 translation = (node.translation.size() == 3) ? glm::vec3(glm::make_vec3(node.translation.data())) : glm::vec3(0.0f);
+            const glm::quat rotation = (node.rotation.size() == 4)
+                ? glm::quat(static_cast<float>(node.rotation[3]), static_cast<float>(node.rotation[0]),
+                            static_cast<float>(node.rotation[1]), static_cast<float>(node.rotation[2]))
+                : glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+            const glm::vec3 scale = (node.scale.size() == 3) ? glm::vec3(glm::make_vec3(node.scale.data())) : glm::vec3(1.0f);
+            local = glm::translate(glm::mat4(1.0f), translation) * glm::mat4_cast(rotation) * glm::scale(glm::mat4(1.0f), scale);
+        }
+        const glm::mat4 world = parent * local;
+
+        if (node.mesh >= 0)
+        {
+            // Transforms are stored as translation, euler angles & scale, shear from parents is dropped
+            glm::vec3 scale, translation, skew;
+            glm::quat rotation;
+            glm::vec4 perspective;
+            glm::decompose(world, scale, rotation, translation, skew, perspective);
+
+            nmath::Transform transform { .translate = translation, .scale = scale };
+            glm::extractEulerAngleYXZ(glm::mat4_cast(rotation), transform.euler.y, transform.euler.x, transform.euler.z);
+
+            const auto& gltf_mesh = model.meshes[node.mesh];
+            const auto node_name = node.name.empty() ? fmt::format("Node {}", node_idx) : node.name;
+            for (size_t i = 0; i < gltf_mesh.primitives.size(); i++)
+            {
+                glm::vec4 color(1.0f);
+                if (const int32_t material = gltf_mesh.primitives[i].material; material >= 0)
+                {
+                    const auto& factor = model.materials[material].pbrMetallicRoughness.baseColorFactor;
+                    if (factor.size() == 4) color = glm::vec4(glm::make_vec4(factor.data()));
+                }
+
+                instances.push_back({
+                    .primitive = primitive_indices[node.mesh][i],
+                    .name      = fmt::format("{} ({})", node_name, i),
+                    .transform = transform,
+                    .color     = color,
+                });
+            }
+        }
+
+        for (const int32_t child : node.children)
+        {
+            collect_instances(model, child, world, primitive_indices, instances);
+        }
+    }
+}
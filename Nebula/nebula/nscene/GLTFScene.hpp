@@ -0,0 +1,88 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <glm/glm.hpp>
+#include <ncommon/ThreadPool.hpp>
+#include <nmath/AABB.hpp>
+#include <nmath/Transform.hpp>
+#include <nscene/Scene.hpp>
+#include <nscene/geometry/Geometry.hpp>
+#include <nscene/geometry/Mesh.hpp>
+
+namespace tinygltf
+{
+    class Model;
+}
+
+namespace Nebula::ns
+{
+    /**
+     * Scene loaded from a glTF 2.0 file, every triangle primitive becomes a Mesh and every node referencing it an Object.
+     * Primitives are decoded into Geometry on a thread pool, the vertex & index buffers are then created on the
+     * loading thread and uploaded in a single submission. Materials only contribute their base color factor.
+     */
+    class GLTFScene : public Scene
+    {
+    public:
+        GLTFScene(const std::string& file_path,
+                  const glm::ivec2& camera_size,
+                  const std::shared_ptr<nvk::CommandPool>& command_pool,
+                  const std::shared_ptr<nvk::Device>& device,
+                  uint32_t thread_count = std::max(std::thread::hardware_concurrency(), 1u));
+
+        ~GLTFScene() override = default;
+
+        // Offline: parses & decodes the file and writes it as a scene cache (see CachedScene), without a device
+        static void bake(const std::string& file_path, const std::string& cache_path,
+                         uint32_t thread_count = std::max(std::thread::hardware_concurrency(), 1u));
+
+    protected:
+        void scene_init() override;
+
+    private:
+        struct Primitive
+        {
+            int32_t                   mesh {0};
+            int32_t                   primitive {0};
+            std::string               name;
+            std::unique_ptr<Geometry> geometry;
+            nmath::AABB               bounds;
+            std::string               skip_reason;  // Set for primitives that are not triangle lists
+        };
+
+        // A primitive referenced by a node
+        struct Instance
+        {
+            size_t           primitive {0};
+            std::string      name;
+            nmath::Transform transform;
+            glm::vec4        color {1.0f};
+        };
+
+        struct Content
+        {
+            std::vector<Primitive> primitives;
+            std::vector<Instance>  instances;
+            nmath::AABB            bounds;
+        };
+
+        static std::shared_ptr<tinygltf::Model> parse(const std::string& file_path);
+
+        // Decodes the primitives in parallel & collects the instances of the default scene
+        static Content decode(const tinygltf::Model& model, ThreadPool& thread_pool);
+
+        static void decode_primitive(const tinygltf::Model& model, Primitive& primitive);
+
+        static void collect_instances(const tinygltf::Model& model, int32_t node_idx, const glm::mat4& parent,
+                                      const std::vector<std::vector<size_t>>& primitive_indices,
+                                      std::vector<Instance>& instances);
+
+        std::string m_file_path;
+        uint32_t    m_thread_count;
+    };
+}
@@ -1,11 +0,0 @@
-#pragma once
-
-#include <nscene/Scene.hpp>
-
-namespace Nebula::ns
-{
-    class GLTFScene : public Scene
-    {
-
-    };
-}
\ No newline at end of file
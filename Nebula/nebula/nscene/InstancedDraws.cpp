@@ -0,0 +1,118 @@
+#include "InstancedDraws.hpp"
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <nlog/nlog.hpp>
+#include <ncommon/Measure.hpp>
+
+namespace Nebula::ns
+{
+    void build_instanced_draws(const std::span<const uint32_t> visible,
+                               const std::span<const uint32_t> batch_of_object,
+                               const std::span<const MeshRange> batch_ranges,
+                               std::vector<uint32_t>& batch_first,
+                               std::vector<vk::DrawIndexedIndirectCommand>& commands,
+                               std::vector<uint32_t>& instance_objects)
+    {
+        batch_first.assign(batch_ranges.size() + 1, 0);
+        for (const uint32_t object_idx : visible)
+        {
+            batch_first[batch_of_object[object_idx] + 1]++;
+        }
+
+        commands.clear();
+        for (uint32_t i = 0; i < batch_ranges.size(); i++)
+        {
+            const uint32_t instance_count = batch_first[i + 1];
+            batch_first[i + 1] += batch_first[i];
+            if (instance_count == 0) continue;
+
+            const auto& range = batch_ranges[i];
+            commands.emplace_back(range.index_count, instance_count, range.first_index, range.vertex_offset, batch_first[i]);
+        }
+
+        instance_objects.resize(visible.size());
+        for (const uint32_t object_idx : visible)
+        {
+            instance_objects[batch_first[batch_of_object[object_idx]]++] = object_idx;
+        }
+    }
+
+    void benchmark_instancing()
+    {
+        struct Case
+        {
+            const char* name;
+            uint32_t    object_count;
+            uint32_t    mesh_count;
+            float       visible_fraction;
+        };
+
+        // The DefaultScene draws 1028 boxes of a single cube mesh, Sponza has a mesh per primitive
+        constexpr Case cases[] = {
+            { "DefaultScene",         1028,    1,   1.0f },
+            { "DefaultScene 30%",     1028,    1,   0.3f },
+            { "Sponza",               103,     103, 1.0f },
+            { "10k over 100 meshes",  10'000,  100, 0.5f },
+            { "100k over 100 meshes", 100'000, 100, 0.5f },
+        };
+
+        for (const auto& c : cases)
+        {
+            std::mt19937 rng(7);
+            std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+
+            // Every mesh has an object, the rest are spread randomly
+            std::vector<MeshRange> batch_ranges(c.mesh_count);
+            for (uint32_t i = 0; i < c.mesh_count; i++)
+            {
+                batch_ranges[i] = { .first_index = i * 36, .vertex_offset = static_cast<int32_t>(i * 24), .index_count = 36 };
+            }
+            std::vector<uint32_t> batch_of_object(c.object_count);
+            for (uint32_t i = 0; i < c.object_count; i++)
+            {
+                batch_of_object[i] = (i < c.mesh_count) ? i : rng() % c.mesh_count;
+            }
+            std::vector<uint32_t> visible;
+            for (uint32_t i = 0; i < c.object_count; i++)
+            {
+                if (chance(rng) < c.visible_fraction) visible.push_back(i);
+            }
+
+            constexpr int32_t iterations = 1000;
+            std::vector<uint32_t> batch_first;
+            std::vector<vk::DrawIndexedIndirectCommand> commands;
+            std::vector<uint32_t> instance_objects;
+
+            // One command per visible object, as before the objects were batched
+            const auto per_object_time = measure<std::chrono::microseconds>([&]{
+                for (int32_t i = 0; i < iterations; i++)
+                {
+                    commands.clear();
+                    instance_objects.clear();
+                    for (const uint32_t object_idx : visible)
+                    {
+                        const auto& range = batch_ranges[batch_of_object[object_idx]];
+                        commands.emplace_back(range.index_count, 1, range.first_index, range.vertex_offset,
+                                              static_cast<uint32_t>(instance_objects.size()));
+                        instance_objects.push_back(object_idx);
+                    }
+                }
+            });
+            const size_t per_object_draws = commands.size();
+
+            const auto instanced_time = measure<std::chrono::microseconds>([&]{
+                for (int32_t i = 0; i < iterations; i++)
+                {
+                    build_instanced_draws(visible, batch_of_object, batch_ranges, batch_first, commands, instance_objects);
+                }
+            });
+
+            std::cout << nlog::fmt_info("Instancing {:<20} {:>6} objects, {:>3} meshes, {:>6} visible: draws {:>6} -> {:>3}, "
+                                        "build {:>7.2f} us -> {:>7.2f} us",
+                                        c.name, c.object_count, c.mesh_count, visible.size(), per_object_draws, commands.size(),
+                                        static_cast<double>(per_object_time.count()) / iterations,
+                                        static_cast<double>(instanced_time.count()) / iterations) << std::endl;
+        }
+    }
+}
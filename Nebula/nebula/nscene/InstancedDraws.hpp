@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <nscene/SceneGeometry.hpp>
+
+namespace Nebula::ns
+{
+    /**
+     * Groups the visible objects by instance batch, every batch with visible objects becomes one instanced command.
+     * The object index of every instance is written in batch order, the first instance of a command points at the
+     * instances of its batch. batch_first is scratch space, kept by the caller to avoid reallocating every frame.
+     */
+    void build_instanced_draws(std::span<const uint32_t> visible,
+                               std::span<const uint32_t> batch_of_object,
+                               std::span<const MeshRange> batch_ranges,
+                               std::vector<uint32_t>& batch_first,
+                               std::vector<vk::DrawIndexedIndirectCommand>& commands,
+                               std::vector<uint32_t>& instance_objects);
+
+    // Prints the draw count & the time to build the draws with one command per object vs. one per instance batch
+    void benchmark_instancing();
+}
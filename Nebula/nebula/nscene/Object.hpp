@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 #include <glm/glm.hpp>
 #include <nmath/Transform.hpp>
@@ -28,7 +29,13 @@ namespace Nebula::ns
         std::string             name {"Unknown Object"};
         uint32_t                rt_hit_group {0};
         glm::vec4               solid_color {0.5f, 0.5f, 0.5f, 1.0f};
-        nmath::Transform        transform {};
+        nmath::Transform        transform {};  // Relative to the parent, changed through Scene::set_transform once initialized
+
+        // Drawn into the software occlusion buffer, only if the mesh was created as an occluder
+        bool                    occluder {false};
+
+        // Index of the object this one is placed relative to
+        std::optional<uint32_t> parent {};
 
         inline ObjectDescription get_description() const
         {
@@ -39,21 +46,21 @@ namespace Nebula::ns
             };
         }
 
-        inline ObjectPushConstant get_push_constants() const
+        inline ObjectPushConstant get_push_constants(const glm::mat4& world) const
         {
             return {
-                .model = transform.model(),
+                .model = world,
                 .solid_color = solid_color,
             };
         }
 
-        inline nvk::TLASInstanceInfo get_tlas_instance_info() const
+        inline nvk::TLASInstanceInfo get_tlas_instance_info(const vk::TransformMatrixKHR& world) const
         {
             return {
                 .blas_address = mesh->bottom_level_as()->address(),
                 .hit_group    = rt_hit_group,
                 .mask         = 0xff,
-                .transform    = transform.model3x4(),
+                .transform    = world,
             };
         }
     };
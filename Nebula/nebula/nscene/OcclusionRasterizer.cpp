@@ -0,0 +1,412 @@
+#include "OcclusionRasterizer.hpp"
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <random>
+#include <glm/gtc/matrix_transform.hpp>
+#include <nlog/nlog.hpp>
+#include <nmath/Frustum.hpp>
+#include <ncommon/Measure.hpp>
+#include <nscene/Camera.hpp>
+#include <nscene/FrustumCuller.hpp>
+#include <nscene/geometry/primitives/Cube.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define NEBULA_OCCLUSION_SSE
+#include <emmintrin.h>
+#endif
+
+namespace Nebula::ns
+{
+    namespace
+    {
+        // Depth of pixels without an occluder, every box is in front of it
+        constexpr float s_clear_depth = std::numeric_limits<float>::max();
+
+        // Vertices closer to the camera plane than this are treated as behind it
+        constexpr float s_min_w = 1.0e-4f;
+
+        // First & last pixel touched by [min, max] on an axis of size pixels, empty if min > max
+        glm::ivec2 pixel_range(const float min, const float max, const int32_t size)
+        {
+            const auto first = static_cast<int32_t>(std::floor(std::clamp(min, -1.0f, static_cast<float>(size))));
+            const auto last = static_cast<int32_t>(std::floor(std::clamp(max, -1.0f, static_cast<float>(size))));
+            return { std::max(first, 0), std::min(last, size - 1) };
+        }
+
+        // Edge a -> b as e(p) = a * p.x + b * p.y + c, positive inside of a counter-clockwise triangle
+        struct Edge
+        {
+            float a, b, c;
+
+            Edge(const glm::vec3& from, const glm::vec3& to)
+            : a(from.y - to.y), b(to.x - from.x), c(-(a * from.x + b * from.y)) {}
+
+            float operator()(const float x, const float y) const { return a * x + b * y + c; }
+        };
+    }
+
+    OcclusionRasterizer::OcclusionRasterizer(const uint32_t thread_count)
+    : m_thread_pool(std::max(thread_count, 1u))
+    , m_depth(static_cast<size_t>(s_width) * s_height, s_clear_depth)
+    , m_block_max(static_cast<size_t>(s_blocks_x) * s_blocks_y, s_clear_depth)
+    , m_bins(static_cast<size_t>(s_tiles_x) * s_tiles_y)
+    {
+    }
+
+    void OcclusionRasterizer::render(const glm::mat4& view_proj, const std::span<const Occluder> occluders)
+    {
+        const auto start = clock::now();
+        m_view_proj = view_proj;
+
+        m_triangle_offsets.assign(occluders.size() + 1, 0);
+        for (size_t i = 0; i < occluders.size(); i++)
+        {
+            const size_t triangle_count = occluders[i].geometry ? occluders[i].geometry->indices.size() / 3 : 0;
+            m_triangle_offsets[i + 1] = m_triangle_offsets[i] + triangle_count;
+        }
+        m_triangles.resize(m_triangle_offsets.back());
+
+        m_thread_pool.parallel_for(occluders.size(), [&](const size_t i){
+            if (occluders[i].geometry) transform(occluders[i], m_triangles.data() + m_triangle_offsets[i]);
+        });
+
+        // Binning only touches the tiles under each triangle, it stays on the calling thread
+        for (auto& bin : m_bins)
+        {
+            bin.clear();
+        }
+        for (uint32_t i = 0; i < m_triangles.size(); i++)
+        {
+            const auto& rect = m_triangles[i].rect;
+            if (rect.x > rect.z || rect.y > rect.w) continue;
+
+            for (int32_t ty = rect.y / s_tile_height; ty <= rect.w / s_tile_height; ty++)
+            {
+                for (int32_t tx = rect.x / s_tile_width; tx <= rect.z / s_tile_width; tx++)
+                {
+                    m_bins[ty * s_tiles_x + tx].push_back(i);
+                }
+            }
+        }
+
+        m_thread_pool.parallel_for(m_bins.size(), [&](const size_t i){ render_tile(i); });
+
+        m_stats.occluders = static_cast<uint32_t>(occluders.size());
+        m_stats.occluder_triangles = static_cast<uint32_t>(m_triangles.size());
+        m_stats.render_ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+    }
+
+    void OcclusionRasterizer::cull(const std::span<const nmath::AABB> bounds, std::vector<uint32_t>& candidates)
+    {
+        const auto start = clock::now();
+
+        m_visible.resize(candidates.size());
+        const size_t chunk_count = (candidates.size() + s_test_chunk - 1) / s_test_chunk;
+        m_thread_pool.parallel_for(chunk_count, [&](const size_t chunk){
+            const size_t end = std::min((chunk + 1) * s_test_chunk, candidates.size());
+            for (size_t i = chunk * s_test_chunk; i < end; i++)
+            {
+                m_visible[i] = is_visible(bounds[candidates[i]]) ? 1 : 0;
+            }
+        });
+
+        size_t visible_count = 0;
+        for (size_t i = 0; i < candidates.size(); i++)
+        {
+            if (m_visible[i]) candidates[visible_count++] = candidates[i];
+        }
+
+        m_stats.tested = static_cast<uint32_t>(candidates.size());
+        m_stats.culled = static_cast<uint32_t>(candidates.size() - visible_count);
+        candidates.resize(visible_count);
+        m_stats.test_ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+    }
+
+    bool OcclusionRasterizer::is_visible(const nmath::AABB& bounds) const
+    {
+        // Invalid bounds are left to the frustum test
+        if (!bounds.is_valid()) return true;
+
+        glm::vec2 screen_min(std::numeric_limits<float>::max());
+        glm::vec2 screen_max(std::numeric_limits<float>::lowest());
+        float nearest = std::numeric_limits<float>::max();
+
+        // Corners as the projected min corner plus the projected edges of the box
+        const glm::vec3 size = bounds.max - bounds.min;
+        const glm::vec4 base = m_view_proj * glm::vec4(bounds.min, 1.0f);
+        const glm::vec4 dx = m_view_proj[0] * size.x;
+        const glm::vec4 dy = m_view_proj[1] * size.y;
+        const glm::vec4 dz = m_view_proj[2] * size.z;
+        for (uint32_t i = 0; i < 8; i++)
+        {
+            glm::vec4 clip = base;
+            if (i & 1) clip += dx;
+            if (i & 2) clip += dy;
+            if (i & 4) clip += dz;
+
+            // Boxes reaching behind the camera are always drawn
+            if (clip.w < s_min_w) return true;
+
+            const glm::vec2 screen = (glm::vec2(clip) / clip.w + 1.0f) * 0.5f * glm::vec2(s_width, s_height);
+            screen_min = glm::min(screen_min, screen);
+            screen_max = glm::max(screen_max, screen);
+            nearest = std::min(nearest, clip.z / clip.w);
+        }
+
+        const glm::ivec2 x_range = pixel_range(screen_min.x, screen_max.x, s_width);
+        const glm::ivec2 y_range = pixel_range(screen_min.y, screen_max.y, s_height);
+        if (x_range.x > x_range.y || y_range.x > y_range.y) return true;
+
+        // Visible if any pixel under the box has nothing in front of its nearest depth
+        for (int32_t by = y_range.x / s_block_height; by <= y_range.y / s_block_height; by++)
+        {
+            for (int32_t bx = x_range.x / s_block_width; bx <= x_range.y / s_block_width; bx++)
+            {
+                if (nearest > m_block_max[by * s_blocks_x + bx]) continue;
+
+                const int32_t x0 = std::max(x_range.x, bx * s_block_width);
+                const int32_t x1 = std::min(x_range.y, (bx + 1) * s_block_width - 1);
+                const int32_t y0 = std::max(y_range.x, by * s_block_height);
+                const int32_t y1 = std::min(y_range.y, (by + 1) * s_block_height - 1);
+                for (int32_t y = y0; y <= y1; y++)
+                {
+                    const float* row = &m_depth[y * s_width];
+                    for (int32_t x = x0; x <= x1; x++)
+                    {
+                        if (row[x] >= nearest) return true;
+                    }
+                }
+            }
+        }
+        return false;
+    }
+
+    void OcclusionRasterizer::transform(const Occluder& occluder, ScreenTriangle* triangles) const
+    {
+        const auto& positions = occluder.geometry->positions;
+        const auto& indices = occluder.geometry->indices;
+        const glm::mat4 model_view_proj = m_view_proj * occluder.model;
+
+        thread_local std::vector<glm::vec4> clip;
+        clip.resize(positions.size());
+        for (size_t i = 0; i < positions.size(); i++)
+        {
+            clip[i] = model_view_proj * glm::vec4(positions[i], 1.0f);
+        }
+
+        const glm::vec2 scale = 0.5f * glm::vec2(s_width, s_height);
+        const auto to_screen = [&](const glm::vec4& c) {
+            return glm::vec3((glm::vec2(c) / c.w + 1.0f) * scale, c.z / c.w);
+        };
+
+        for (size_t t = 0; t < indices.size() / 3; t++)
+        {
+            auto& triangle = triangles[t];
+            triangle.rect = { 0, 0, -1, -1 };
+
+            const glm::vec4& c0 = clip[indices[3 * t + 0]];
+            const glm::vec4& c1 = clip[indices[3 * t + 1]];
+            const glm::vec4& c2 = clip[indices[3 * t + 2]];
+
+            // Not clipped against the near plane, dropping an occluder triangle only culls less
+            if (c0.w < s_min_w || c1.w < s_min_w || c2.w < s_min_w) continue;
+
+            glm::vec3 v0 = to_screen(c0), v1 = to_screen(c1), v2 = to_screen(c2);
+            const float area = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+            if (!(std::abs(area) > 0.0f)) continue;
+
+            // Both faces occlude, triangles are brought to the same winding
+            if (area < 0.0f) std::swap(v1, v2);
+
+            const glm::ivec2 x_range = pixel_range(std::min({v0.x, v1.x, v2.x}), std::max({v0.x, v1.x, v2.x}), s_width);
+            const glm::ivec2 y_range = pixel_range(std::min({v0.y, v1.y, v2.y}), std::max({v0.y, v1.y, v2.y}), s_height);
+            triangle = { v0, v1, v2, { x_range.x, y_range.x, x_range.y, y_range.y } };
+        }
+    }
+
+    void OcclusionRasterizer::rasterize(const ScreenTriangle& triangle, const glm::ivec4& tile)
+    {
+        // Rows start on a multiple of four pixels, the extra pixels on the left fail the edge tests
+        const int32_t x0 = std::max(triangle.rect.x, tile.x) & ~3;
+        const int32_t x1 = std::min(triangle.rect.z, tile.z);
+        const int32_t y0 = std::max(triangle.rect.y, tile.y);
+        const int32_t y1 = std::min(triangle.rect.w, tile.w);
+        if (x0 > x1 || y0 > y1) return;
+
+        const auto& [ v0, v1, v2, rect ] = triangle;
+        const Edge e01(v0, v1), e12(v1, v2), e20(v2, v0);
+        const float area = e01(v2.x, v2.y);
+
+        // Depth plane from the barycentric weights, each edge weights the vertex opposite to it
+        const float dz_dx = (e12.a * v0.z + e20.a * v1.z + e01.a * v2.z) / area;
+        const float dz_dy = (e12.b * v0.z + e20.b * v1.z + e01.b * v2.z) / area;
+        const float z_c = (e12.c * v0.z + e20.c * v1.z + e01.c * v2.z) / area;
+
+        // Evaluated at pixel centers: shifting the edges by half their change over a pixel only keeps fully covered
+        // pixels, adding half the depth change over a pixel gives the farthest depth inside of it
+        const std::array<Edge, 3> edges = { e01, e12, e20 };
+        std::array<float, 3> inset {};
+        for (size_t i = 0; i < edges.size(); i++)
+        {
+            inset[i] = edges[i].c - 0.5f * (std::abs(edges[i].a) + std::abs(edges[i].b));
+        }
+        const float z_inset = z_c + 0.5f * (std::abs(dz_dx) + std::abs(dz_dy));
+
+        #ifdef NEBULA_OCCLUSION_SSE
+        const __m128 lane_x = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 a0 = _mm_set1_ps(edges[0].a), a1 = _mm_set1_ps(edges[1].a), a2 = _mm_set1_ps(edges[2].a);
+        const __m128 z_dx = _mm_set1_ps(dz_dx);
+
+        for (int32_t y = y0; y <= y1; y++)
+        {
+            const float py = static_cast<float>(y) + 0.5f;
+            const __m128 r0 = _mm_set1_ps(edges[0].b * py + inset[0]);
+            const __m128 r1 = _mm_set1_ps(edges[1].b * py + inset[1]);
+            const __m128 r2 = _mm_set1_ps(edges[2].b * py + inset[2]);
+            const __m128 rz = _mm_set1_ps(dz_dy * py + z_inset);
+
+            float* row = &m_depth[y * s_width];
+            for (int32_t x = x0; x <= x1; x += 4)
+            {
+                const __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), lane_x);
+                const __m128 w0 = _mm_add_ps(_mm_mul_ps(a0, px), r0);
+                const __m128 w1 = _mm_add_ps(_mm_mul_ps(a1, px), r1);
+                const __m128 w2 = _mm_add_ps(_mm_mul_ps(a2, px), r2);
+                const __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(w0, zero), _mm_cmpge_ps(w1, zero)), _mm_cmpge_ps(w2, zero));
+                if (_mm_movemask_ps(inside) == 0) continue;
+
+                const __m128 z = _mm_add_ps(_mm_mul_ps(z_dx, px), rz);
+                const __m128 depth = _mm_loadu_ps(row + x);
+                const __m128 result = _mm_or_ps(_mm_and_ps(inside, _mm_min_ps(depth, z)), _mm_andnot_ps(inside, depth));
+                _mm_storeu_ps(row + x, result);
+            }
+        }
+        #else
+        for (int32_t y = y0; y <= y1; y++)
+        {
+            const float py = static_cast<float>(y) + 0.5f;
+            float* row = &m_depth[y * s_width];
+            for (int32_t x = x0; x <= x1; x++)
+            {
+                const float px = static_cast<float>(x) + 0.5f;
+                const bool inside = edges[0].a * px + edges[0].b * py + inset[0] >= 0.0f
+                                 && edges[1].a * px + edges[1].b * py + inset[1] >= 0.0f
+                                 && edges[2].a * px + edges[2].b * py + inset[2] >= 0.0f;
+                if (inside)
+                {
+                    row[x] = std::min(row[x], dz_dx * px + dz_dy * py + z_inset);
+                }
+            }
+        }
+        #endif
+    }
+
+    void OcclusionRasterizer::render_tile(const size_t tile_idx)
+    {
+        const int32_t tx = static_cast<int32_t>(tile_idx % s_tiles_x) * s_tile_width;
+        const int32_t ty = static_cast<int32_t>(tile_idx / s_tiles_x) * s_tile_height;
+        const glm::ivec4 tile = { tx, ty, tx + s_tile_width - 1, ty + s_tile_height - 1 };
+
+        for (int32_t y = ty; y < ty + s_tile_height; y++)
+        {
+            std::fill_n(&m_depth[y * s_width + tx], s_tile_width, s_clear_depth);
+        }
+
+        for (const uint32_t triangle_idx : m_bins[tile_idx])
+        {
+            rasterize(m_triangles[triangle_idx], tile);
+        }
+
+        // Farthest depth of every block in the tile
+        for (int32_t by = ty / s_block_height; by < (ty + s_tile_height) / s_block_height; by++)
+        {
+            for (int32_t bx = tx / s_block_width; bx < (tx + s_tile_width) / s_block_width; bx++)
+            {
+                float farthest = 0.0f;
+                for (int32_t y = by * s_block_height; y < (by + 1) * s_block_height; y++)
+                {
+                    const float* row = &m_depth[y * s_width + bx * s_block_width];
+                    farthest = std::max(farthest, *std::max_element(row, row + s_block_width));
+                }
+                m_block_max[by * s_blocks_x + bx] = farthest;
+            }
+        }
+    }
+
+    void benchmark_occlusion_culling()
+    {
+        const Camera camera({ 1600, 900 }, glm::vec3(0.0f));
+        const auto camera_data = camera.uniform_data();
+        const glm::mat4 view_proj = camera_data.proj * camera_data.view;
+        const auto frustum = nmath::Frustum::from_matrix(view_proj);
+
+        // A row of walls 40 units in front of the camera with gaps between them
+        const Cube cube;
+        const auto box = OccluderGeometry::from({ cube.vertices(), cube.indices() });
+        std::vector<Occluder> occluders;
+        for (int32_t i = -8; i < 8; i++)
+        {
+            const glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(static_cast<float>(i) * 12.0f + 6.0f, 0.0f, -40.0f))
+                                  * glm::scale(glm::mat4(1.0f), glm::vec3(5.0f, 20.0f, 0.5f));
+            occluders.push_back({ &box, model });
+        }
+
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<float> position_x(-300.0f, 300.0f);
+        std::uniform_real_distribution<float> position_y(-100.0f, 100.0f);
+        std::uniform_real_distribution<float> position_z(-500.0f, -5.0f);
+        std::uniform_real_distribution<float> size(0.5f, 4.0f);
+
+        const uint32_t hardware_threads = std::max(std::thread::hardware_concurrency(), 1u);
+        for (const size_t count : { 10'000, 100'000 })
+        {
+            std::vector<nmath::AABB> bounds(count);
+            for (auto& aabb : bounds)
+            {
+                const glm::vec3 center(position_x(rng), position_y(rng), position_z(rng));
+                const glm::vec3 extent(size(rng));
+                aabb = { center - extent, center + extent };
+            }
+
+            FrustumCuller frustum_culler;
+            frustum_culler.set_bounds(bounds);
+            std::vector<uint32_t> candidates;
+            frustum_culler.cull(frustum, candidates);
+
+            std::optional<uint32_t> reference_culled;
+            for (const uint32_t threads : { 1u, hardware_threads })
+            {
+                OcclusionRasterizer rasterizer(threads);
+
+                constexpr int32_t iterations = 50;
+                double render_ms = 0.0, test_ms = 0.0;
+                std::vector<uint32_t> visible;
+                for (int32_t i = 0; i < iterations; i++)
+                {
+                    visible = candidates;
+                    rasterizer.render(view_proj, occluders);
+                    rasterizer.cull(bounds, visible);
+                    render_ms += rasterizer.stats().render_ms;
+                    test_ms += rasterizer.stats().test_ms;
+                }
+
+                const auto& stats = rasterizer.stats();
+                if (reference_culled && *reference_culled != stats.culled)
+                {
+                    std::cout << nlog::fmt_warning("Occlusion results differ: {} culled with 1 thread, {} with {}",
+                                                   *reference_culled, stats.culled, threads) << std::endl;
+                }
+                reference_culled = stats.culled;
+
+                std::cout << nlog::fmt_info("Occlusion culling {:>6} boxes, {:>2} thread(s): {:>6.3f} ms render + {:>6.3f} ms test, "
+                                            "{} of {} frustum visible culled ({:.1f}%), {} occluder triangles",
+                                            count, threads, render_ms / iterations, test_ms / iterations,
+                                            stats.culled, stats.tested, 100.0 * stats.culling_rate(), stats.occluder_triangles) << std::endl;
+            }
+        }
+    }
+}
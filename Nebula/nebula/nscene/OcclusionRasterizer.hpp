@@ -0,0 +1,104 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <thread>
+#include <vector>
+#include <glm/glm.hpp>
+#include <ncommon/ThreadPool.hpp>
+#include <nmath/AABB.hpp>
+#include <nscene/geometry/Mesh.hpp>
+
+namespace Nebula::ns
+{
+    // Occluder triangles of a mesh placed in the world
+    struct Occluder
+    {
+        const OccluderGeometry* geometry {nullptr};
+        glm::mat4               model {1.0f};
+    };
+
+    struct OcclusionStats
+    {
+        uint32_t occluders          {0};
+        uint32_t occluder_triangles {0};
+        uint32_t tested             {0};
+        uint32_t culled             {0};
+        double   render_ms          {0.0};
+        double   test_ms            {0.0};
+
+        double culling_rate() const { return tested > 0 ? static_cast<double>(culled) / tested : 0.0; }
+    };
+
+    /**
+     * CPU software occlusion culling for when a GPU culling round trip costs more than it saves.
+     * Occluder triangles are binned into screen tiles of a low resolution depth buffer and rasterized per tile in
+     * parallel, four pixels at a time with SSE (scalar fallback on other targets). Only pixels fully covered by a
+     * triangle are written with the farthest depth the triangle reaches inside them, so the buffer never hides more
+     * than the occluders do. Every 8x4 block keeps its farthest depth, boxes are tested against the blocks first and
+     * only read the pixels of blocks they may be in front of.
+     */
+    class OcclusionRasterizer
+    {
+        struct ScreenTriangle
+        {
+            glm::vec3  v0, v1, v2;  // [ Pixel X, Pixel Y, Depth ], counter-clockwise
+            glm::ivec4 rect;        // [ Min X, Min Y, Max X, Max Y ] of the pixels, empty if culled
+        };
+
+    public:
+        explicit OcclusionRasterizer(uint32_t thread_count = std::max(std::thread::hardware_concurrency(), 1u));
+
+        // Clears the depth buffer & rasterizes the occluders, triangles reaching behind the near plane are skipped
+        void render(const glm::mat4& view_proj, std::span<const Occluder> occluders);
+
+        // Removes the candidates whose bounds are hidden behind the rendered occluders, the order is kept
+        void cull(std::span<const nmath::AABB> bounds, std::vector<uint32_t>& candidates);
+
+        bool is_visible(const nmath::AABB& bounds) const;
+
+        const OcclusionStats& stats() const { return m_stats; }
+
+        const std::vector<float>& depth() const { return m_depth; }
+
+        static constexpr int32_t s_width        = 320;
+        static constexpr int32_t s_height       = 180;
+        static constexpr int32_t s_tile_width   = 64;
+        static constexpr int32_t s_tile_height  = 20;
+        static constexpr int32_t s_block_width  = 8;
+        static constexpr int32_t s_block_height = 4;
+
+    private:
+        void transform(const Occluder& occluder, ScreenTriangle* triangles) const;
+
+        void rasterize(const ScreenTriangle& triangle, const glm::ivec4& tile);
+
+        void render_tile(size_t tile_idx);
+
+        static constexpr int32_t s_tiles_x      = s_width / s_tile_width;
+        static constexpr int32_t s_tiles_y      = s_height / s_tile_height;
+        static constexpr int32_t s_blocks_x     = s_width / s_block_width;
+        static constexpr int32_t s_blocks_y     = s_height / s_block_height;
+        static constexpr size_t  s_test_chunk   = 256;
+
+        static_assert(s_width % s_tile_width == 0 && s_height % s_tile_height == 0);
+        static_assert(s_tile_width % s_block_width == 0 && s_tile_height % s_block_height == 0);
+        static_assert(s_tile_width % 4 == 0, "Tiles are rasterized four pixels at a time");
+
+        ThreadPool                          m_thread_pool;
+        glm::mat4                           m_view_proj {1.0f};
+        std::vector<float>                  m_depth;
+        std::vector<float>                  m_block_max;
+
+        std::vector<ScreenTriangle>         m_triangles;
+        std::vector<size_t>                 m_triangle_offsets;
+        std::vector<std::vector<uint32_t>>  m_bins;
+        std::vector<uint8_t>                m_visible;
+
+        OcclusionStats                      m_stats;
+    };
+
+    // Prints the occlusion culling rate & time per frame of random boxes behind a set of walls, without a GPU
+    void benchmark_occlusion_culling();
+}
@@ -1,5 +1,7 @@
 #include "Scene.hpp"
+#include <unordered_map>
 #include <fmt/format.h>
+#include <nlog/nlog.hpp>
 
 namespace Nebula::ns
 {
@@ -14,11 +16,21 @@ namespace Nebula::ns
     void Scene::init()
     {
         scene_init();
+        create_instance_batches();
+        create_transforms();
+        update_transforms();
+        if (!m_cameras.empty())
+        {
+            cull_objects(active_camera()->uniform_data());
+        }
 
+        nvk::UploadBatch upload_batch(m_device, m_command_pool);
         if (!m_objects.empty())
         {
-            create_object_description_buffers();
+            create_object_description_buffers(upload_batch);
         }
+        create_lights_buffer(upload_batch);
+        upload_batch.submit();
 
         if (m_device->is_raytracing_enabled())
         {
@@ -26,19 +38,21 @@ namespace Nebula::ns
         }
 
         create_camera_uniform_buffers();
-        create_lights_buffer();
     }
 
     void Scene::update(float dt, uint32_t current_frame)
     {
         auto uniform_data = active_camera()->uniform_data();
         m_camera_uniform_buffer[current_frame]->set_data(&uniform_data);
+
+        update_transforms();
+        cull_objects(uniform_data);
     }
 
     void Scene::update(float dt, uint32_t current_frame, const vk::CommandBuffer& command_buffer)
     {
-        update_tlas(command_buffer);
         update(dt, current_frame);
+        update_tlas(current_frame, command_buffer);
     }
 
     void Scene::key_handler(const wsi::Window& window)
@@ -56,7 +70,135 @@ namespace Nebula::ns
         m_active_camera = (m_active_camera + 1) % m_cameras.size();
     }
 
-    void Scene::create_object_description_buffers()
+    const SceneGeometry& Scene::shared_geometry()
+    {
+        if (!m_shared_geometry)
+        {
+            nvk::UploadBatch upload_batch(m_device, m_command_pool);
+            m_shared_geometry = std::make_shared<SceneGeometry>(m_meshes, m_name, m_device, upload_batch);
+            upload_batch.submit();
+        }
+        return *m_shared_geometry;
+    }
+
+    void Scene::create_instance_batches()
+    {
+        m_instance_batches.clear();
+        std::unordered_map<const Mesh*, uint32_t> batch_of_mesh;
+        m_batch_of_object.resize(m_objects.size());
+        for (size_t i = 0; i < m_objects.size(); i++)
+        {
+            const auto [it, inserted] = batch_of_mesh.try_emplace(m_objects[i].mesh.get(), static_cast<uint32_t>(m_instance_batches.size()));
+            if (inserted)
+            {
+                m_instance_batches.push_back({ .mesh = m_objects[i].mesh });
+            }
+            m_batch_of_object[i] = it->second;
+            m_instance_batches[it->second].instance_count++;
+        }
+
+        uint32_t first_instance = 0;
+        for (auto& batch : m_instance_batches)
+        {
+            batch.first_instance = first_instance;
+            first_instance += batch.instance_count;
+        }
+
+        // Objects keep their relative order inside a batch
+        m_instance_order.resize(m_objects.size());
+        std::vector<uint32_t> next_instance(m_instance_batches.size());
+        for (size_t i = 0; i < m_instance_batches.size(); i++)
+        {
+            next_instance[i] = m_instance_batches[i].first_instance;
+        }
+        for (uint32_t i = 0; i < m_objects.size(); i++)
+        {
+            m_instance_order[next_instance[m_batch_of_object[i]]++] = i;
+        }
+    }
+
+    void Scene::create_transforms()
+    {
+        m_transforms.clear();
+        for (const auto& object : m_objects)
+        {
+            m_transforms.add(object.transform);
+        }
+
+        for (uint32_t i = 0; i < m_objects.size(); i++)
+        {
+            if (!m_objects[i].parent.has_value()) continue;
+            if (*m_objects[i].parent >= m_objects.size())
+            {
+                throw nlog::make_exception("Object \"{}\" of scene \"{}\" has parent {}, the scene has {} objects",
+                                           m_objects[i].name, m_name, *m_objects[i].parent, m_objects.size());
+            }
+            m_transforms.set_parent(i, *m_objects[i].parent);
+        }
+    }
+
+    void Scene::update_transforms()
+    {
+        // Bounds follow the world matrices, only the moved objects are transformed again
+        m_transforms.update();
+        m_object_bounds.resize(m_objects.size());
+        for (const uint32_t object_idx : m_transforms.changed())
+        {
+            m_object_bounds[object_idx] = m_objects[object_idx].mesh->bounds().transform(m_transforms.world(object_idx));
+        }
+
+        // The culler keeps its own packed copy, repacked in full only when the object count changed
+        if (m_frustum_culler.size() != m_object_bounds.size())
+        {
+            m_frustum_culler.set_bounds(m_object_bounds);
+        }
+        else
+        {
+            m_frustum_culler.update_bounds(m_transforms.changed(), m_object_bounds);
+        }
+    }
+
+    void Scene::set_transform(const uint32_t object_idx, const nmath::Transform& transform)
+    {
+        m_objects[object_idx].transform = transform;
+        m_transforms.set_local(object_idx, transform);
+    }
+
+    void Scene::set_software_occlusion(const bool enabled)
+    {
+        if (enabled && !m_occlusion_rasterizer)
+        {
+            m_occlusion_rasterizer = std::make_unique<OcclusionRasterizer>();
+        }
+        else if (!enabled)
+        {
+            m_occlusion_rasterizer.reset();
+        }
+    }
+
+    void Scene::cull_objects(const CameraData& camera_data)
+    {
+        const glm::mat4 view_proj = camera_data.proj * camera_data.view;
+        m_frustum_culler.cull(nmath::Frustum::from_matrix(view_proj), m_visible_objects);
+
+        if (!m_occlusion_rasterizer) return;
+
+        // Only occluders inside the frustum can cover any of the visible objects
+        m_occluders.clear();
+        for (const uint32_t object_idx : m_visible_objects)
+        {
+            const auto& object = m_objects[object_idx];
+            if (object.occluder && object.mesh->occluder())
+            {
+                m_occluders.push_back({ object.mesh->occluder(), m_transforms.world(object_idx) });
+            }
+        }
+
+        m_occlusion_rasterizer->render(view_proj, m_occluders);
+        m_occlusion_rasterizer->cull(m_object_bounds, m_visible_objects);
+    }
+
+    void Scene::create_object_description_buffers(nvk::UploadBatch& upload_batch)
     {
         std::vector<ObjectDescription> obj_descriptions;
         for (const auto& obj : m_objects)
@@ -70,35 +212,37 @@ namespace Nebula::ns
             .set_name(name)
             .set_size(sizeof(ObjectDescription) * obj_descriptions.size());
         m_object_descriptions_buffer = std::make_shared<nvk::Buffer>(od_create_info, m_device);
-
-        auto odstgci = nvk::BufferCreateInfo()
-            .set_buffer_type(nvk::BufferType::eStaging)
-            .set_name(name)
-            .set_size(od_create_info.size);
-        auto od_staging = std::make_shared<nvk::Buffer>(odstgci, m_device);
-        od_staging->set_data(obj_descriptions.data());
-
-        m_command_pool->exec_single_time_command([&](const vk::CommandBuffer& command_buffer){
-            od_staging->copy_to_buffer(*m_object_descriptions_buffer, command_buffer);
-        });
+        upload_batch.upload(m_object_descriptions_buffer, obj_descriptions.data(), od_create_info.size);
     }
 
-    void Scene::create_lights_buffer()
+    void Scene::create_lights_buffer(nvk::UploadBatch& upload_batch)
     {
         auto name = fmt::format("[{} Scene] Lights", m_name);
         auto create_info = nvk::BufferCreateInfo()
             .set_buffer_type(nvk::BufferType::eStorage)
             .set_name(name)
             .set_size(sizeof(Light) * m_lights.size());
-        m_lights_buffer = nvk::Buffer::create_with_data(create_info, m_lights.data(), m_device, m_command_pool);
+        m_lights_buffer = std::make_shared<nvk::Buffer>(create_info, m_device);
+        upload_batch.upload(m_lights_buffer, m_lights.data(), create_info.size);
     }
 
     std::vector<nvk::TLASInstanceInfo> Scene::collect_tlas_instances() const
     {
-        std::vector<nvk::TLASInstanceInfo> result;
-        for (const auto& object : m_objects)
+        // Instances stay in object order, ray tracing shaders index the object descriptions with the instance ID
+        std::vector<nvk::TLASInstanceInfo> result(m_objects.size());
+        for (const auto& batch : m_instance_batches)
         {
-            result.push_back(object.get_tlas_instance_info());
+            const vk::DeviceAddress blas_address = batch.mesh->bottom_level_as()->address();
+            for (uint32_t i = batch.first_instance; i < batch.first_instance + batch.instance_count; i++)
+            {
+                const uint32_t object_idx = m_instance_order[i];
+                result[object_idx] = {
+                    .blas_address = blas_address,
+                    .hit_group    = m_objects[object_idx].rt_hit_group,
+                    .mask         = 0xff,
+                    .transform    = m_transforms.world3x4(object_idx),
+                };
+            }
         }
         return result;
     }
@@ -107,14 +251,29 @@ namespace Nebula::ns
     {
         if (!m_device->is_raytracing_enabled()) return;
         auto instances = collect_tlas_instances();
-        m_top_level_as = nvk::TLAS::create({ instances, m_name }, m_device, m_command_pool);
+        const auto frames_in_flight = static_cast<uint32_t>(m_camera_uniform_buffer.size());
+        m_top_level_as = nvk::TLAS::create({ instances, m_name, frames_in_flight }, m_device, m_command_pool);
     }
 
-    void Scene::update_tlas(const vk::CommandBuffer& command_buffer)
+    void Scene::update_tlas(const uint32_t current_frame, const vk::CommandBuffer& command_buffer)
     {
-        if (!m_device->is_raytracing_enabled()) return;
-        auto instances = collect_tlas_instances();
-        auto update_info = nvk::TLASUpdateInfo { instances };
+        if (!m_top_level_as) return;
+
+        // Instance i belongs to object i, only the instances of the moved objects are written & refit
+        const auto changed = m_transforms.changed();
+        if (changed.empty()) return;
+
+        m_tlas_instances.clear();
+        for (const uint32_t object_idx : changed)
+        {
+            m_tlas_instances.push_back(m_objects[object_idx].get_tlas_instance_info(m_transforms.world3x4(object_idx)));
+        }
+
+        auto update_info = nvk::TLASUpdateInfo {
+            .instance_info = m_tlas_instances,
+            .indices       = changed,
+            .frame         = current_frame,
+        };
         m_top_level_as->update(update_info, command_buffer);
     }
 
@@ -7,17 +7,30 @@
 #include <glm/glm.hpp>
 #include <nmath/Utility.hpp>
 #include <nscene/Camera.hpp>
+#include <nscene/FrustumCuller.hpp>
 #include <nscene/Light.hpp>
 #include <nscene/Object.hpp>
+#include <nscene/OcclusionRasterizer.hpp>
+#include <nscene/SceneGeometry.hpp>
+#include <nscene/TransformStore.hpp>
 #include <nscene/geometry/Geometry.hpp>
 #include <nscene/geometry/Mesh.hpp>
 #include <nvk/Buffer.hpp>
 #include <nvk/Command.hpp>
 #include <nvk/Device.hpp>
+#include <nvk/UploadBatch.hpp>
 #include <wsi/Window.hpp>
 
 namespace Nebula::ns
 {
+    // Objects sharing a mesh, contiguous in the instance order of the scene
+    struct InstanceBatch
+    {
+        std::shared_ptr<Mesh> mesh;
+        uint32_t              first_instance {0};
+        uint32_t              instance_count {0};
+    };
+
     class Scene
     {
     public:
@@ -65,6 +78,59 @@ namespace Nebula::ns
             return m_lights;
         }
 
+        // One batch per unique mesh, in the order the meshes first appear in the objects
+        const std::vector<InstanceBatch>& instance_batches() const
+        {
+            return m_instance_batches;
+        }
+
+        // Object index of every instance, instances of a batch are contiguous
+        const std::vector<uint32_t>& instance_order() const
+        {
+            return m_instance_order;
+        }
+
+        // Batch of every object, indexed by object
+        const std::vector<uint32_t>& batch_of_object() const
+        {
+            return m_batch_of_object;
+        }
+
+        // Objects inside the frustum of the active camera as of the last update, in ascending order
+        const std::vector<uint32_t>& visible_objects() const
+        {
+            return m_visible_objects;
+        }
+
+        // World matrix of an object as of the last update
+        const glm::mat4& world(const uint32_t object_idx) const
+        {
+            return m_transforms.world(object_idx);
+        }
+
+        const TransformStore& transforms() const
+        {
+            return m_transforms;
+        }
+
+        // Moves an object & everything placed relative to it with the next update
+        void set_transform(uint32_t object_idx, const nmath::Transform& transform);
+
+        // World space bounds of every object as of the last update
+        const std::vector<nmath::AABB>& object_bounds() const
+        {
+            return m_object_bounds;
+        }
+
+        // Culls the frustum visible objects hidden behind the occluder objects on the CPU as well
+        void set_software_occlusion(bool enabled);
+
+        // Statistics of the last software occlusion pass, null if it is disabled
+        const OcclusionStats* software_occlusion_stats() const
+        {
+            return m_occlusion_rasterizer ? &m_occlusion_rasterizer->stats() : nullptr;
+        }
+
         const std::shared_ptr<nvk::Buffer>& object_descriptions_buffer() const
         {
             return m_object_descriptions_buffer;
@@ -85,18 +151,30 @@ namespace Nebula::ns
             return m_camera_uniform_buffer;
         }
 
+        // Writes the TLAS instances of the objects moved by the last update & refits the TLAS in the command buffer
+        void update_tlas(uint32_t current_frame, const vk::CommandBuffer& command_buffer);
+
+        // Vertex & index data of every mesh in shared buffers, created on first use
+        const SceneGeometry& shared_geometry();
+
     protected:
         virtual void scene_init() {}
 
         void create_camera_uniform_buffers();
 
-        void create_object_description_buffers();
+        void create_instance_batches();
 
-        void create_lights_buffer();
+        void create_transforms();
 
-        void create_tlas();
+        void update_transforms();
 
-        void update_tlas(const vk::CommandBuffer& command_buffer);
+        void cull_objects(const CameraData& camera_data);
+
+        void create_object_description_buffers(nvk::UploadBatch& upload_batch);
+
+        void create_lights_buffer(nvk::UploadBatch& upload_batch);
+
+        void create_tlas();
 
         std::vector<nvk::TLASInstanceInfo> collect_tlas_instances() const;
 
@@ -106,9 +184,20 @@ namespace Nebula::ns
         std::vector<Light>                              m_lights;
         std::map<std::string, std::shared_ptr<Mesh>>    m_meshes;
         std::vector<Object>                             m_objects;
+        std::vector<InstanceBatch>                      m_instance_batches;
+        std::vector<uint32_t>                           m_instance_order;
+        std::vector<uint32_t>                           m_batch_of_object;
+        TransformStore                                  m_transforms;
+        std::vector<nmath::AABB>                        m_object_bounds;
+        FrustumCuller                                   m_frustum_culler;
+        std::vector<uint32_t>                           m_visible_objects;
+        std::unique_ptr<OcclusionRasterizer>            m_occlusion_rasterizer;
+        std::vector<Occluder>                           m_occluders;
         std::shared_ptr<nvk::Buffer>                    m_object_descriptions_buffer;
         std::shared_ptr<nvk::TLAS>                      m_top_level_as;
+        std::vector<nvk::TLASInstanceInfo>              m_tlas_instances;
         std::shared_ptr<nvk::Buffer>                    m_lights_buffer;
+        std::shared_ptr<SceneGeometry>                  m_shared_geometry;
 
         std::array<std::shared_ptr<nvk::Buffer>, 2>     m_camera_uniform_buffer;
 
@@ -0,0 +1,305 @@
+#include "SceneCache.hpp"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <fmt/format.h>
+#include <nlog/nlog.hpp>
+#include <ncommon/Measure.hpp>
+#include <nvk/UploadBatch.hpp>
+
+namespace Nebula::ns
+{
+    namespace
+    {
+        uint64_t align_up(const uint64_t value)
+        {
+            return (value + cache::s_alignment - 1) & ~(cache::s_alignment - 1);
+        }
+
+        bool is_in_range(const uint64_t offset, const uint64_t size, const uint64_t file_size)
+        {
+            return offset <= file_size && size <= file_size - offset;
+        }
+
+        // Header is valid for this build and every table lies inside the file
+        bool validate_header(const cache::Header& header, const uint64_t file_size, std::string& error)
+        {
+            if (std::memcmp(header.magic, cache::s_magic, sizeof(cache::s_magic)) != 0)
+            {
+                error = "not a scene cache";
+                return false;
+            }
+            if (header.version != cache::s_version || header.vertex_size != sizeof(Vertex))
+            {
+                error = fmt::format("version {} with vertex size {} does not match {} with {}",
+                                    header.version, header.vertex_size, cache::s_version, sizeof(Vertex));
+                return false;
+            }
+            if (header.file_size != file_size)
+            {
+                error = fmt::format("file size {} does not match the size {} in the header", file_size, header.file_size);
+                return false;
+            }
+            if (!is_in_range(header.meshes_offset, uint64_t(header.mesh_count) * sizeof(cache::MeshRecord), file_size)
+             || !is_in_range(header.objects_offset, uint64_t(header.object_count) * sizeof(cache::ObjectRecord), file_size)
+             || !is_in_range(header.lights_offset, uint64_t(header.light_count) * sizeof(cache::LightRecord), file_size)
+             || !is_in_range(header.names_offset, header.names_size, file_size))
+            {
+                error = "tables are out of the bounds of the file";
+                return false;
+            }
+            return true;
+        }
+
+        template <typename T>
+        const T* table(const MappedFile& file, const uint64_t offset)
+        {
+            return reinterpret_cast<const T*>(file.data() + offset);
+        }
+
+        std::string read_name(const MappedFile& file, const cache::Header& header, const cache::StringRef& ref)
+        {
+            if (uint64_t(ref.offset) + ref.length > header.names_size)
+            {
+                throw nlog::make_exception("Scene cache name is out of the bounds of the name table");
+            }
+            return { reinterpret_cast<const char*>(file.data() + header.names_offset + ref.offset), ref.length };
+        }
+    }
+
+    #pragma region SceneCacheWriter
+
+    uint32_t SceneCacheWriter::add_mesh(const std::string& name, const Geometry& geometry, const nmath::AABB& bounds)
+    {
+        m_geometries.push_back(&geometry);
+        m_meshes.push_back({
+            .vertex_count = static_cast<uint32_t>(geometry.vertices().size()),
+            .index_count  = static_cast<uint32_t>(geometry.indices().size()),
+            .name         = add_name(name),
+            .bounds_min   = glm::vec4(bounds.min, 0.0f),
+            .bounds_max   = glm::vec4(bounds.max, 0.0f),
+        });
+        return static_cast<uint32_t>(m_meshes.size() - 1);
+    }
+
+    void SceneCacheWriter::add_object(const uint32_t mesh, const std::string& name, const nmath::Transform& transform,
+                                      const glm::vec4& color, const uint32_t rt_hit_group)
+    {
+        if (mesh >= m_meshes.size())
+        {
+            throw nlog::make_exception("Object {} references mesh {}, but only {} meshes were added", name, mesh, m_meshes.size());
+        }
+
+        m_objects.push_back({
+            .mesh         = mesh,
+            .rt_hit_group = rt_hit_group,
+            .name         = add_name(name),
+            .color        = color,
+            .translate    = glm::vec4(transform.translate, 0.0f),
+            .scale        = glm::vec4(transform.scale, 0.0f),
+            .euler        = glm::vec4(transform.euler, 0.0f),
+        });
+    }
+
+    void SceneCacheWriter::add_light(const Light& light)
+    {
+        m_lights.push_back({ .position = light.position, .color = light.color });
+    }
+
+    cache::StringRef SceneCacheWriter::add_name(const std::string& name)
+    {
+        const cache::StringRef ref = { static_cast<uint32_t>(m_names.size()), static_cast<uint32_t>(name.size()) };
+        m_names.append(name);
+        return ref;
+    }
+
+    void SceneCacheWriter::write(const std::string& path) const
+    {
+        cache::Header header;
+        std::memcpy(header.magic, cache::s_magic, sizeof(cache::s_magic));
+        header.version      = cache::s_version;
+        header.vertex_size  = sizeof(Vertex);
+        header.mesh_count   = static_cast<uint32_t>(m_meshes.size());
+        header.object_count = static_cast<uint32_t>(m_objects.size());
+        header.light_count  = static_cast<uint32_t>(m_lights.size());
+        header.names_size   = static_cast<uint32_t>(m_names.size());
+        header.camera_eye   = glm::vec4(m_camera_eye, 1.0f);
+
+        // Layout: tables first, then the streams of every mesh
+        uint64_t offset = align_up(sizeof(cache::Header));
+        header.meshes_offset  = offset; offset = align_up(offset + m_meshes.size() * sizeof(cache::MeshRecord));
+        header.objects_offset = offset; offset = align_up(offset + m_objects.size() * sizeof(cache::ObjectRecord));
+        header.lights_offset  = offset; offset = align_up(offset + m_lights.size() * sizeof(cache::LightRecord));
+        header.names_offset   = offset; offset = align_up(offset + m_names.size());
+
+        auto meshes = m_meshes;
+        for (auto& mesh : meshes)
+        {
+            mesh.vertex_offset = offset; offset = align_up(offset + uint64_t(mesh.vertex_count) * sizeof(Vertex));
+            mesh.index_offset  = offset; offset = align_up(offset + uint64_t(mesh.index_count) * sizeof(uint32_t));
+        }
+        header.file_size = offset;
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            throw nlog::make_exception("Failed to open scene cache {} for writing", path);
+        }
+
+        const auto write_at = [&](const uint64_t at, const void* data, const uint64_t size) {
+            static constexpr char padding[cache::s_alignment] = {};
+            file.write(padding, static_cast<std::streamsize>(at - static_cast<uint64_t>(file.tellp())));
+            file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        };
+
+        write_at(0, &header, sizeof(header));
+        write_at(header.meshes_offset, meshes.data(), meshes.size() * sizeof(cache::MeshRecord));
+        write_at(header.objects_offset, m_objects.data(), m_objects.size() * sizeof(cache::ObjectRecord));
+        write_at(header.lights_offset, m_lights.data(), m_lights.size() * sizeof(cache::LightRecord));
+        write_at(header.names_offset, m_names.data(), m_names.size());
+        for (size_t i = 0; i < meshes.size(); i++)
+        {
+            write_at(meshes[i].vertex_offset, m_geometries[i]->vertices().data(), uint64_t(meshes[i].vertex_count) * sizeof(Vertex));
+            write_at(meshes[i].index_offset, m_geometries[i]->indices().data(), uint64_t(meshes[i].index_count) * sizeof(uint32_t));
+        }
+        write_at(header.file_size, nullptr, 0);
+
+        if (!file)
+        {
+            throw nlog::make_exception("Failed to write scene cache {}", path);
+        }
+    }
+
+    #pragma endregion
+
+    #pragma region CachedScene
+
+    CachedScene::CachedScene(const std::string& cache_path,
+                             const glm::ivec2& camera_size,
+                             const std::shared_ptr<nvk::CommandPool>& command_pool,
+                             const std::shared_ptr<nvk::Device>& device)
+    : Scene(camera_size, std::filesystem::path(cache_path).stem().string(), command_pool, device)
+    , m_cache_path(cache_path)
+    {
+    }
+
+    bool CachedScene::is_up_to_date(const std::string& cache_path, const std::string& source_path)
+    {
+        std::error_code ec;
+        const auto cache_time = std::filesystem::last_write_time(cache_path, ec);
+        if (ec) return false;
+        const auto source_time = std::filesystem::last_write_time(source_path, ec);
+        if (ec || cache_time < source_time) return false;
+
+        std::ifstream file(cache_path, std::ios::binary);
+        cache::Header header;
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+
+        std::string error;
+        return validate_header(header, std::filesystem::file_size(cache_path, ec), error) && !ec;
+    }
+
+    void CachedScene::scene_init()
+    {
+        vk::DeviceSize upload_size = 0;
+        const auto load_time = measure([&]{
+            const MappedFile file(m_cache_path);
+            if (file.size() < sizeof(cache::Header))
+            {
+                throw nlog::make_exception("Scene cache {} is too small to contain a header", m_cache_path);
+            }
+
+            const auto& header = *table<cache::Header>(file, 0);
+            if (std::string error; !validate_header(header, file.size(), error))
+            {
+                throw nlog::make_exception("Invalid scene cache {}: {}", m_cache_path, error);
+            }
+
+            // Meshes, the streams are copied from the mapping into staging memory
+            const auto* mesh_records = table<cache::MeshRecord>(file, header.meshes_offset);
+            std::vector<std::shared_ptr<Mesh>> meshes(header.mesh_count);
+            {
+                nvk::UploadBatch upload_batch(m_device, m_command_pool);
+                for (uint32_t i = 0; i < header.mesh_count; i++)
+                {
+                    const auto& record = mesh_records[i];
+                    const uint64_t vertex_bytes = uint64_t(record.vertex_count) * sizeof(Vertex);
+                    const uint64_t index_bytes = uint64_t(record.index_count) * sizeof(uint32_t);
+                    if (!is_in_range(record.vertex_offset, vertex_bytes, file.size())
+                     || !is_in_range(record.index_offset, index_bytes, file.size())
+                     || record.vertex_offset % alignof(Vertex) != 0 || record.index_offset % alignof(uint32_t) != 0)
+                    {
+                        throw nlog::make_exception("Invalid scene cache {}: streams of mesh {} are out of bounds", m_cache_path, i);
+                    }
+
+                    const MeshDataView data = {
+                        { table<Vertex>(file, record.vertex_offset), record.vertex_count },
+                        { table<uint32_t>(file, record.index_offset), record.index_count },
+                    };
+                    const nmath::AABB bounds = { glm::vec3(record.bounds_min), glm::vec3(record.bounds_max) };
+
+                    // Caches baked before mesh names were unique can repeat a name, the mesh index keeps them apart
+                    auto name = read_name(file, header, record.name);
+                    if (m_meshes.contains(name))
+                    {
+                        name = fmt::format("{} #{}", name, i);
+                    }
+                    meshes[i] = std::make_shared<Mesh>(name, data, bounds, m_device, upload_batch);
+                    if (!m_meshes.emplace(name, meshes[i]).second)
+                    {
+                        throw nlog::make_exception("Invalid scene cache {}: mesh name {} is used twice", m_cache_path, name);
+                    }
+                }
+
+                // The staging copies are done once the batch is submitted, the mapping can be released afterwards
+                upload_size = upload_batch.pending_size();
+                upload_batch.submit();
+            }
+
+            if (m_device->is_raytracing_enabled())
+            {
+                for (const auto& mesh : meshes)
+                {
+                    mesh->create_blas(m_device, m_command_pool);
+                }
+            }
+
+            const auto* object_records = table<cache::ObjectRecord>(file, header.objects_offset);
+            for (uint32_t i = 0; i < header.object_count; i++)
+            {
+                const auto& record = object_records[i];
+                if (record.mesh >= header.mesh_count)
+                {
+                    throw nlog::make_exception("Invalid scene cache {}: object {} references mesh {}", m_cache_path, i, record.mesh);
+                }
+
+                m_objects.push_back({
+                    .mesh         = meshes[record.mesh],
+                    .name         = read_name(file, header, record.name),
+                    .rt_hit_group = record.rt_hit_group,
+                    .solid_color  = record.color,
+                    .transform    = {
+                        .translate = glm::vec3(record.translate),
+                        .scale     = glm::vec3(record.scale),
+                        .euler     = glm::vec3(record.euler),
+                    },
+                });
+            }
+
+            const auto* light_records = table<cache::LightRecord>(file, header.lights_offset);
+            for (uint32_t i = 0; i < header.light_count; i++)
+            {
+                m_lights.push_back({ .position = light_records[i].position, .color = light_records[i].color });
+            }
+
+            m_cameras.push_back(std::make_shared<Camera>(m_camera_size, glm::vec3(header.camera_eye)));
+        });
+
+        std::cout << nlog::fmt_info("Loaded scene cache {} with {} meshes & {} objects in {} ms ({:.2f} MiB uploaded)",
+                                    m_cache_path, m_meshes.size(), m_objects.size(), load_time.count(),
+                                    static_cast<double>(upload_size) / (1024.0 * 1024.0)) << std::endl;
+    }
+
+    #pragma endregion
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include <ncommon/MappedFile.hpp>
+#include <nmath/AABB.hpp>
+#include <nmath/Transform.hpp>
+#include <nscene/Light.hpp>
+#include <nscene/Scene.hpp>
+#include <nscene/Vertex.hpp>
+#include <nscene/geometry/Geometry.hpp>
+
+namespace Nebula::ns
+{
+    /**
+     * Binary scene cache layout, every section starts on a 16 byte boundary:
+     * [ Header | MeshRecord[] | ObjectRecord[] | LightRecord[] | Names | Vertex & index streams ]
+     * Offsets are relative to the start of the file. The file is written & read in native (little endian) byte order,
+     * vertex & index streams have the exact layout of the GPU buffers so they can be copied into staging memory as-is.
+     */
+    namespace cache
+    {
+        static constexpr char     s_magic[8] = { 'N', 'B', 'L', 'S', 'C', 'E', 'N', 'E' };
+        static constexpr uint32_t s_version = 1;
+        static constexpr uint64_t s_alignment = 16;
+
+        struct StringRef
+        {
+            uint32_t offset {0};    // Relative to Header::names_offset
+            uint32_t length {0};
+        };
+
+        struct Header
+        {
+            char      magic[8] {};
+            uint32_t  version {0};
+            uint32_t  vertex_size {0};
+            uint32_t  mesh_count {0};
+            uint32_t  object_count {0};
+            uint32_t  light_count {0};
+            uint32_t  names_size {0};
+            uint64_t  meshes_offset {0};
+            uint64_t  objects_offset {0};
+            uint64_t  lights_offset {0};
+            uint64_t  names_offset {0};
+            uint64_t  file_size {0};
+            uint64_t  reserved {0};
+            glm::vec4 camera_eye {0.0f};
+        };
+
+        struct MeshRecord
+        {
+            uint64_t  vertex_offset {0};
+            uint64_t  index_offset {0};
+            uint32_t  vertex_count {0};
+            uint32_t  index_count {0};
+            StringRef name;
+            glm::vec4 bounds_min {0.0f};
+            glm::vec4 bounds_max {0.0f};
+        };
+
+        struct ObjectRecord
+        {
+            uint32_t  mesh {0};
+            uint32_t  rt_hit_group {0};
+            StringRef name;
+            glm::vec4 color {1.0f};
+            glm::vec4 translate {0.0f};
+            glm::vec4 scale {1.0f};
+            glm::vec4 euler {0.0f};
+        };
+
+        struct LightRecord
+        {
+            glm::vec4 position {0.0f};
+            glm::vec4 color {1.0f};
+        };
+
+        static_assert(sizeof(Header) == 96);
+        static_assert(sizeof(MeshRecord) == 64);
+        static_assert(sizeof(ObjectRecord) == 80);
+        static_assert(sizeof(LightRecord) == 32);
+        static_assert(sizeof(Vertex) == 32);
+    }
+
+    /**
+     * Collects the contents of a scene and writes them as a scene cache.
+     * Geometry passed to add_mesh is referenced, not copied, and has to outlive write().
+     */
+    class SceneCacheWriter
+    {
+    public:
+        uint32_t add_mesh(const std::string& name, const Geometry& geometry, const nmath::AABB& bounds);
+
+        void add_object(uint32_t mesh, const std::string& name, const nmath::Transform& transform,
+                        const glm::vec4& color, uint32_t rt_hit_group = 0);
+
+        void add_light(const Light& light);
+
+        void set_camera_eye(const glm::vec3& eye) { m_camera_eye = eye; }
+
+        void write(const std::string& path) const;
+
+    private:
+        cache::StringRef add_name(const std::string& name);
+
+        std::vector<const Geometry*>        m_geometries;
+        std::vector<cache::MeshRecord>      m_meshes;
+        std::vector<cache::ObjectRecord>    m_objects;
+        std::vector<cache::LightRecord>     m_lights;
+        std::string                         m_names;
+        glm::vec3                           m_camera_eye {0.0f};
+    };
+
+    /**
+     * Scene loaded from a scene cache written by SceneCacheWriter (see GLTFScene::bake).
+     * The file is memory mapped and the vertex & index streams are copied from the mapping straight into staging
+     * memory, there is no parsing or intermediate copy on the CPU.
+     */
+    class CachedScene : public Scene
+    {
+    public:
+        CachedScene(const std::string& cache_path,
+                    const glm::ivec2& camera_size,
+                    const std::shared_ptr<nvk::CommandPool>& command_pool,
+                    const std::shared_ptr<nvk::Device>& device);
+
+        ~CachedScene() override = default;
+
+        // True if the cache has a valid header of the current version and is not older than the source file
+        static bool is_up_to_date(const std::string& cache_path, const std::string& source_path);
+
+    protected:
+        void scene_init() override;
+
+    private:
+        std::string m_cache_path;
+    };
+}
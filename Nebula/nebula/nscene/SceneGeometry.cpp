@@ -0,0 +1,80 @@
+#include "SceneGeometry.hpp"
+#include <algorithm>
+#include <limits>
+#include <fmt/format.h>
+#include <nlog/nlog.hpp>
+#include <nscene/Vertex.hpp>
+
+namespace Nebula::ns
+{
+    SceneGeometry::SceneGeometry(const std::map<std::string, std::shared_ptr<Mesh>>& meshes,
+                                 const std::string& name,
+                                 const std::shared_ptr<nvk::Device>& device,
+                                 nvk::UploadBatch& upload_batch)
+    {
+        uint64_t vertex_count = 0;
+        uint64_t index_count = 0;
+        for (const auto& [key, mesh] : meshes)
+        {
+            m_ranges[mesh.get()] = {
+                .first_index   = static_cast<uint32_t>(index_count),
+                .vertex_offset = static_cast<int32_t>(vertex_count),
+                .index_count   = mesh->index_count(),
+            };
+            vertex_count += mesh->vertex_count();
+            index_count += mesh->index_count();
+        }
+
+        if (vertex_count > std::numeric_limits<int32_t>::max() || index_count > std::numeric_limits<uint32_t>::max())
+        {
+            throw nlog::make_exception("Scene \"{}\" has {} vertices & {} indices, which don't fit into the shared geometry buffers",
+                                       name, vertex_count, index_count);
+        }
+
+        // Empty scenes still get valid buffers to bind
+        auto vb_create_info = nvk::BufferCreateInfo()
+            .set_buffer_type(nvk::BufferType::eVertex)
+            .set_name(fmt::format("[{} Scene] Shared Vertices", name))
+            .set_size(std::max<vk::DeviceSize>(vertex_count * sizeof(Vertex), sizeof(Vertex)));
+        m_vertex_buffer = std::make_shared<nvk::Buffer>(vb_create_info, device);
+
+        auto ib_create_info = nvk::BufferCreateInfo()
+            .set_buffer_type(nvk::BufferType::eIndex)
+            .set_name(fmt::format("[{} Scene] Shared Indices", name))
+            .set_size(std::max<vk::DeviceSize>(index_count * sizeof(uint32_t), sizeof(uint32_t)));
+        m_index_buffer = std::make_shared<nvk::Buffer>(ib_create_info, device);
+
+        for (const auto& [key, mesh] : meshes)
+        {
+            const auto& range = m_ranges.at(mesh.get());
+            if (range.index_count == 0) continue;
+
+            const auto vertex_copy = vk::BufferCopy()
+                .setSize(mesh->vertex_count() * sizeof(Vertex))
+                .setDstOffset(range.vertex_offset * sizeof(Vertex));
+            upload_batch.copy(mesh->vertex_buffer(), m_vertex_buffer, vertex_copy);
+
+            const auto index_copy = vk::BufferCopy()
+                .setSize(range.index_count * sizeof(uint32_t))
+                .setDstOffset(range.first_index * sizeof(uint32_t));
+            upload_batch.copy(mesh->index_buffer(), m_index_buffer, index_copy);
+        }
+    }
+
+    void SceneGeometry::bind(const vk::CommandBuffer& command_buffer) const
+    {
+        static constexpr vk::DeviceSize offset = 0;
+        command_buffer.bindVertexBuffers(0, 1, &m_vertex_buffer->buffer(), &offset);
+        command_buffer.bindIndexBuffer(m_index_buffer->buffer(), 0, vk::IndexType::eUint32);
+    }
+
+    const MeshRange& SceneGeometry::range(const Mesh& mesh) const
+    {
+        if (const auto it = m_ranges.find(&mesh); it != m_ranges.end())
+        {
+            return it->second;
+        }
+
+        throw nlog::make_exception("Mesh \"{}\" is not part of the shared scene geometry", mesh.name());
+    }
+}
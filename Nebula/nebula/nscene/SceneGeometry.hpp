@@ -0,0 +1,49 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vulkan/vulkan.hpp>
+#include <nscene/geometry/Mesh.hpp>
+#include <nvk/Buffer.hpp>
+#include <nvk/Device.hpp>
+#include <nvk/UploadBatch.hpp>
+
+namespace Nebula::ns
+{
+    // Location of a mesh inside the shared vertex & index buffers, as used by vk::DrawIndexedIndirectCommand
+    struct MeshRange
+    {
+        uint32_t first_index {0};
+        int32_t  vertex_offset {0};
+        uint32_t index_count {0};
+    };
+
+    /**
+     * Vertex & index data of every mesh of a scene in one vertex and one index buffer, so any set of objects can be
+     * drawn without rebinding buffers. The data is copied from the buffers of the meshes on the GPU, the copies are
+     * recorded into the upload batch & the buffers can be used once it was submitted.
+     */
+    class SceneGeometry
+    {
+    public:
+        SceneGeometry(const std::map<std::string, std::shared_ptr<Mesh>>& meshes,
+                      const std::string& name,
+                      const std::shared_ptr<nvk::Device>& device,
+                      nvk::UploadBatch& upload_batch);
+
+        void bind(const vk::CommandBuffer& command_buffer) const;
+
+        const MeshRange& range(const Mesh& mesh) const;
+
+        const nvk::Buffer& vertex_buffer() const { return *m_vertex_buffer; }
+
+        const nvk::Buffer& index_buffer() const { return *m_index_buffer; }
+
+    private:
+        std::unordered_map<const Mesh*, MeshRange>  m_ranges;
+        std::shared_ptr<nvk::Buffer>                m_vertex_buffer;
+        std::shared_ptr<nvk::Buffer>                m_index_buffer;
+    };
+}
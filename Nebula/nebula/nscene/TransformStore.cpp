@@ -0,0 +1,278 @@
+#include "TransformStore.hpp"
+#include <array>
+#include <cmath>
+#include <nlog/nlog.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define NEBULA_TRANSFORM_SSE
+#include <emmintrin.h>
+#endif
+
+namespace Nebula::ns
+{
+    namespace
+    {
+        using Lane = std::array<float, TransformStore::s_batch_size>;
+
+        // Columns of R * S for a batch of nodes, R = glm::yawPitchRoll(euler.y, euler.x, euler.z)
+        struct LocalBatch
+        {
+            Lane sin_x, cos_x, sin_y, cos_y, sin_z, cos_z;
+            Lane scale_x, scale_y, scale_z;
+            Lane c0x, c0y, c0z, c1x, c1y, c1z, c2x, c2y, c2z;
+
+            // Branch free over contiguous lanes, left to the compiler to vectorize
+            void compose(const size_t count)
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    const float sp = sin_x[i], cp = cos_x[i];
+                    const float sw = sin_y[i], cw = cos_y[i];
+                    const float sr = sin_z[i], cr = cos_z[i];
+
+                    c0x[i] = (cw * cr + sw * sp * sr) * scale_x[i];
+                    c0y[i] = (sr * cp) * scale_x[i];
+                    c0z[i] = (-sw * cr + cw * sp * sr) * scale_x[i];
+
+                    c1x[i] = (-cw * sr + sw * sp * cr) * scale_y[i];
+                    c1y[i] = (cr * cp) * scale_y[i];
+                    c1z[i] = (sr * sw + cw * sp * cr) * scale_y[i];
+
+                    c2x[i] = (sw * cp) * scale_z[i];
+                    c2y[i] = (-sp) * scale_z[i];
+                    c2z[i] = (cw * cp) * scale_z[i];
+                }
+            }
+        };
+
+        // out = parent * local, out may not alias the inputs
+        void multiply(const glm::mat4& parent, const glm::mat4& local, glm::mat4& out)
+        {
+#ifdef NEBULA_TRANSFORM_SSE
+            const __m128 p0 = _mm_loadu_ps(&parent[0][0]);
+            const __m128 p1 = _mm_loadu_ps(&parent[1][0]);
+            const __m128 p2 = _mm_loadu_ps(&parent[2][0]);
+            const __m128 p3 = _mm_loadu_ps(&parent[3][0]);
+            for (int32_t c = 0; c < 4; c++)
+            {
+                __m128 column = _mm_mul_ps(p0, _mm_set1_ps(local[c][0]));
+                column = _mm_add_ps(column, _mm_mul_ps(p1, _mm_set1_ps(local[c][1])));
+                column = _mm_add_ps(column, _mm_mul_ps(p2, _mm_set1_ps(local[c][2])));
+                column = _mm_add_ps(column, _mm_mul_ps(p3, _mm_set1_ps(local[c][3])));
+                _mm_storeu_ps(&out[c][0], column);
+            }
+#else
+            out = parent * local;
+#endif
+        }
+    }
+
+    TransformStore::TransformStore(const uint32_t thread_count)
+    : m_thread_pool(std::max(thread_count, 1u))
+    {
+    }
+
+    uint32_t TransformStore::add(const nmath::Transform& local)
+    {
+        const auto node = static_cast<uint32_t>(m_parent.size());
+        m_translate.push_back(local.translate);
+        m_scale.push_back(local.scale);
+        m_euler.push_back(local.euler);
+        m_parent.push_back(s_no_parent);
+
+        m_local.emplace_back(1.0f);
+        m_world.emplace_back(1.0f);
+        m_world3x4.emplace_back();
+
+        m_local_dirty.push_back(1);
+        m_world_dirty.push_back(1);
+        m_updated.push_back(0);
+        m_any_dirty = true;
+        m_hierarchy_dirty = true;
+        return node;
+    }
+
+    void TransformStore::set_local(const uint32_t node, const nmath::Transform& local)
+    {
+        m_translate.set(node, local.translate);
+        m_scale.set(node, local.scale);
+        m_euler.set(node, local.euler);
+
+        m_local_dirty[node] = 1;
+        m_world_dirty[node] = 1;
+        m_any_dirty = true;
+    }
+
+    void TransformStore::set_parent(const uint32_t node, const uint32_t parent)
+    {
+        if (node >= size() || (parent != s_no_parent && parent >= size()))
+        {
+            throw nlog::make_exception("Transform node {} can't have parent {}, there are {} nodes", node, parent, size());
+        }
+        if (m_parent[node] == parent) return;
+
+        m_parent[node] = parent;
+        m_world_dirty[node] = 1;
+        m_any_dirty = true;
+        m_hierarchy_dirty = true;
+    }
+
+    nmath::Transform TransformStore::local(const uint32_t node) const
+    {
+        return {
+            .translate = m_translate.get(node),
+            .scale     = m_scale.get(node),
+            .euler     = m_euler.get(node),
+        };
+    }
+
+    uint32_t TransformStore::update()
+    {
+        for (const uint32_t node : m_changed)
+        {
+            m_updated[node] = 0;
+        }
+        m_changed.clear();
+        m_update_count++;
+
+        if (!m_any_dirty) return 0;
+        if (m_hierarchy_dirty)
+        {
+            rebuild_levels();
+        }
+
+        // A level only reads the matrices & updated flags of the level above, which are final by then
+        for (const auto& level : m_levels)
+        {
+            m_pending.clear();
+            for (const uint32_t node : level)
+            {
+                const uint32_t parent = m_parent[node];
+                if (m_world_dirty[node] || (parent != s_no_parent && m_updated[parent]))
+                {
+                    m_pending.push_back(node);
+                }
+            }
+            if (m_pending.empty()) continue;
+
+            const size_t batch_count = (m_pending.size() + s_batch_size - 1) / s_batch_size;
+            m_thread_pool.parallel_for(batch_count, [&](const size_t batch) {
+                const size_t first = batch * s_batch_size;
+                update_batch(std::span(m_pending).subspan(first, std::min(s_batch_size, m_pending.size() - first)));
+            });
+            m_changed.insert(m_changed.end(), m_pending.begin(), m_pending.end());
+        }
+
+        m_any_dirty = false;
+        return static_cast<uint32_t>(m_changed.size());
+    }
+
+    void TransformStore::update_batch(const std::span<const uint32_t> nodes)
+    {
+        // Gather the nodes with a changed local transform into the lanes
+        std::array<uint32_t, s_batch_size> local_nodes {};
+        LocalBatch batch;
+        size_t count = 0;
+        for (const uint32_t node : nodes)
+        {
+            if (!m_local_dirty[node]) continue;
+            batch.sin_x[count] = std::sin(m_euler.x[node]);
+            batch.cos_x[count] = std::cos(m_euler.x[node]);
+            batch.sin_y[count] = std::sin(m_euler.y[node]);
+            batch.cos_y[count] = std::cos(m_euler.y[node]);
+            batch.sin_z[count] = std::sin(m_euler.z[node]);
+            batch.cos_z[count] = std::cos(m_euler.z[node]);
+            batch.scale_x[count] = m_scale.x[node];
+            batch.scale_y[count] = m_scale.y[node];
+            batch.scale_z[count] = m_scale.z[node];
+            local_nodes[count++] = node;
+        }
+
+        batch.compose(count);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            const uint32_t node = local_nodes[i];
+            auto& m = m_local[node];
+            m[0] = glm::vec4(batch.c0x[i], batch.c0y[i], batch.c0z[i], 0.0f);
+            m[1] = glm::vec4(batch.c1x[i], batch.c1y[i], batch.c1z[i], 0.0f);
+            m[2] = glm::vec4(batch.c2x[i], batch.c2y[i], batch.c2z[i], 0.0f);
+            m[3] = glm::vec4(m_translate.x[node], m_translate.y[node], m_translate.z[node], 1.0f);
+            m_local_dirty[node] = 0;
+        }
+
+        for (const uint32_t node : nodes)
+        {
+            const uint32_t parent = m_parent[node];
+            if (parent == s_no_parent)
+            {
+                m_world[node] = m_local[node];
+            }
+            else
+            {
+                multiply(m_world[parent], m_local[node], m_world[node]);
+            }
+            m_world3x4[node] = nmath::Transform::to_3x4(m_world[node]);
+            m_world_dirty[node] = 0;
+            m_updated[node] = 1;
+        }
+    }
+
+    void TransformStore::rebuild_levels()
+    {
+        // Depth of every node, walking up until a node of known depth or a root
+        constexpr uint32_t unknown = std::numeric_limits<uint32_t>::max();
+        std::vector<uint32_t> depth(size(), unknown);
+        std::vector<uint32_t> chain;
+        for (uint32_t node = 0; node < size(); node++)
+        {
+            chain.clear();
+            uint32_t current = node;
+            while (current != s_no_parent && depth[current] == unknown)
+            {
+                if (chain.size() > size())
+                {
+                    throw nlog::make_exception("Transform hierarchy has a cycle through node {}", node);
+                }
+                chain.push_back(current);
+                current = m_parent[current];
+            }
+
+            uint32_t next_depth = (current == s_no_parent) ? 0 : depth[current] + 1;
+            for (auto it = chain.rbegin(); it != chain.rend(); ++it)
+            {
+                depth[*it] = next_depth++;
+            }
+        }
+
+        m_levels.clear();
+        for (uint32_t node = 0; node < size(); node++)
+        {
+            if (depth[node] >= m_levels.size())
+            {
+                m_levels.resize(depth[node] + 1);
+            }
+            m_levels[depth[node]].push_back(node);
+        }
+        m_hierarchy_dirty = false;
+    }
+
+    void TransformStore::clear()
+    {
+        m_translate.clear();
+        m_scale.clear();
+        m_euler.clear();
+        m_parent.clear();
+        m_local.clear();
+        m_world.clear();
+        m_world3x4.clear();
+        m_local_dirty.clear();
+        m_world_dirty.clear();
+        m_updated.clear();
+        m_levels.clear();
+        m_pending.clear();
+        m_changed.clear();
+        m_any_dirty = false;
+        m_hierarchy_dirty = false;
+    }
+}
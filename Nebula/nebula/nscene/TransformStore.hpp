@@ -0,0 +1,104 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <thread>
+#include <vector>
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.hpp>
+#include <ncommon/ThreadPool.hpp>
+#include <nmath/Transform.hpp>
+
+namespace Nebula::ns
+{
+    /**
+     * Local transforms of a node hierarchy in SoA arrays with cached world matrices.
+     * Changing the local transform or the parent of a node marks it dirty, update recomputes the world matrices of the
+     * dirty nodes & their descendants only. Nodes are updated level by level from the roots down, the nodes of a level
+     * don't depend on each other and are split into batches updated in parallel. The local matrices of a batch are
+     * composed in plain loops over the SoA arrays for the compiler to vectorize, parents are applied with SSE.
+     */
+    class TransformStore
+    {
+        // One array per component of a vec3
+        struct Vec3Array
+        {
+            std::vector<float> x, y, z;
+
+            void push_back(const glm::vec3& v) { x.push_back(v.x); y.push_back(v.y); z.push_back(v.z); }
+
+            void set(const size_t i, const glm::vec3& v) { x[i] = v.x; y[i] = v.y; z[i] = v.z; }
+
+            glm::vec3 get(const size_t i) const { return { x[i], y[i], z[i] }; }
+
+            void clear() { x.clear(); y.clear(); z.clear(); }
+        };
+
+    public:
+        explicit TransformStore(uint32_t thread_count = std::max(std::thread::hardware_concurrency(), 1u));
+
+        // Adds a root node & returns its index
+        uint32_t add(const nmath::Transform& local);
+
+        void set_local(uint32_t node, const nmath::Transform& local);
+
+        // Places the node relative to the parent, s_no_parent makes it a root. Cycles are reported by the next update
+        void set_parent(uint32_t node, uint32_t parent);
+
+        nmath::Transform local(uint32_t node) const;
+
+        uint32_t parent(uint32_t node) const { return m_parent[node]; }
+
+        // Recomputes the world matrices of the dirty nodes & their descendants, returns the number of updated nodes
+        uint32_t update();
+
+        const glm::mat4& world(uint32_t node) const { return m_world[node]; }
+
+        const vk::TransformMatrixKHR& world3x4(uint32_t node) const { return m_world3x4[node]; }
+
+        // Nodes whose world matrix was recomputed by the last update, parents before their children
+        std::span<const uint32_t> changed() const { return m_changed; }
+
+        // Number of updates so far, a consumer that skipped one can't catch up from changed() alone
+        uint64_t update_count() const { return m_update_count; }
+
+        size_t size() const { return m_parent.size(); }
+
+        void clear();
+
+        static constexpr uint32_t s_no_parent = std::numeric_limits<uint32_t>::max();
+
+        static constexpr size_t   s_batch_size = 256;
+
+    private:
+        void rebuild_levels();
+
+        void update_batch(std::span<const uint32_t> nodes);
+
+        ThreadPool                          m_thread_pool;
+
+        Vec3Array                           m_translate;
+        Vec3Array                           m_scale;
+        Vec3Array                           m_euler;
+        std::vector<uint32_t>               m_parent;
+
+        std::vector<glm::mat4>              m_local;
+        std::vector<glm::mat4>              m_world;
+        std::vector<vk::TransformMatrixKHR> m_world3x4;
+
+        // Local matrix out of date / world matrix out of date / world matrix recomputed by the current update
+        std::vector<uint8_t>                m_local_dirty;
+        std::vector<uint8_t>                m_world_dirty;
+        std::vector<uint8_t>                m_updated;
+        bool                                m_any_dirty {false};
+        bool                                m_hierarchy_dirty {false};
+
+        // Nodes grouped by their depth in the hierarchy, roots first
+        std::vector<std::vector<uint32_t>>  m_levels;
+        std::vector<uint32_t>               m_pending;
+        std::vector<uint32_t>               m_changed;
+        uint64_t                            m_update_count {0};
+    };
+}
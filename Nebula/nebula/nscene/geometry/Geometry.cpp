@@ -8,6 +8,12 @@ namespace Nebula::ns
     {
     }
 
+    Geometry::Geometry(std::vector<Vertex>&& vertices, std::vector<uint32_t>&& indices)
+    : m_vertices(std::move(vertices)), m_vertex_count(static_cast<uint32_t>(m_vertices.size()))
+    , m_indices(std::move(indices)), m_index_count(static_cast<uint32_t>(m_indices.size()))
+    {
+    }
+
     const std::vector<Vertex>& Geometry::vertices() const
     {
         return m_vertices;
@@ -14,6 +14,8 @@ namespace Nebula::ns
 
         Geometry(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices);
 
+        Geometry(std::vector<Vertex>&& vertices, std::vector<uint32_t>&& indices);
+
         virtual ~Geometry() = default;
 
         const std::vector<Vertex>&   vertices() const;
@@ -13,52 +13,94 @@ namespace Nebula::ns
     : m_name(create_info.name)
     , m_vertex_count(create_info.p_geometry->vertex_count())
     , m_index_count(create_info.p_geometry->index_count())
+    {
+        for (const auto& vertex : create_info.p_geometry->vertices())
+        {
+            m_bounds.expand(vertex.position);
+        }
+
+        const MeshDataView data = { create_info.p_geometry->vertices(), create_info.p_geometry->indices() };
+        if (create_info.occluder)
+        {
+            m_occluder = std::make_shared<OccluderGeometry>(OccluderGeometry::from(data));
+        }
+
+        nvk::UploadBatch upload_batch(device, command_pool);
+        create_buffers(data, device, upload_batch);
+        upload_batch.submit();
+
+        if (device->is_raytracing_enabled())
+        {
+            create_blas(device, command_pool);
+        }
+    }
+
+    Mesh::Mesh(const MeshCreateInfo& create_info,
+               const std::shared_ptr<nvk::Device>& device,
+               nvk::UploadBatch& upload_batch)
+    : m_name(create_info.name)
+    , m_vertex_count(create_info.p_geometry->vertex_count())
+    , m_index_count(create_info.p_geometry->index_count())
+    {
+        for (const auto& vertex : create_info.p_geometry->vertices())
+        {
+            m_bounds.expand(vertex.position);
+        }
+
+        const MeshDataView data = { create_info.p_geometry->vertices(), create_info.p_geometry->indices() };
+        if (create_info.occluder)
+        {
+            m_occluder = std::make_shared<OccluderGeometry>(OccluderGeometry::from(data));
+        }
+
+        create_buffers(data, device, upload_batch);
+    }
+
+    Mesh::Mesh(const std::string& name,
+               const MeshDataView& data,
+               const nmath::AABB& bounds,
+               const std::shared_ptr<nvk::Device>& device,
+               nvk::UploadBatch& upload_batch)
+    : m_name(name)
+    , m_vertex_count(static_cast<uint32_t>(data.vertices.size()))
+    , m_index_count(static_cast<uint32_t>(data.indices.size()))
+    , m_bounds(bounds)
+    {
+        create_buffers(data, device, upload_batch);
+    }
+
+    void Mesh::create_buffers(const MeshDataView& data,
+                              const std::shared_ptr<nvk::Device>& device,
+                              nvk::UploadBatch& upload_batch)
     {
         auto name = fmt::format("[Mesh] {}", m_name);
 
         auto vb_create_info = nvk::BufferCreateInfo()
             .set_buffer_type(nvk::BufferType::eVertex)
             .set_name(name)
-            .set_size(sizeof(Vertex) * create_info.p_geometry->vertex_count());
+            .set_size(data.vertices.size_bytes());
         m_vertex_buffer = std::make_shared<nvk::Buffer>(vb_create_info, device);
-
-        auto vbstgci = nvk::BufferCreateInfo()
-            .set_buffer_type(nvk::BufferType::eStaging)
-            .set_name(name)
-            .set_size(vb_create_info.size);
-        auto vb_staging = std::make_shared<nvk::Buffer>(vbstgci, device);
-        vb_staging->set_data(create_info.p_geometry->vertices().data());
+        upload_batch.upload(m_vertex_buffer, data.vertices.data(), vb_create_info.size);
 
         auto ib_create_info = nvk::BufferCreateInfo()
             .set_buffer_type(nvk::BufferType::eIndex)
             .set_name(name)
-            .set_size(sizeof(uint32_t) * create_info.p_geometry->index_count());
+            .set_size(data.indices.size_bytes());
         m_index_buffer = std::make_shared<nvk::Buffer>(ib_create_info, device);
+        upload_batch.upload(m_index_buffer, data.indices.data(), ib_create_info.size);
+    }
 
-        auto ibstgci = nvk::BufferCreateInfo()
-            .set_buffer_type(nvk::BufferType::eStaging)
-            .set_name(name)
-            .set_size(ib_create_info.size);
-        auto ib_staging = std::make_shared<nvk::Buffer>(ibstgci, device);
-        ib_staging->set_data(create_info.p_geometry->indices().data());
-
-        command_pool->exec_single_time_command([&](const vk::CommandBuffer& command_buffer){
-            vb_staging->copy_to_buffer(*m_vertex_buffer, command_buffer);
-            ib_staging->copy_to_buffer(*m_index_buffer, command_buffer);
-        });
+    void Mesh::create_blas(const std::shared_ptr<nvk::Device>& device, const std::shared_ptr<nvk::CommandPool>& command_pool)
+    {
+        auto blas_create_info = nvk::BLASCreateInfo()
+            .set_vertex_buffer(m_vertex_buffer)
+            .set_vertex_count(m_vertex_count)
+            .set_vertex_stride(sizeof(Vertex))
+            .set_index_buffer(m_index_buffer)
+            .set_index_count(m_index_count)
+            .set_name(m_name);
 
-        if (device->is_raytracing_enabled())
-        {
-            auto blas_create_info = nvk::BLASCreateInfo()
-                .set_vertex_buffer(m_vertex_buffer)
-                .set_vertex_count(m_vertex_count)
-                .set_vertex_stride(sizeof(Vertex))
-                .set_index_buffer(m_index_buffer)
-                .set_index_count(m_index_count)
-                .set_name(m_name);
-
-            m_blas = nvk::BLAS::create(blas_create_info, device, command_pool);
-        }
+        m_blas = nvk::BLAS::create(blas_create_info, device, command_pool);
     }
 
     void Mesh::update(const vk::CommandBuffer& command_buffer)
@@ -1,11 +1,15 @@
 #pragma once
 
 #include <memory>
+#include <span>
 #include <string>
+#include <vector>
+#include <nmath/AABB.hpp>
 #include <nscene/geometry/Geometry.hpp>
 #include <nvk/Buffer.hpp>
 #include <nvk/Command.hpp>
 #include <nvk/Device.hpp>
+#include <nvk/UploadBatch.hpp>
 #include <nvk/rt/BLAS.hpp>
 
 namespace Nebula::ns
@@ -16,6 +20,7 @@ namespace Nebula::ns
         std::string name {"Unknown Mesh"};
         bool        create_meshlet {false};
         bool        create_blas {false};
+        bool        occluder {false};
         uint32_t    meshlet_vertex_limit {64};
         uint32_t    meshlet_index_limit {126};
 
@@ -33,6 +38,13 @@ namespace Nebula::ns
             return *this;
         }
 
+        // Keeps the triangles on the CPU for software occlusion culling
+        MeshCreateInfo& set_occluder(bool value)
+        {
+            occluder = value;
+            return *this;
+        }
+
         MeshCreateInfo& set_meshlet_vertex_limit(uint32_t value)
         {
             meshlet_vertex_limit = value;
@@ -46,6 +58,32 @@ namespace Nebula::ns
         }
     };
 
+    // Non-owning vertex & index data, e.g. of a Geometry or a memory mapped scene cache
+    struct MeshDataView
+    {
+        std::span<const Vertex>   vertices;
+        std::span<const uint32_t> indices;
+    };
+
+    // Object space triangles of an occluder, positions only
+    struct OccluderGeometry
+    {
+        std::vector<glm::vec3> positions;
+        std::vector<uint32_t>  indices;
+
+        static OccluderGeometry from(const MeshDataView& data)
+        {
+            OccluderGeometry result;
+            result.positions.reserve(data.vertices.size());
+            for (const auto& vertex : data.vertices)
+            {
+                result.positions.push_back(vertex.position);
+            }
+            result.indices.assign(data.indices.begin(), data.indices.end());
+            return result;
+        }
+    };
+
     struct MeshBufferPointers
     {
         uint64_t index_buffer;
@@ -61,8 +99,23 @@ namespace Nebula::ns
              const std::shared_ptr<nvk::Device>& device,
              const std::shared_ptr<nvk::CommandPool>& command_pool);
 
+        // Only records the uploads, the buffers & the BLAS are usable after the batch was submitted
+        Mesh(const MeshCreateInfo& create_info,
+             const std::shared_ptr<nvk::Device>& device,
+             nvk::UploadBatch& upload_batch);
+
+        // Data is copied into staging memory right away, with precomputed bounds
+        Mesh(const std::string& name,
+             const MeshDataView& data,
+             const nmath::AABB& bounds,
+             const std::shared_ptr<nvk::Device>& device,
+             nvk::UploadBatch& upload_batch);
+
         virtual ~Mesh() = default;
 
+        // Builds the BLAS of meshes created from an UploadBatch, once it was submitted
+        void create_blas(const std::shared_ptr<nvk::Device>& device, const std::shared_ptr<nvk::CommandPool>& command_pool);
+
         virtual void update(const vk::CommandBuffer& command_buffer);
 
         virtual void draw(const vk::CommandBuffer& command_buffer) const;
@@ -70,8 +123,16 @@ namespace Nebula::ns
         const std::string& name() const { return m_name; }
         const nvk::Buffer& vertex_buffer() const { return *m_vertex_buffer; }
         const nvk::Buffer& index_buffer() const { return *m_index_buffer; }
+        uint32_t vertex_count() const { return m_vertex_count; }
+        uint32_t index_count() const { return m_index_count; }
         const std::shared_ptr<nvk::BLAS> bottom_level_as() const { return m_blas; }
 
+        // Object space bounds of the vertices, invalid for meshes without geometry
+        const nmath::AABB& bounds() const { return m_bounds; }
+
+        // Triangles for software occlusion culling, null unless the mesh was created as an occluder
+        const OccluderGeometry* occluder() const { return m_occluder.get(); }
+
         inline MeshBufferPointers get_buffer_pointers() const
         {
             return {
@@ -81,11 +142,17 @@ namespace Nebula::ns
         }
 
     protected:
-        const std::string               m_name;
-        uint32_t                        m_vertex_count {0};
-        std::shared_ptr<nvk::Buffer>    m_vertex_buffer;
-        uint32_t                        m_index_count {0};
-        std::shared_ptr<nvk::Buffer>    m_index_buffer;
-        std::shared_ptr<nvk::BLAS>      m_blas;
+        void create_buffers(const MeshDataView& data,
+                            const std::shared_ptr<nvk::Device>& device,
+                            nvk::UploadBatch& upload_batch);
+
+        const std::string                 m_name;
+        uint32_t                          m_vertex_count {0};
+        std::shared_ptr<nvk::Buffer>      m_vertex_buffer;
+        uint32_t                          m_index_count {0};
+        std::shared_ptr<nvk::Buffer>      m_index_buffer;
+        std::shared_ptr<nvk::BLAS>        m_blas;
+        nmath::AABB                       m_bounds;
+        std::shared_ptr<OccluderGeometry> m_occluder;
     };
 }
\ No newline at end of file
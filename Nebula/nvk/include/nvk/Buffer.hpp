@@ -10,6 +10,8 @@
 
 namespace Nebula::nvk
 {
+    class UploadBatch;
+
     enum class BufferType
     {
         eCustom,
@@ -88,18 +90,16 @@ namespace Nebula::nvk
                                                         const std::shared_ptr<CommandPool>& command_pool)
         {
             auto buffer = std::make_shared<Buffer>(create_info, device);
-            auto staging_create_info = BufferCreateInfo()
-                .set_buffer_type(BufferType::eStaging)
-                .set_name(create_info.name)
-                .set_size(create_info.size);
-            auto staging = std::make_shared<Buffer>(staging_create_info, device);
-            staging->set_data(p_data);
-            command_pool->exec_single_time_command([&](const vk::CommandBuffer& command_buffer){
-                staging->copy_to_buffer(*buffer, command_buffer);
-            });
+            command_pool->upload(*buffer, p_data, create_info.size);
             return buffer;
         }
 
+        // Records the upload into the batch instead of submitting it, the buffer can be used once the batch is submitted
+        static std::shared_ptr<Buffer> create_with_data(const BufferCreateInfo& create_info,
+                                                        const void* p_data,
+                                                        const std::shared_ptr<Device>& device,
+                                                        UploadBatch& upload_batch);
+
         template <typename T>
         void set_data(T* p_data)
         {
@@ -118,6 +118,14 @@ namespace Nebula::nvk
             m_allocation->unmap();
         }
 
+        // Copies exactly data_size bytes, for data that isn't a single object of the size of the buffer
+        void set_data(const void* p_data, vk::DeviceSize data_size);
+
+        // For persistently mapped buffers, every map() needs a matching unmap()
+        void* map() { return m_allocation->map(); }
+
+        void unmap() { m_allocation->unmap(); }
+
         void copy_to_buffer(const Buffer& dst, const vk::CommandBuffer& command_buffer);
 
         void copy_to_image(const Image& dst, const vk::CommandBuffer& command_buffer);
@@ -16,6 +16,9 @@
 
 namespace Nebula::nvk
 {
+    class Buffer;
+    class StagingRing;
+
     class CommandRing : public Ring<vk::CommandBuffer>
     {
     public:
@@ -70,6 +73,12 @@ namespace Nebula::nvk
         void exec_single_time_command(const std::function<void(const vk::CommandBuffer&)>& commands,
                                       std::optional<uint32_t> queue_family = std::nullopt);
 
+        // Persistent staging ring on the default queue, created on first use
+        StagingRing& staging_ring();
+
+        // Upload through the staging ring, returns once the copy completed. Use an UploadBatch for many buffers
+        void upload(const Buffer& dst, const void* p_data, vk::DeviceSize data_size);
+
     private:
         const vk::CommandPool& get_pool(uint32_t family_index);
 
@@ -79,5 +88,8 @@ namespace Nebula::nvk
         std::shared_ptr<Device>                     m_device;
         std::map<uint32_t, vk::CommandPool>         m_pools;
         std::map<uint32_t, std::shared_ptr<Queue>>  m_queues;
+        std::shared_ptr<StagingRing>                m_staging_ring;
+
+        static constexpr vk::DeviceSize             s_staging_ring_size = 64 * 1024 * 1024;
     };
 }
\ No newline at end of file
@@ -61,6 +61,7 @@ namespace Nebula::nvk
         vk::DeviceMemory                          memory {};
         const vk::DeviceSize                      size {};
         const vk::DeviceSize                      offset {0};
+        uint32_t                                  memory_type {0};
 
     private:
         const uint32_t                            m_id;
@@ -19,6 +19,9 @@ namespace Nebula::nvk
         vk::ImageTiling         tiling {vk::ImageTiling::eOptimal};
         vk::ImageUsageFlags     usage_flags {vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eSampled};
 
+        // Bind the image to the memory of an existing allocation instead of allocating (memory aliasing)
+        std::shared_ptr<Allocation> memory_alias {};
+
         struct_param(bool, with_sampler, false);
 
         ImageCreateInfo() = default;
@@ -71,6 +74,12 @@ namespace Nebula::nvk
             return *this;
         }
 
+        inline ImageCreateInfo& set_memory_alias(const std::shared_ptr<Allocation>& value)
+        {
+            memory_alias = value;
+            return *this;
+        }
+
     };
 
     struct ImageProperties
@@ -84,8 +93,9 @@ namespace Nebula::nvk
 
     struct ImageState
     {
-        vk::AccessFlags2 access_flags { vk::AccessFlagBits2::eNone };
-        vk::ImageLayout  layout { vk::ImageLayout::eUndefined };
+        vk::AccessFlags2        access_flags { vk::AccessFlagBits2::eNone };
+        vk::ImageLayout         layout { vk::ImageLayout::eUndefined };
+        vk::PipelineStageFlags2 stage_flags { vk::PipelineStageFlagBits2::eNone };
     };
 
     class Image
@@ -109,6 +119,10 @@ namespace Nebula::nvk
 
         const vk::Sampler& default_sampler() const { return m_sampler; }
 
+        const std::shared_ptr<Allocation>& allocation() const { return m_allocation; }
+
+        bool is_memory_alias() const { return !m_owns_allocation; }
+
         static inline std::shared_ptr<Image> create(const ImageCreateInfo& create_info,
                                                     const std::shared_ptr<Device>& device)
         {
@@ -119,6 +133,7 @@ namespace Nebula::nvk
         static ImageProperties get_properties(const ImageCreateInfo& create_info);
 
         std::shared_ptr<Allocation> m_allocation;
+        bool                        m_owns_allocation {true};
         vk::Image                   m_image;
         vk::ImageView               m_image_view;
         vk::Sampler                 m_sampler;
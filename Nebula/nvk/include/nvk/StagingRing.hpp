@@ -0,0 +1,89 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vulkan/vulkan.hpp>
+#include "Buffer.hpp"
+#include "Device.hpp"
+#include "Queue.hpp"
+#include "Utility.hpp"
+
+namespace Nebula::nvk
+{
+    /**
+     * Persistently mapped staging buffer used as a ring, data is copied in and the buffer copies are recorded right away.
+     * Recorded copies go out in a single submission on flush(), tracked by a fence instead of idling the queue.
+     * Two submissions can be in flight, space of a submission is reclaimed once its fence signaled.
+     * Uploads larger than the ring are split into several copies.
+     */
+    class StagingRing
+    {
+    public:
+        NVK_DISABLE_COPY(StagingRing);
+
+        StagingRing(vk::DeviceSize size,
+                    const vk::CommandPool& command_pool,
+                    const std::shared_ptr<Queue>& queue,
+                    const std::shared_ptr<Device>& device);
+
+        ~StagingRing();
+
+        void upload(const Buffer& dst, const void* p_data, vk::DeviceSize data_size, vk::DeviceSize dst_offset = 0);
+
+        // Records a copy between device buffers, ordered after every upload recorded or submitted before it
+        void copy(const Buffer& src, const Buffer& dst, const vk::BufferCopy& region);
+
+        // Submits the recorded copies without waiting for them
+        void flush();
+
+        // Blocks until every flushed submission completed
+        void wait();
+
+        void submit()
+        {
+            flush();
+            wait();
+        }
+
+        bool empty() const { return !m_recording; }
+
+        vk::DeviceSize size() const { return m_size; }
+
+        uint64_t submission_count() const { return m_submission_count; }
+
+    private:
+        struct Submission
+        {
+            vk::CommandBuffer   command_buffer;
+            vk::Fence           fence;
+            vk::DeviceSize      bytes {0};      // Ring space used, including padding & wrap around
+            bool                in_flight {false};
+        };
+
+        // Returns the ring offset of size bytes, waits for in flight submissions if the ring is full
+        vk::DeviceSize allocate(vk::DeviceSize size);
+
+        void retire(Submission& submission);
+
+        void begin_recording();
+
+        std::shared_ptr<Buffer>     m_staging;
+        uint8_t*                    m_mapped {nullptr};
+        vk::DeviceSize              m_size {0};
+        vk::DeviceSize              m_head {0};
+        vk::DeviceSize              m_used {0};
+
+        std::array<Submission, 2>   m_submissions;
+        uint32_t                    m_current {0};
+        bool                        m_recording {false};
+        bool                        m_transfer_barrier {false};
+        uint64_t                    m_submission_count {0};
+
+        std::shared_ptr<Queue>      m_queue;
+        std::shared_ptr<Device>     m_device;
+        const vk::CommandPool&      m_pool;
+
+        static constexpr vk::DeviceSize s_alignment = 16;
+    };
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include "Buffer.hpp"
+#include "Command.hpp"
+#include "Device.hpp"
+#include "StagingRing.hpp"
+#include "Utility.hpp"
+
+namespace Nebula::nvk
+{
+    /**
+     * Group of buffer uploads recorded into the staging ring of the command pool.
+     * Data is copied into staging memory when the upload is added, the copies are submitted together on submit(),
+     * so the destination buffers must not be used before that. A batch larger than the ring is flushed early.
+     */
+    class UploadBatch
+    {
+    public:
+        NVK_DISABLE_COPY(UploadBatch);
+
+        UploadBatch(const std::shared_ptr<Device>& device, const std::shared_ptr<CommandPool>& command_pool);
+
+        void upload(const std::shared_ptr<Buffer>& dst, const void* p_data, vk::DeviceSize data_size);
+
+        // Copies between device buffers, submitted with the uploads & ordered after the ones added before it.
+        // Like the data of an upload, the source has to stay alive until the batch was submitted
+        void copy(const Buffer& src, const std::shared_ptr<Buffer>& dst, const vk::BufferCopy& region);
+
+        // Submits every pending upload, returns once they completed
+        void submit();
+
+        bool empty() const { return m_uploads.empty(); }
+
+        vk::DeviceSize pending_size() const { return m_pending_size; }
+
+        ~UploadBatch();
+
+    private:
+        std::vector<std::shared_ptr<Buffer>>    m_uploads;
+        vk::DeviceSize                          m_pending_size {0};
+        uint32_t                                m_copy_count {0};
+
+        std::shared_ptr<Device>                 m_device;
+        std::shared_ptr<CommandPool>            m_command_pool;
+    };
+}
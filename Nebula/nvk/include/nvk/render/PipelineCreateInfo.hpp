@@ -46,6 +46,9 @@ namespace Nebula::nvk
                                        vk::ShaderStageFlagBits shader_stage,
                                        const std::string& entry_point = "main");
 
+        // Sets a constant of the previously added shader of the given stage
+        PipelineCreateInfo& add_specialization_constant(vk::ShaderStageFlagBits shader_stage, uint32_t constant_id, uint32_t value);
+
         PipelineCreateInfo& configure_state(const std::function<void(PipelineState&)>& lambda);
 
         PipelineCreateInfo& add_attachment(bool enable_blending = false);
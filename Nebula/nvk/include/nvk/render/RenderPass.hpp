@@ -21,14 +21,20 @@ namespace Nebula::nvk
         RenderPassCreateInfo& add_attachment(const std::shared_ptr<Image>& image,
                                              vk::ImageLayout              final_layout = vk::ImageLayout::eColorAttachmentOptimal,
                                              vk::ClearColorValue          clear_value  = {0.0f, 0.0f, 0.0f, 1.0f},
-                                             vk::AttachmentLoadOp         load_op = vk::AttachmentLoadOp::eClear);
+                                             vk::AttachmentLoadOp         load_op = vk::AttachmentLoadOp::eClear,
+                                             vk::AttachmentStoreOp        store_op = vk::AttachmentStoreOp::eStore,
+                                             vk::ImageLayout              initial_layout = vk::ImageLayout::eUndefined);
 
         RenderPassCreateInfo& set_depth_attachment(vk::Format                 format,
                                                    vk::SampleCountFlagBits    sample_count = vk::SampleCountFlagBits::e1,
                                                    vk::ClearDepthStencilValue clear_value = {1.0f, 0});
 
         RenderPassCreateInfo& set_depth_attachment(const std::shared_ptr<Image>& depth_image,
-                                                   vk::ClearDepthStencilValue    clear_value = {1.0f, 0});
+                                                   vk::ClearDepthStencilValue    clear_value = {1.0f, 0},
+                                                   vk::AttachmentLoadOp          load_op = vk::AttachmentLoadOp::eClear,
+                                                   vk::AttachmentStoreOp         store_op = vk::AttachmentStoreOp::eDontCare,
+                                                   vk::ImageLayout               initial_layout = vk::ImageLayout::eUndefined,
+                                                   vk::ImageLayout               final_layout = vk::ImageLayout::eDepthStencilAttachmentOptimal);
 
         RenderPassCreateInfo& set_resolve_attachment(vk::Format              format,
                                                      vk::ImageLayout         final_layout = vk::ImageLayout::eColorAttachmentOptimal,
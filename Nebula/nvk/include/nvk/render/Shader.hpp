@@ -2,6 +2,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 #include <vulkan/vulkan.hpp>
 #include "../Device.hpp"
 #include "../Utility.hpp"
@@ -10,9 +11,11 @@ namespace Nebula::nvk
 {
     struct ShaderCreateInfo
     {
-        std::string             entry_point {"main"};
-        std::string             file_path {};
-        vk::ShaderStageFlagBits shader_stage {};
+        std::string                             entry_point {"main"};
+        std::string                             file_path {};
+        vk::ShaderStageFlagBits                 shader_stage {};
+        std::vector<vk::SpecializationMapEntry> specialization_entries {};
+        std::vector<uint32_t>                   specialization_data {};
 
         ShaderCreateInfo() = default;
 
@@ -33,6 +36,15 @@ namespace Nebula::nvk
             shader_stage = value;
             return *this;
         }
+
+        // 32-bit specialization constant (bool, int, uint or the bits of a float)
+        inline ShaderCreateInfo& add_specialization_constant(uint32_t constant_id, uint32_t value)
+        {
+            const auto offset = static_cast<uint32_t>(specialization_data.size() * sizeof(uint32_t));
+            specialization_entries.emplace_back(constant_id, offset, sizeof(uint32_t));
+            specialization_data.push_back(value);
+            return *this;
+        }
     };
 
     class Shader
@@ -47,9 +59,12 @@ namespace Nebula::nvk
     private:
         static std::vector<char> read_file(std::string const& file_path);
 
-        vk::ShaderModule        m_shader;
-        vk::ShaderStageFlagBits m_stage;
-        std::string             m_entry_point;
-        std::shared_ptr<Device> m_device;
+        vk::ShaderModule                        m_shader;
+        vk::ShaderStageFlagBits                 m_stage;
+        std::string                             m_entry_point;
+        std::vector<vk::SpecializationMapEntry> m_specialization_entries;
+        std::vector<uint32_t>                   m_specialization_data;
+        vk::SpecializationInfo                  m_specialization_info;
+        std::shared_ptr<Device>                 m_device;
     };
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <span>
 #include <string>
 #include <vector>
 #include <vulkan/vulkan.hpp>
@@ -23,15 +24,35 @@ namespace Nebula::nvk
     {
         const std::vector<TLASInstanceInfo>& instance_info;
         std::string name;
+        uint32_t frames_in_flight {2};  // Frames that can record updates while earlier ones are still executing
     };
 
     struct TLASUpdateInfo
     {
+        // Every instance, or only the changed ones if indices is set
         const std::vector<TLASInstanceInfo>& instance_info;
+        // Instance index of each entry of instance_info, empty if instance_info holds every instance
+        std::span<const uint32_t> indices {};
+        // Frame in flight the command buffer is recorded for
+        uint32_t frame {0};
     };
 
+    /**
+     * Top-Level AS built for updates, with persistent instance, scratch & host staging buffers.
+     * Updates write the changed instances into the host copy of the frame, copy only those into the instance buffer
+     * and refit the TLAS in the command buffer. A different instance count rebuilds it in place instead, the buffers
+     * are only reallocated when the count grows past the capacity, which also changes the handle.
+     */
     class TLAS
     {
+        // Resources replaced by a reallocation, released once the frames using them completed
+        struct Retired
+        {
+            vk::AccelerationStructureKHR            tlas;
+            std::vector<std::shared_ptr<Buffer>>    buffers;
+            uint32_t                                frames_left {0};
+        };
+
     public:
         NVK_DISABLE_COPY(TLAS);
 
@@ -39,12 +60,16 @@ namespace Nebula::nvk
              const std::shared_ptr<Device>& device,
              const std::shared_ptr<CommandPool>& command_pool);
 
+        ~TLAS();
+
         void update(const TLASUpdateInfo& update_info);
 
         void update(const TLASUpdateInfo& update_info, const vk::CommandBuffer& command_buffer);
 
         const vk::AccelerationStructureKHR& handle() const { return m_tlas; }
 
+        uint32_t instance_count() const { return m_instance_count; }
+
         static inline std::shared_ptr<TLAS> create(const TLASCreateInfo& create_info,const std::shared_ptr<Device>& device,
                                                    const std::shared_ptr<CommandPool>& command_pool)
         {
@@ -52,14 +77,39 @@ namespace Nebula::nvk
         }
 
     private:
-        void build(const std::vector<TLASInstanceInfo>& geometry_info);
-
-        vk::AccelerationStructureKHR m_tlas;
-        std::shared_ptr<Buffer>      m_buffer;
-        std::shared_ptr<Buffer>      m_instance_data;
-        uint32_t                     m_instance_count {0};
-        std::shared_ptr<Device>      m_device;
-        std::shared_ptr<CommandPool> m_command_pool;
-        std::string                  m_name;
+        void allocate(uint32_t capacity);
+
+        // Writes every instance into the host copy of the frame & records a full build
+        void rebuild(const std::vector<TLASInstanceInfo>& instance_info, uint32_t frame, const vk::CommandBuffer& command_buffer);
+
+        // Copies the regions of the host copy into the instance buffer, then builds or refits from the instances
+        void record_build(vk::BuildAccelerationStructureModeKHR mode, uint32_t frame, const vk::CommandBuffer& command_buffer);
+
+        void release_retired();
+
+        static vk::AccelerationStructureInstanceKHR to_instance(const TLASInstanceInfo& instance_info);
+
+        static constexpr vk::BuildAccelerationStructureFlagsKHR s_build_flags = vk::BuildAccelerationStructureFlagBitsKHR::ePreferFastTrace
+                                                                              | vk::BuildAccelerationStructureFlagBitsKHR::eAllowUpdate;
+
+        vk::AccelerationStructureKHR                        m_tlas;
+        std::shared_ptr<Buffer>                             m_buffer;
+        std::shared_ptr<Buffer>                             m_instance_data;
+        std::shared_ptr<Buffer>                             m_scratch;
+        uint32_t                                            m_instance_count {0};
+        uint32_t                                            m_capacity {0};
+
+        // Host copy of the instances per frame in flight, persistently mapped
+        std::vector<std::shared_ptr<Buffer>>                m_staging;
+        std::vector<vk::AccelerationStructureInstanceKHR*>  m_staging_mapped;
+        std::vector<vk::AccelerationStructureInstanceKHR>   m_instances;
+        std::vector<uint32_t>                               m_changed;
+        std::vector<vk::BufferCopy>                         m_copy_regions;
+        std::vector<Retired>                                m_retired;
+        uint32_t                                            m_frames_in_flight {2};
+
+        std::shared_ptr<Device>                             m_device;
+        std::shared_ptr<CommandPool>                        m_command_pool;
+        std::string                                         m_name;
     };
-}
\ No newline at end of file
+}
@@ -32,7 +32,7 @@ namespace Nebula::nvk
 
     void ImageBarrier::apply(const vk::CommandBuffer& command_buffer)
     {
-        m_image->update_state({ vk::AccessFlagBits2::eNone, m_barrier.newLayout });
+        m_image->update_state({ m_barrier.dstAccessMask, m_barrier.newLayout, m_barrier.dstStageMask });
 
         m_dependency_info.setPImageMemoryBarriers(&m_barrier);
         command_buffer.pipelineBarrier2(&m_dependency_info);
@@ -44,7 +44,7 @@ namespace Nebula::nvk
     {
         if (!m_can_revert) return;
 
-        m_image->update_state({ vk::AccessFlagBits2::eNone, m_barrier.oldLayout });
+        m_image->update_state({ m_reverse_barrier.dstAccessMask, m_barrier.oldLayout, m_reverse_barrier.dstStageMask });
 
         m_dependency_info.setPImageMemoryBarriers(&m_reverse_barrier);
         command_buffer.pipelineBarrier2(&m_dependency_info);
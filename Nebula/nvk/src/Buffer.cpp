@@ -1,4 +1,5 @@
 #include "Buffer.hpp"
+#include "UploadBatch.hpp"
 #include "Utilities.hpp"
 
 namespace Nebula::nvk
@@ -64,6 +65,28 @@ namespace Nebula::nvk
         }
     }
 
+    std::shared_ptr<Buffer> Buffer::create_with_data(const BufferCreateInfo& create_info,
+                                                     const void* p_data,
+                                                     const std::shared_ptr<Device>& device,
+                                                     UploadBatch& upload_batch)
+    {
+        auto buffer = std::make_shared<Buffer>(create_info, device);
+        upload_batch.upload(buffer, p_data, create_info.size);
+        return buffer;
+    }
+
+    void Buffer::set_data(const void* p_data, const vk::DeviceSize data_size)
+    {
+        if (data_size > size())
+        {
+            throw make_exception("Tried to copy {} bytes into the {} bytes of Buffer \"{}\"", data_size, size(), m_name);
+        }
+
+        void* mapped_memory = m_allocation->map();
+        std::memcpy(mapped_memory, p_data, static_cast<size_t>(data_size));
+        m_allocation->unmap();
+    }
+
     void Buffer::copy_to_buffer(const Buffer& dst, const vk::CommandBuffer& command_buffer)
     {
          auto copy_region = vk::BufferCopy()
@@ -1,4 +1,5 @@
 #include "Command.hpp"
+#include "StagingRing.hpp"
 #include "Utilities.hpp"
 
 namespace Nebula::nvk
@@ -74,6 +75,23 @@ namespace Nebula::nvk
         m_device->handle().freeCommandBuffers(pool, 1, &buffer);
     }
 
+    StagingRing& CommandPool::staging_ring()
+    {
+        if (!m_staging_ring)
+        {
+            m_staging_ring = std::make_shared<StagingRing>(s_staging_ring_size, get_pool(m_default_queue_family),
+                                                           m_queues.at(m_default_queue_family), m_device);
+        }
+        return *m_staging_ring;
+    }
+
+    void CommandPool::upload(const Buffer& dst, const void* p_data, const vk::DeviceSize data_size)
+    {
+        auto& ring = staging_ring();
+        ring.upload(dst, p_data, data_size);
+        ring.submit();
+    }
+
     const vk::CommandPool& CommandPool::get_pool(uint32_t family_index)
     {
         if (m_pools.contains(family_index))
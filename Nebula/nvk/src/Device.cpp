@@ -87,6 +87,7 @@ namespace Nebula::nvk
 
         auto id = static_cast<uint32_t>(m_allocations.size());
         auto allocation = std::make_shared<Allocation>(allocation_info.target, memory_requirements.size, m_device, id);
+        allocation->memory_type = heap;
 
         if (const vk::Result result = m_device.allocateMemory(&allocate_info, nullptr, &allocation->memory);
             result != vk::Result::eSuccess)
@@ -9,7 +9,9 @@ namespace Nebula::nvk
     {
         features
             .setFillModeNonSolid(true)
+            .setDrawIndirectFirstInstance(true)
             .setGeometryShader(true)
+            .setMultiDrawIndirect(true)
             .setSamplerAnisotropy(true)
             .setSampleRateShading(true)
             .setShaderInt64(true)
@@ -20,6 +22,7 @@ namespace Nebula::nvk
         vulkan_12
             .setBufferDeviceAddress(true)
             .setDescriptorIndexing(true)
+            .setDrawIndirectCount(true)
             .setScalarBlockLayout(true)
             .setShaderFloat16(true)
             .setShaderInt8(true)
@@ -31,12 +31,43 @@ namespace Nebula::nvk
 
         m_device->name_object(m_image, fmt::format("{} [Image]", m_name), vk::ObjectType::eImage);
 
-        auto allocation_info = AllocationInfo()
-            .set_image(m_image)
-            .set_property_flags(create_info.memory_property_flags);
+        // Aliasing needs the allocation to be of an accepted memory type, large enough past a suitably aligned offset
+        const vk::MemoryRequirements memory_requirements = m_device->handle().getImageMemoryRequirements(m_image);
+        const auto& alias = create_info.memory_alias;
+        const bool alias_type_ok = alias && (memory_requirements.memoryTypeBits & (1u << alias->memory_type)) != 0;
+        const bool alias_offset_ok = alias && (alias->offset % memory_requirements.alignment) == 0;
+        const bool alias_size_ok = alias && memory_requirements.size <= alias->size;
+        if (alias_type_ok && alias_offset_ok && alias_size_ok)
+        {
+            m_allocation = alias;
+            m_owns_allocation = false;
+            m_device->handle().bindImageMemory(m_image, m_allocation->memory, m_allocation->offset);
+        }
+        else
+        {
+            if (alias && !alias_type_ok)
+            {
+                print_warning("Image \"{}\" can't use memory type {} of the aliased allocation (supported types: {:#x}), allocating instead",
+                              m_name, alias->memory_type, memory_requirements.memoryTypeBits);
+            }
+            else if (alias && !alias_offset_ok)
+            {
+                print_warning("Image \"{}\" requires {} byte alignment, the aliased allocation is at offset {}, allocating instead",
+                              m_name, memory_requirements.alignment, alias->offset);
+            }
+            else if (alias)
+            {
+                print_warning("Image \"{}\" requires {} bytes, more than the aliased allocation ({} bytes), allocating instead",
+                              m_name, memory_requirements.size, alias->size);
+            }
+
+            auto allocation_info = AllocationInfo()
+                .set_image(m_image)
+                .set_property_flags(create_info.memory_property_flags);
 
-        m_allocation = m_device->allocate_memory(allocation_info);
-        m_allocation->bind();
+            m_allocation = m_device->allocate_memory(allocation_info);
+            m_allocation->bind();
+        }
 
         auto view_create_info = vk::ImageViewCreateInfo()
             .setFormat(m_properties.format)
@@ -99,7 +130,10 @@ namespace Nebula::nvk
     {
         m_device->handle().destroy(m_image_view);
         m_device->handle().destroy(m_image);
-        m_allocation->free();
+        if (m_owns_allocation)
+        {
+            m_allocation->free();
+        }
 
         print_verbose("Destroyed Image and ImageView: {}", m_name);
     }
@@ -152,7 +186,7 @@ namespace Nebula::nvk
         command_buffer.pipelineBarrier2(m_dependency_info);
         command_buffer.blitImage2(&m_blit_image_info);
 
-        m_src_image->update_state({ vk::AccessFlagBits2::eNone, m_barriers[0].newLayout });
-        m_dst_image->update_state({ vk::AccessFlagBits2::eNone, m_barriers[1].newLayout });
+        m_src_image->update_state({ vk::AccessFlagBits2::eTransferRead, m_barriers[0].newLayout, vk::PipelineStageFlagBits2::eBlit });
+        m_dst_image->update_state({ vk::AccessFlagBits2::eTransferWrite, m_barriers[1].newLayout, vk::PipelineStageFlagBits2::eBlit });
     }
 }
\ No newline at end of file
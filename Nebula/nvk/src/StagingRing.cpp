@@ -0,0 +1,220 @@
+#include "StagingRing.hpp"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include "Utilities.hpp"
+
+namespace Nebula::nvk
+{
+    StagingRing::StagingRing(const vk::DeviceSize size,
+                             const vk::CommandPool& command_pool,
+                             const std::shared_ptr<Queue>& queue,
+                             const std::shared_ptr<Device>& device)
+    : m_size(size), m_queue(queue), m_device(device), m_pool(command_pool)
+    {
+        auto staging_create_info = BufferCreateInfo()
+            .set_buffer_type(BufferType::eStaging)
+            .set_name("Staging Ring")
+            .set_size(m_size);
+        m_staging = std::make_shared<Buffer>(staging_create_info, m_device);
+        m_mapped = static_cast<uint8_t*>(m_staging->map());
+
+        std::array<vk::CommandBuffer, 2> command_buffers;
+        auto allocate_info = vk::CommandBufferAllocateInfo()
+            .setLevel(vk::CommandBufferLevel::ePrimary)
+            .setCommandPool(m_pool)
+            .setCommandBufferCount(static_cast<uint32_t>(command_buffers.size()));
+        if (const vk::Result result = m_device->handle().allocateCommandBuffers(&allocate_info, command_buffers.data());
+            result != vk::Result::eSuccess)
+        {
+            throw make_exception("Failed to allocate vk::CommandBuffers for the StagingRing ({})", to_string(result));
+        }
+
+        for (size_t i = 0; i < m_submissions.size(); i++)
+        {
+            m_submissions[i].command_buffer = command_buffers[i];
+
+            auto fence_create_info = vk::FenceCreateInfo();
+            if (const vk::Result result = m_device->handle().createFence(&fence_create_info, nullptr, &m_submissions[i].fence);
+                result != vk::Result::eSuccess)
+            {
+                throw make_exception("Failed to create vk::Fence for the StagingRing ({})", to_string(result));
+            }
+        }
+
+        print_verbose("Created a StagingRing of {} bytes on Queue Family {}", m_size, m_queue->family_index);
+    }
+
+    StagingRing::~StagingRing()
+    {
+        submit();
+
+        for (auto& submission : m_submissions)
+        {
+            m_device->handle().destroy(submission.fence);
+            m_device->handle().freeCommandBuffers(m_pool, 1, &submission.command_buffer);
+        }
+
+        m_staging->unmap();
+    }
+
+    void StagingRing::upload(const Buffer& dst, const void* p_data, const vk::DeviceSize data_size, const vk::DeviceSize dst_offset)
+    {
+        if (dst_offset + data_size > dst.size())
+        {
+            throw make_exception("Tried to upload {} bytes at offset {} into a Buffer of {} bytes", data_size, dst_offset, dst.size());
+        }
+
+        const auto* src = static_cast<const uint8_t*>(p_data);
+        for (vk::DeviceSize done = 0; done < data_size;)
+        {
+            if (!m_recording) begin_recording();
+
+            const vk::DeviceSize chunk = std::min(data_size - done, m_size);
+            const vk::DeviceSize offset = allocate(chunk);
+            std::memcpy(m_mapped + offset, src + done, static_cast<size_t>(chunk));
+
+            auto copy_region = vk::BufferCopy()
+                .setSize(chunk)
+                .setSrcOffset(offset)
+                .setDstOffset(dst_offset + done);
+            m_submissions[m_current].command_buffer.copyBuffer(m_staging->buffer(), dst.buffer(), 1, &copy_region);
+
+            done += chunk;
+        }
+        m_transfer_barrier = true;
+    }
+
+    void StagingRing::copy(const Buffer& src, const Buffer& dst, const vk::BufferCopy& region)
+    {
+        if (region.srcOffset + region.size > src.size() || region.dstOffset + region.size > dst.size())
+        {
+            throw make_exception("Tried to copy {} bytes from offset {} of a Buffer of {} bytes to offset {} of a Buffer of {} bytes",
+                                 region.size, region.srcOffset, src.size(), region.dstOffset, dst.size());
+        }
+
+        if (!m_recording) begin_recording();
+
+        // The source may have been written by an earlier upload, one barrier covers the copies recorded after it
+        const auto& command_buffer = m_submissions[m_current].command_buffer;
+        if (m_transfer_barrier)
+        {
+            auto barrier = vk::MemoryBarrier2()
+                .setSrcStageMask(vk::PipelineStageFlagBits2::eTransfer)
+                .setSrcAccessMask(vk::AccessFlagBits2::eTransferWrite)
+                .setDstStageMask(vk::PipelineStageFlagBits2::eTransfer)
+                .setDstAccessMask(vk::AccessFlagBits2::eTransferRead | vk::AccessFlagBits2::eTransferWrite);
+            command_buffer.pipelineBarrier2(vk::DependencyInfo().setMemoryBarriers(barrier));
+            m_transfer_barrier = false;
+        }
+
+        command_buffer.copyBuffer(src.buffer(), dst.buffer(), 1, &region);
+    }
+
+    void StagingRing::flush()
+    {
+        if (!m_recording)
+        {
+            return;
+        }
+
+        auto& submission = m_submissions[m_current];
+        submission.command_buffer.end();
+
+        auto submit_info = vk::SubmitInfo().setCommandBufferCount(1).setPCommandBuffers(&submission.command_buffer);
+        if (const vk::Result result = m_queue->queue.submit(1, &submit_info, submission.fence); result != vk::Result::eSuccess)
+        {
+            throw make_exception("Failed to submit the StagingRing on Queue Family {} ({})", m_queue->family_index, to_string(result));
+        }
+
+        submission.in_flight = true;
+        m_recording = false;
+        m_current = (m_current + 1) % m_submissions.size();
+        m_submission_count++;
+    }
+
+    void StagingRing::wait()
+    {
+        for (auto& submission : m_submissions)
+        {
+            retire(submission);
+        }
+    }
+
+    vk::DeviceSize StagingRing::allocate(const vk::DeviceSize size)
+    {
+        const vk::DeviceSize aligned_size = std::min((size + s_alignment - 1) & ~(s_alignment - 1), m_size);
+
+        while (true)
+        {
+            // Allocations are contiguous, the tail of the ring is skipped when they would wrap around
+            const vk::DeviceSize padding = (m_head + aligned_size > m_size) ? m_size - m_head : 0;
+            if (m_used + padding + aligned_size <= m_size)
+            {
+                auto& submission = m_submissions[m_current];
+                const vk::DeviceSize offset = (padding > 0) ? 0 : m_head;
+                m_head = (offset + aligned_size) % m_size;
+                m_used += padding + aligned_size;
+                submission.bytes += padding + aligned_size;
+                return offset;
+            }
+
+            // Ring is full: reclaim the previous submission, or send off the current one and reclaim it next
+            auto& previous = m_submissions[(m_current + 1) % m_submissions.size()];
+            if (previous.in_flight)
+            {
+                retire(previous);
+            }
+            else
+            {
+                flush();
+                begin_recording();
+            }
+        }
+    }
+
+    void StagingRing::retire(Submission& submission)
+    {
+        if (!submission.in_flight)
+        {
+            return;
+        }
+
+        if (const vk::Result result = m_device->handle().waitForFences(1, &submission.fence, true, std::numeric_limits<uint64_t>::max());
+            result != vk::Result::eSuccess)
+        {
+            throw make_exception("Failed to wait for a StagingRing submission ({})", to_string(result));
+        }
+
+        m_used -= submission.bytes;
+        submission.bytes = 0;
+        submission.in_flight = false;
+
+        if (m_used == 0)
+        {
+            m_head = 0;
+        }
+    }
+
+    void StagingRing::begin_recording()
+    {
+        auto& submission = m_submissions[m_current];
+        retire(submission);
+
+        if (const vk::Result result = m_device->handle().resetFences(1, &submission.fence); result != vk::Result::eSuccess)
+        {
+            throw make_exception("Failed to reset a StagingRing fence ({})", to_string(result));
+        }
+
+        auto begin_info = vk::CommandBufferBeginInfo().setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
+        if (const vk::Result result = submission.command_buffer.begin(&begin_info); result != vk::Result::eSuccess)
+        {
+            throw make_exception("Failed to begin the StagingRing vk::CommandBuffer ({})", to_string(result));
+        }
+
+        m_recording = true;
+
+        // Writes of earlier submissions aren't visible to the copies of this one without a barrier either
+        m_transfer_barrier = true;
+    }
+}
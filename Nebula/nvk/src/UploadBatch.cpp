@@ -0,0 +1,55 @@
+#include "UploadBatch.hpp"
+#include "Utilities.hpp"
+
+namespace Nebula::nvk
+{
+    UploadBatch::UploadBatch(const std::shared_ptr<Device>& device, const std::shared_ptr<CommandPool>& command_pool)
+    : m_device(device), m_command_pool(command_pool)
+    {
+    }
+
+    void UploadBatch::upload(const std::shared_ptr<Buffer>& dst, const void* p_data, const vk::DeviceSize data_size)
+    {
+        m_command_pool->staging_ring().upload(*dst, p_data, data_size);
+
+        // Destinations are kept alive until their copies completed
+        m_uploads.push_back(dst);
+        m_pending_size += data_size;
+    }
+
+    void UploadBatch::copy(const Buffer& src, const std::shared_ptr<Buffer>& dst, const vk::BufferCopy& region)
+    {
+        m_command_pool->staging_ring().copy(src, *dst, region);
+
+        m_uploads.push_back(dst);
+        m_copy_count++;
+    }
+
+    void UploadBatch::submit()
+    {
+        if (m_uploads.empty())
+        {
+            return;
+        }
+
+        auto& staging_ring = m_command_pool->staging_ring();
+        const uint64_t first_submission = staging_ring.submission_count();
+        staging_ring.submit();
+
+        print_verbose("Uploaded {} buffers ({} bytes) & recorded {} copies in {} submission(s)",
+                      m_uploads.size() - m_copy_count, m_pending_size, m_copy_count,
+                      staging_ring.submission_count() - first_submission);
+
+        m_uploads.clear();
+        m_pending_size = 0;
+        m_copy_count = 0;
+    }
+
+    UploadBatch::~UploadBatch()
+    {
+        if (!m_uploads.empty())
+        {
+            print_warning("UploadBatch destroyed with {} uploads that were never submitted", m_uploads.size());
+        }
+    }
+}
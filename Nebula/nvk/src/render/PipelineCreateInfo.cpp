@@ -1,4 +1,6 @@
 #include "render/PipelineCreateInfo.hpp"
+#include "Utilities.hpp"
+#include <algorithm>
 
 namespace Nebula::nvk
 {
@@ -27,6 +29,22 @@ namespace Nebula::nvk
         return *this;
     }
 
+    PipelineCreateInfo& PipelineCreateInfo::add_specialization_constant(vk::ShaderStageFlagBits shader_stage,
+                                                                        uint32_t constant_id, uint32_t value)
+    {
+        auto shader = std::ranges::find_if(m_shader_sources, [&](const ShaderCreateInfo& sci){
+            return sci.shader_stage == shader_stage;
+        });
+
+        if (shader == std::end(m_shader_sources))
+        {
+            throw make_exception("Failed to add specialization constant {}: no {} shader was specified", constant_id, to_string(shader_stage));
+        }
+
+        shader->add_specialization_constant(constant_id, value);
+        return *this;
+    }
+
     PipelineCreateInfo& PipelineCreateInfo::add_push_constant(const vk::PushConstantRange& push_constant)
     {
         m_push_constants.push_back(push_constant);
@@ -1,4 +1,5 @@
 #include "render/RenderPass.hpp"
+#include <array>
 #include "Utilities.hpp"
 
 namespace Nebula::nvk
@@ -31,16 +32,17 @@ namespace Nebula::nvk
 
     RenderPassCreateInfo&
     RenderPassCreateInfo::add_attachment(const std::shared_ptr<Image>& image, vk::ImageLayout final_layout,
-                                         vk::ClearColorValue clear_value, vk::AttachmentLoadOp load_op)
+                                         vk::ClearColorValue clear_value, vk::AttachmentLoadOp load_op,
+                                         vk::AttachmentStoreOp store_op, vk::ImageLayout initial_layout)
     {
         auto ad = vk::AttachmentDescription()
             .setFormat(image->properties().format)
             .setSamples(image->properties().sample_count)
             .setLoadOp(load_op)
-            .setStoreOp(vk::AttachmentStoreOp::eStore)
+            .setStoreOp(store_op)
             .setStencilLoadOp(vk::AttachmentLoadOp::eDontCare)
             .setStencilStoreOp(vk::AttachmentStoreOp::eDontCare)
-            .setInitialLayout(vk::ImageLayout::eUndefined)
+            .setInitialLayout(initial_layout)
             .setFinalLayout(final_layout);
         attachments.push_back(ad);
 
@@ -82,17 +84,19 @@ namespace Nebula::nvk
     }
 
     RenderPassCreateInfo&
-    RenderPassCreateInfo::set_depth_attachment(const std::shared_ptr<Image>& depth_image, vk::ClearDepthStencilValue clear_value)
+    RenderPassCreateInfo::set_depth_attachment(const std::shared_ptr<Image>& depth_image, vk::ClearDepthStencilValue clear_value,
+                                               vk::AttachmentLoadOp load_op, vk::AttachmentStoreOp store_op,
+                                               vk::ImageLayout initial_layout, vk::ImageLayout final_layout)
     {
         auto ad = vk::AttachmentDescription()
             .setFormat(depth_image->properties().format)
             .setSamples(depth_image->properties().sample_count)
-            .setLoadOp(vk::AttachmentLoadOp::eClear)
-            .setStoreOp(vk::AttachmentStoreOp::eDontCare)
+            .setLoadOp(load_op)
+            .setStoreOp(store_op)
             .setStencilLoadOp(vk::AttachmentLoadOp::eDontCare)
             .setStencilStoreOp(vk::AttachmentStoreOp::eDontCare)
-            .setInitialLayout(vk::ImageLayout::eUndefined)
-            .setFinalLayout(vk::ImageLayout::eDepthStencilAttachmentOptimal);
+            .setInitialLayout(initial_layout)
+            .setFinalLayout(final_layout);
         attachments.push_back(ad);
 
         has_depth_attachment = true;
@@ -182,22 +186,34 @@ namespace Nebula::nvk
             .setPDepthStencilAttachment(create_info.has_depth_attachment ? &create_info.depth_ref : nullptr)
             .setPipelineBindPoint(vk::PipelineBindPoint::eGraphics);
 
-        auto subpass_dependency = vk::SubpassDependency()
-            .setSrcSubpass(VK_SUBPASS_EXTERNAL)
-            .setDstSubpass(0)
-            .setSrcStageMask(vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eEarlyFragmentTests)
-            .setSrcAccessMask({})
-            .setDstStageMask(vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eEarlyFragmentTests)
-            .setDstAccessMask(vk::AccessFlagBits::eColorAttachmentWrite | vk::AccessFlagBits::eDepthStencilAttachmentWrite);
-
+        using enum vk::PipelineStageFlagBits;
+        using enum vk::AccessFlagBits;
+        const std::array<vk::SubpassDependency, 2> subpass_dependencies = {
+            // Attachments loaded with eLoad see the writes of the previous pass, reused memory waits for earlier compute reads
+            vk::SubpassDependency()
+                .setSrcSubpass(VK_SUBPASS_EXTERNAL)
+                .setDstSubpass(0)
+                .setSrcStageMask(eColorAttachmentOutput | eEarlyFragmentTests | eLateFragmentTests | eComputeShader)
+                .setSrcAccessMask(eColorAttachmentWrite | eDepthStencilAttachmentWrite)
+                .setDstStageMask(eColorAttachmentOutput | eEarlyFragmentTests)
+                .setDstAccessMask(eColorAttachmentRead | eColorAttachmentWrite | eDepthStencilAttachmentRead | eDepthStencilAttachmentWrite),
+            // Final layout transitions chain into barriers or events waiting on the attachment output stages,
+            // later passes are not held back by the render pass itself
+            vk::SubpassDependency()
+                .setSrcSubpass(0)
+                .setDstSubpass(VK_SUBPASS_EXTERNAL)
+                .setSrcStageMask(eColorAttachmentOutput | eLateFragmentTests)
+                .setSrcAccessMask(eColorAttachmentWrite | eDepthStencilAttachmentWrite)
+                .setDstStageMask(eColorAttachmentOutput | eLateFragmentTests)
+                .setDstAccessMask({}),
+        };
 
         auto rp_create_info = vk::RenderPassCreateInfo()
             .setAttachmentCount(create_info.attachments.size())
             .setPAttachments(create_info.attachments.data())
             .setSubpassCount(1)
             .setPSubpasses(&subpass)
-            .setDependencyCount(1)
-            .setPDependencies(&subpass_dependency);
+            .setDependencies(subpass_dependencies);
 
         if (const vk::Result result = m_device->handle().createRenderPass(&rp_create_info, nullptr, &m_render_pass);
             result != vk::Result::eSuccess)
@@ -6,7 +6,13 @@ namespace Nebula::nvk
 {
     Shader::Shader(const ShaderCreateInfo& create_info, const std::shared_ptr<Device>& device)
     : m_device(device), m_stage(create_info.shader_stage), m_entry_point(create_info.entry_point)
+    , m_specialization_entries(create_info.specialization_entries), m_specialization_data(create_info.specialization_data)
     {
+        m_specialization_info = vk::SpecializationInfo()
+            .setMapEntries(m_specialization_entries)
+            .setDataSize(m_specialization_data.size() * sizeof(uint32_t))
+            .setPData(m_specialization_data.data());
+
         auto shader_source_code = Shader::read_file(create_info.file_path);
 
         auto sh_create_info = vk::ShaderModuleCreateInfo()
@@ -27,7 +33,8 @@ namespace Nebula::nvk
         return vk::PipelineShaderStageCreateInfo()
             .setStage(m_stage)
             .setModule(m_shader)
-            .setPName(m_entry_point.c_str());
+            .setPName(m_entry_point.c_str())
+            .setPSpecializationInfo(m_specialization_entries.empty() ? nullptr : &m_specialization_info);
     }
 
     std::vector<char> Shader::read_file(const std::string& file_path)
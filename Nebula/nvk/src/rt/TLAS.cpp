@@ -1,4 +1,7 @@
 #include "rt/TLAS.hpp"
+#include <algorithm>
+#include <array>
+#include <cstring>
 #include "Utilities.hpp"
 
 namespace Nebula::nvk
@@ -6,40 +9,55 @@ namespace Nebula::nvk
 
     TLAS::TLAS(const TLASCreateInfo& create_info, const std::shared_ptr<Device>& device,
                const std::shared_ptr<CommandPool>& command_pool)
-    : m_device(device)
+    : m_frames_in_flight(std::max(create_info.frames_in_flight, 1u))
+    , m_device(device)
     , m_command_pool(command_pool)
     , m_name(create_info.name)
     {
-        build(create_info.instance_info);
-        m_device->name_object(m_tlas, fmt::format("{} [Top-Level]", m_name), vk::ObjectType::eAccelerationStructureKHR);
+        m_command_pool->exec_single_time_command([&](const vk::CommandBuffer& command_buffer) {
+            rebuild(create_info.instance_info, 0, command_buffer);
+        });
 
         print_verbose("Created Top-Level AS: {}", create_info.name);
     }
 
-    void TLAS::build(const std::vector<TLASInstanceInfo>& instance_info)
+    TLAS::~TLAS()
     {
-        m_instance_count = instance_info.size();
+        for (const auto& retired : m_retired)
+        {
+            m_device->handle().destroyAccelerationStructureKHR(retired.tlas);
+        }
+        m_device->handle().destroyAccelerationStructureKHR(m_tlas);
 
-        // Instance Data
-        #pragma region
-        std::vector<vk::AccelerationStructureInstanceKHR> instances(instance_info.size());
-        for (int32_t i = 0; i < instances.size(); i++)
+        for (const auto& staging : m_staging)
         {
-            auto& instance = instance_info[i];
-            instances[i]
-                .setAccelerationStructureReference(instance.blas_address)
-                .setFlags(vk::GeometryInstanceFlagBitsKHR::eTriangleFacingCullDisable)
-                .setInstanceShaderBindingTableRecordOffset(instance.hit_group)
-                .setMask(instance.mask)
-                .setTransform(instance.transform);
+            staging->unmap();
         }
+    }
 
-        vk::DeviceSize instances_size = instances.size() * sizeof(vk::AccelerationStructureInstanceKHR);
-        auto staging_create_info = BufferCreateInfo()
-            .set_buffer_type(BufferType::eStorage)
-            .set_name(fmt::format("{} TLAS Instance Data", m_name))
-            .set_size(instances_size);
-        auto staging_buffer = Buffer::create(staging_create_info, m_device);
+    void TLAS::allocate(const uint32_t capacity)
+    {
+        // The previous TLAS may still be traced by frames in flight
+        if (m_tlas)
+        {
+            m_retired.push_back({
+                .tlas        = m_tlas,
+                .buffers     = { m_buffer, m_instance_data, m_scratch },
+                .frames_left = m_frames_in_flight,
+            });
+            m_retired.back().buffers.insert(m_retired.back().buffers.end(), m_staging.begin(), m_staging.end());
+            for (const auto& staging : m_staging)
+            {
+                staging->unmap();
+            }
+            m_staging.clear();
+            m_staging_mapped.clear();
+        }
+        m_capacity = capacity;
+
+        // Instance Data
+        #pragma region
+        vk::DeviceSize instances_size = m_capacity * sizeof(vk::AccelerationStructureInstanceKHR);
 
         using enum vk::BufferUsageFlagBits;
         using enum vk::MemoryPropertyFlagBits;
@@ -51,7 +69,15 @@ namespace Nebula::nvk
             .set_name(fmt::format("{} TLAS Instance Data", m_name));
         m_instance_data = Buffer::create(instance_create_info, m_device);
 
-        staging_buffer->set_data(instances.data());
+        for (uint32_t i = 0; i < m_frames_in_flight; i++)
+        {
+            auto staging_create_info = BufferCreateInfo()
+                .set_buffer_type(BufferType::eStaging)
+                .set_name(fmt::format("{} TLAS Instance Data #{}", m_name, i))
+                .set_size(instances_size);
+            m_staging.push_back(Buffer::create(staging_create_info, m_device));
+            m_staging_mapped.push_back(static_cast<vk::AccelerationStructureInstanceKHR*>(m_staging.back()->map()));
+        }
         #pragma endregion
 
         // Acceleration Structure
@@ -65,7 +91,7 @@ namespace Nebula::nvk
             .setGeometry(instances_data);
 
         auto build_geometry_info = vk::AccelerationStructureBuildGeometryInfoKHR()
-            .setFlags(vk::BuildAccelerationStructureFlagBitsKHR::ePreferFastTrace)
+            .setFlags(s_build_flags)
             .setGeometryCount(1)
             .setMode(vk::BuildAccelerationStructureModeKHR::eBuild)
             .setPGeometries(&geometry)
@@ -74,7 +100,7 @@ namespace Nebula::nvk
         vk::AccelerationStructureBuildSizesInfoKHR build_sizes_info;
         m_device->handle().getAccelerationStructureBuildSizesKHR(vk::AccelerationStructureBuildTypeKHR::eDevice,
                                                                  &build_geometry_info,
-                                                                 &m_instance_count,
+                                                                 &m_capacity,
                                                                  &build_sizes_info);
 
         auto tlas_buffer_create_info = BufferCreateInfo()
@@ -94,26 +120,107 @@ namespace Nebula::nvk
         {
             throw make_exception("Failed to create Top-Level AS (name: {})", m_name);
         }
+        m_device->name_object(m_tlas, fmt::format("{} [Top-Level]", m_name), vk::ObjectType::eAccelerationStructureKHR);
 
-        auto as_staging_create_info = BufferCreateInfo()
+        // Shared by full builds & refits
+        auto scratch_create_info = BufferCreateInfo()
             .set_buffer_type(BufferType::eStorage)
-            .set_name(fmt::format("{} TLAS", m_name))
-            .set_size(build_sizes_info.buildScratchSize);
-        auto as_staging_buffer = Buffer::create(as_staging_create_info, m_device);
+            .set_name(fmt::format("{} TLAS Scratch", m_name))
+            .set_size(std::max(build_sizes_info.buildScratchSize, build_sizes_info.updateScratchSize));
+        m_scratch = Buffer::create(scratch_create_info, m_device);
+        #pragma endregion
+    }
+
+    void TLAS::rebuild(const std::vector<TLASInstanceInfo>& instance_info, const uint32_t frame,
+                       const vk::CommandBuffer& command_buffer)
+    {
+        m_instance_count = static_cast<uint32_t>(instance_info.size());
+        if (m_instance_count > m_capacity || !m_tlas)
+        {
+            // Room to grow, so adding a few instances at a time doesn't reallocate every frame
+            allocate(std::max(m_instance_count + m_instance_count / 2, 1u));
+        }
+
+        m_instances.resize(m_instance_count);
+        for (uint32_t i = 0; i < m_instance_count; i++)
+        {
+            m_instances[i] = to_instance(instance_info[i]);
+        }
+        std::memcpy(m_staging_mapped[frame], m_instances.data(), m_instances.size() * sizeof(vk::AccelerationStructureInstanceKHR));
+
+        m_copy_regions.clear();
+        if (m_instance_count > 0)
+        {
+            m_copy_regions.push_back(vk::BufferCopy().setSize(m_instances.size() * sizeof(vk::AccelerationStructureInstanceKHR)));
+        }
+        record_build(vk::BuildAccelerationStructureModeKHR::eBuild, frame, command_buffer);
+    }
+
+    void TLAS::record_build(const vk::BuildAccelerationStructureModeKHR mode, const uint32_t frame,
+                            const vk::CommandBuffer& command_buffer)
+    {
+        using enum vk::PipelineStageFlagBits2;
+        using enum vk::AccessFlagBits2;
+
+        if (!m_copy_regions.empty())
+        {
+            // Earlier builds are done reading the instances
+            auto reuse_barrier = vk::MemoryBarrier2()
+                .setSrcStageMask(eAccelerationStructureBuildKHR)
+                .setDstStageMask(eAllTransfer)
+                .setDstAccessMask(eTransferWrite);
+            command_buffer.pipelineBarrier2(vk::DependencyInfo().setMemoryBarriers(reuse_barrier));
+
+            command_buffer.copyBuffer(m_staging[frame]->buffer(), m_instance_data->buffer(),
+                                      static_cast<uint32_t>(m_copy_regions.size()), m_copy_regions.data());
+        }
+
+        // Copied instances are visible to the build, earlier traces & builds are done with the TLAS & the scratch
+        std::array<vk::MemoryBarrier2, 2> build_barriers = {
+            vk::MemoryBarrier2()
+                .setSrcStageMask(eAllTransfer)
+                .setSrcAccessMask(eTransferWrite)
+                .setDstStageMask(eAccelerationStructureBuildKHR)
+                .setDstAccessMask(eShaderRead),
+            vk::MemoryBarrier2()
+                .setSrcStageMask(eAllCommands)
+                .setSrcAccessMask(eAccelerationStructureReadKHR | eAccelerationStructureWriteKHR)
+                .setDstStageMask(eAccelerationStructureBuildKHR)
+                .setDstAccessMask(eAccelerationStructureReadKHR | eAccelerationStructureWriteKHR),
+        };
+        command_buffer.pipelineBarrier2(vk::DependencyInfo().setMemoryBarriers(build_barriers));
 
-        build_geometry_info
+        auto instances_data = vk::AccelerationStructureGeometryInstancesDataKHR()
+            .setArrayOfPointers(false)
+            .setData(m_instance_data->address());
+
+        auto geometry = vk::AccelerationStructureGeometryKHR()
+            .setGeometryType(vk::GeometryTypeKHR::eInstances)
+            .setGeometry(instances_data);
+
+        // A refit has to use the same flags & instance count as the build it updates
+        const bool refit = mode == vk::BuildAccelerationStructureModeKHR::eUpdate;
+        auto build_geometry_info = vk::AccelerationStructureBuildGeometryInfoKHR()
+            .setFlags(s_build_flags)
+            .setGeometryCount(1)
+            .setMode(mode)
+            .setPGeometries(&geometry)
+            .setType(vk::AccelerationStructureTypeKHR::eTopLevel)
+            .setSrcAccelerationStructure(refit ? m_tlas : vk::AccelerationStructureKHR())
             .setDstAccelerationStructure(m_tlas)
-            .setScratchData(as_staging_buffer->address());
+            .setScratchData(m_scratch->address());
 
         auto build_range_info = vk::AccelerationStructureBuildRangeInfoKHR()
             .setPrimitiveCount(m_instance_count);
-        std::vector<const vk::AccelerationStructureBuildRangeInfoKHR*> build_ranges = { &build_range_info };
-        #pragma endregion
+        const vk::AccelerationStructureBuildRangeInfoKHR* p_build_range = &build_range_info;
+        command_buffer.buildAccelerationStructuresKHR(1, &build_geometry_info, &p_build_range);
 
-        m_command_pool->exec_single_time_command([&](const vk::CommandBuffer& command_buffer) {
-            staging_buffer->copy_to_buffer(*m_instance_data, command_buffer);
-            command_buffer.buildAccelerationStructuresKHR(1, &build_geometry_info, build_ranges.data());
-        });
+        auto trace_barrier = vk::MemoryBarrier2()
+            .setSrcStageMask(eAccelerationStructureBuildKHR)
+            .setSrcAccessMask(eAccelerationStructureWriteKHR)
+            .setDstStageMask(eAllCommands)
+            .setDstAccessMask(eAccelerationStructureReadKHR);
+        command_buffer.pipelineBarrier2(vk::DependencyInfo().setMemoryBarriers(trace_barrier));
     }
 
     void TLAS::update(const TLASUpdateInfo& update_info)
@@ -125,6 +232,82 @@ namespace Nebula::nvk
 
     void TLAS::update(const TLASUpdateInfo& update_info, const vk::CommandBuffer& command_buffer)
     {
-        throw make_exception("TLAS::update() is not implemented");
+        release_retired();
+
+        const uint32_t frame = update_info.frame % m_frames_in_flight;
+        const bool full_list = update_info.indices.empty();
+        if (!full_list && update_info.indices.size() != update_info.instance_info.size())
+        {
+            throw make_exception("TLAS {}: {} indices given for {} instances", m_name, update_info.indices.size(), update_info.instance_info.size());
+        }
+
+        if (full_list && update_info.instance_info.size() != m_instance_count)
+        {
+            rebuild(update_info.instance_info, frame, command_buffer);
+            return;
+        }
+
+        // Instances that differ from the last build, a full list is compared against the previous one
+        m_changed.clear();
+        for (uint32_t i = 0; i < update_info.instance_info.size(); i++)
+        {
+            const uint32_t instance_idx = full_list ? i : update_info.indices[i];
+            if (instance_idx >= m_instance_count)
+            {
+                throw make_exception("TLAS {}: Instance index {} is out of range ({} instances)", m_name, instance_idx, m_instance_count);
+            }
+
+            const auto instance = to_instance(update_info.instance_info[i]);
+            if (std::memcmp(&instance, &m_instances[instance_idx], sizeof(vk::AccelerationStructureInstanceKHR)) == 0) continue;
+
+            m_instances[instance_idx] = instance;
+            m_staging_mapped[frame][instance_idx] = instance;
+            m_changed.push_back(instance_idx);
+        }
+        if (m_changed.empty()) return;
+
+        // Runs of adjacent instances are copied together
+        std::sort(m_changed.begin(), m_changed.end());
+        m_changed.erase(std::unique(m_changed.begin(), m_changed.end()), m_changed.end());
+
+        constexpr vk::DeviceSize instance_size = sizeof(vk::AccelerationStructureInstanceKHR);
+        m_copy_regions.clear();
+        for (const uint32_t instance_idx : m_changed)
+        {
+            const vk::DeviceSize offset = instance_idx * instance_size;
+            if (!m_copy_regions.empty() && m_copy_regions.back().srcOffset + m_copy_regions.back().size == offset)
+            {
+                m_copy_regions.back().size += instance_size;
+                continue;
+            }
+            m_copy_regions.push_back(vk::BufferCopy(offset, offset, instance_size));
+        }
+
+        record_build(vk::BuildAccelerationStructureModeKHR::eUpdate, frame, command_buffer);
+    }
+
+    void TLAS::release_retired()
+    {
+        for (auto& retired : m_retired)
+        {
+            if (retired.frames_left > 0) retired.frames_left--;
+            if (retired.frames_left == 0)
+            {
+                m_device->handle().destroyAccelerationStructureKHR(retired.tlas);
+            }
+        }
+        std::erase_if(m_retired, [](const Retired& retired) { return retired.frames_left == 0; });
+    }
+
+    vk::AccelerationStructureInstanceKHR TLAS::to_instance(const TLASInstanceInfo& instance_info)
+    {
+        vk::AccelerationStructureInstanceKHR instance {};
+        instance
+            .setAccelerationStructureReference(instance_info.blas_address)
+            .setFlags(vk::GeometryInstanceFlagBitsKHR::eTriangleFacingCullDisable)
+            .setInstanceShaderBindingTableRecordOffset(instance_info.hit_group)
+            .setMask(instance_info.mask)
+            .setTransform(instance_info.transform);
+        return instance;
     }
-}
\ No newline at end of file
+}
@@ -23,17 +23,20 @@ layout (set = 0, binding = 1) uniform SceneLightsUniformData {
 layout (set = 0, binding = 2) uniform sampler2D u_position;
 layout (set = 0, binding = 3) uniform sampler2D u_normal;
 layout (set = 0, binding = 4) uniform sampler2D u_albedo;
+layout (set = 0, binding = 5) uniform sampler2D u_ao;      // 1x1 white if AO is unavailable
+layout (set = 0, binding = 6) uniform sampler2D u_shadow;  // 1x1 white if shadow maps are unavailable
 
 layout (push_constant) uniform DeferredLightingPushConstant {
-    ivec4 params;  // [ No. Lights, -, -, - ]
+    ivec4 params;    // [ No. Lights, Swapchain Output, -, - ]
+    vec4  uv_scale;  // [ Active / Allocated Width, Active / Allocated Height, -, - ]
 } pc;
 
 layout (location = 0) out vec4 outColor;
 
-vec3 compute_diffuse(vec3 color, vec3 light_dir, vec3 normal) {
+vec3 compute_diffuse(vec3 color, vec3 light_dir, vec3 normal, float ao, float shadow) {
     float dot_nl = max(dot(normal, light_dir), 0.0);
-    vec3 c = color * dot_nl;
-    c += 0.1 * color;  // Ambient
+    vec3 c = color * dot_nl * shadow;
+    c += 0.1 * ao * color;  // Ambient
     return c;
 }
 
@@ -50,12 +53,18 @@ vec3 compute_specular(vec3 color, vec3 view_dir, vec3 light_dir, vec3 normal) {
 }
 
 void main() {
+    // Present flips the image, when rendering straight into the swapchain the flip is skipped
     vec2 uv = f_uv;
-    uv.y = -f_uv.y;
+    uv.y = (pc.params.y == 1) ? f_uv.y : 1.0 - f_uv.y;
+
+    // Only the active part of the G-Buffer was rendered to this frame
+    uv *= pc.uv_scale.xy;
 
     vec3 i_worldPos     = texture(u_position, uv).rgb;
     vec3 i_worldNormal  = texture(u_normal, uv).rgb;
     vec3 i_color        = texture(u_albedo, uv).rgb;
+    float i_ao          = texture(u_ao, uv).r;
+    float i_shadow      = texture(u_shadow, uv).r;
 
     vec3 i_viewDir      = camera.eye.xyz - i_worldPos;
 
@@ -69,8 +78,8 @@ void main() {
     vec3 L = normalize(l_dir);
     float light_distance = length(l_dir);
 
-    vec3 diffuse = compute_diffuse(i_color, L, N);
-    vec3 specular = compute_specular(i_color, i_viewDir, L, N);
+    vec3 diffuse = compute_diffuse(i_color, L, N, i_ao, i_shadow);
+    vec3 specular = compute_specular(i_color, i_viewDir, L, N) * i_shadow;
 
     vec4 color = vec4(diffuse + specular, 1);
 
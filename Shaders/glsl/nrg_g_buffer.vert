@@ -6,6 +6,8 @@ struct CameraData {
     mat4 view_inverse;
     mat4 proj_inverse;
     vec4 eye;
+    float near_plane;
+    float far_plane;
 };
 
 struct ObjectData {
@@ -16,11 +18,18 @@ struct ObjectData {
 layout (set = 0, binding = 0) uniform PrePassUniform {
     CameraData current;
     CameraData previous;
+    vec4 jitter;  // [ Jitter X, Jitter Y ] in NDC
 } camera;
 
-layout (push_constant) uniform ObjectPushConstantData {
-    ObjectData data;
-} object;
+// Object data in object order
+layout (set = 0, binding = 1) readonly buffer ObjectBuffer {
+    ObjectData objects[];
+};
+
+// Object index of every instance, the first instance of each indirect draw command points at its batch
+layout (set = 0, binding = 2) readonly buffer InstanceBuffer {
+    uint instances[];
+};
 
 layout (location = 0) in vec3 i_position;
 layout (location = 1) in vec3 i_normal;
@@ -38,7 +47,7 @@ void main()
 {
     CameraData current_camera  = camera.current;
     CameraData previous_camera = camera.previous;
-    ObjectData obj             = object.data;
+    ObjectData obj             = objects[instances[gl_InstanceIndex]];
 
     vec3 origin = vec3(current_camera.view_inverse * vec4(0, 0, 0, 1));
     vec4 currentWorldPosition = obj.model * vec4(i_position, 1.0);
@@ -51,7 +60,6 @@ void main()
 
     o_currentPosition = current_camera.proj * current_camera.view * currentWorldPosition;
     o_previousPosition = previous_camera.proj * previous_camera.view * obj.model * vec4(i_position, 1.0);
-    o_previousPosition = o_currentPosition;
-    
-    gl_Position = o_currentPosition;
+
+    gl_Position = o_currentPosition + vec4(camera.jitter.xy * o_currentPosition.w, 0.0, 0.0);
 }
\ No newline at end of file
@@ -0,0 +1,11 @@
+#version 460
+
+layout (push_constant) uniform ShadowMapPushConstant {
+    mat4 light_mvp;
+} pc;
+
+layout (location = 0) in vec3 i_position;
+
+void main() {
+    gl_Position = pc.light_mvp * vec4(i_position, 1.0);
+}
@@ -0,0 +1,16 @@
+#version 460
+
+// Low bits of the ID hold the triangle, the high bits the object + 1
+layout (constant_id = 0) const uint TRIANGLE_BITS = 21;
+
+layout (push_constant) uniform VisibilityPushConstant {
+    mat4 model;
+    uint object_id;
+} object;
+
+layout (location = 0) out uint outVisibility;
+
+void main()
+{
+    outVisibility = ((object.object_id + 1) << TRIANGLE_BITS) | uint(gl_PrimitiveID);
+}
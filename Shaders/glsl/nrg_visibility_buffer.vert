@@ -0,0 +1,32 @@
+#version 460
+
+struct CameraData {
+    mat4 view;
+    mat4 proj;
+    mat4 view_inverse;
+    mat4 proj_inverse;
+    vec4 eye;
+    float near_plane;
+    float far_plane;
+};
+
+layout (set = 0, binding = 0) uniform PrePassUniform {
+    CameraData current;
+    CameraData previous;
+    vec4 jitter;  // [ Jitter X, Jitter Y ] in NDC
+} camera;
+
+layout (push_constant) uniform VisibilityPushConstant {
+    mat4 model;
+    uint object_id;
+} object;
+
+layout (location = 0) in vec3 i_position;
+layout (location = 1) in vec3 i_normal;
+layout (location = 2) in vec2 i_uv;
+
+void main()
+{
+    vec4 position = camera.current.proj * camera.current.view * object.model * vec4(i_position, 1.0);
+    gl_Position = position + vec4(camera.jitter.xy * position.w, 0.0, 0.0);
+}